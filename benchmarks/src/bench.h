@@ -0,0 +1,67 @@
+/**
+ * @file bench.h
+ * @brief Micro-Benchmark Harness
+ * * BENCH_RUN() times CONFIG_BENCH_ROUNDS batches of `iterations` runs of a
+ * statement and keeps the median batch, so one preempted batch does not
+ * move the result. The cost per run is printed as one JSON line:
+ *
+ *   BENCH {"name":"vtt_update","unit":"ns","per_op":123.4,"iterations":1000,"rounds":7}
+ *
+ * and checked against the budget of the board (bench_budgets.h, generated
+ * from budgets.json). tools/bench/bench_report.py collects the lines.
+ * * Clock:
+ * - native_sim: host monotonic clock, unit "ns" (see host_clock.c).
+ * - Hardware: Zephyr timing API, unit "cycles" (DWT cycle counter on
+ *   Cortex-M with CONFIG_CORTEX_M_DWT).
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/util.h>
+#include <stdint.h>
+
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+#define BENCH_UNIT "ns"
+uint64_t bench_host_now_ns(void);
+typedef uint64_t bench_stamp_t;
+static inline bench_stamp_t bench_now(void) { return bench_host_now_ns(); }
+static inline uint64_t bench_elapsed(bench_stamp_t start, bench_stamp_t end) { return end - start; }
+static inline void bench_clock_init(void) {}
+#else
+#include <zephyr/timing/timing.h>
+#define BENCH_UNIT "cycles"
+typedef timing_t bench_stamp_t;
+static inline bench_stamp_t bench_now(void) { return timing_counter_get(); }
+static inline uint64_t bench_elapsed(bench_stamp_t start, bench_stamp_t end) { return timing_cycles_get(&start, &end); }
+static inline void bench_clock_init(void) { timing_init(); timing_start(); }
+#endif
+
+/**
+ * @brief Reports one benchmark and checks it against its budget.
+ * @param name       Benchmark name (key in budgets.json).
+ * @param rounds     Per-round totals (sorted in place).
+ * @param iterations Runs per round.
+ */
+void bench_report(const char *name, uint64_t *rounds, uint32_t iterations);
+
+/**
+ * @brief Times `stmt` and reports it as `name`.
+ * `stmt` may use the loop index `bench_i`. Keep the result observable
+ * (write it to a volatile or global) so the compiler cannot drop the work.
+ */
+#define BENCH_RUN(name, iterations, stmt)                                          \
+    do {                                                                           \
+        uint64_t bench_rounds[CONFIG_BENCH_ROUNDS];                                \
+        for (int bench_r = 0; bench_r < CONFIG_BENCH_ROUNDS; bench_r++) {          \
+            bench_stamp_t bench_start = bench_now();                               \
+            for (uint32_t bench_i = 0; bench_i < (iterations); bench_i++) {        \
+                stmt;                                                              \
+            }                                                                      \
+            bench_rounds[bench_r] = bench_elapsed(bench_start, bench_now());       \
+        }                                                                          \
+        bench_report((name), bench_rounds, (iterations));                          \
+    } while (0)
+
+#endif
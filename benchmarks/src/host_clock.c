@@ -0,0 +1,17 @@
+/**
+ * @file host_clock.c
+ * @brief Host Monotonic Clock for native_sim (runner side)
+ * * Built into the native simulator runner, not into the Zephyr image, so it
+ * can call the host libc. The simulated Zephyr clock only advances when the
+ * CPU idles, so it cannot time code that never sleeps.
+ */
+#include <stdint.h>
+#include <time.h>
+
+uint64_t bench_host_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
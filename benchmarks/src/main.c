@@ -0,0 +1,378 @@
+/**
+ * @file main.c
+ * @brief Performance Regression Suite (ztest)
+ * * Times the per-step and per-packet hot paths of both node types and fails
+ * when one exceeds its budget in budgets.json by more than
+ * CONFIG_BENCH_TOLERANCE_PCT (report-only without CONFIG_BENCH_ENFORCE_BUDGETS,
+ * the native_sim default):
+ * - Sensor node: vtt_update(), the VTT ensemble, the condensation monitor, the
+ *   msg_send_* payload encoders, an hour of samples through the series encoder.
+ * - Server node: parse_room_name(), parse_link_report(), node_manager_update()
+ *   per fleet size, node_manager_admit(), server_bus publish/get with 1 and 4
+ *   sinks, decoding an hour of samples (/batch expansion).
+ * * Behaviour is checked by suites of their own, without budgets, so a timing
+ * regression cannot hide it: the health detector decisions
+ * (test_detectors.c) and the series codec round trip (test_ts_codec.c).
+ * * Run: west twister -T benchmarks -p native_sim
+ *   or:  west build -b native_sim benchmarks && ./build/zephyr/zephyr.exe
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "bench_budgets.h"
+
+// Code under test
+#include "vtt_model.h"
+#include "vtt_ensemble.h"
+#include "condensation_monitor.h"
+#include "payload_encoder.h"
+#include "payload_parser.h"
+#include "node_manager.h"
+#include "shared_types.h"
+#include "ts_codec.h"
+#include "message_bus.h"
+
+// * --- CONFIGURATION --- *
+#define ITER_FAST   1000    // Runs per round for sub-microsecond paths
+#define ITER_SLOW   200     // Runs per round for snprintf-heavy paths
+#define BENCH_FLEET_MS 86400123LL // Sample time on the fleet clock (one day of server uptime)
+#define BENCH_HOUR 60             // Samples in one batch (minute sampling)
+
+// Same geometry as the server's server_bus and Serial Bridge sink
+MESSAGE_BUS_DEFINE(bench_bus, 16);
+MESSAGE_SINK_DEFINE(bench_sink, 10, MESSAGE_SINK_DROP_OLDEST);
+
+// Fan-out to every sink the bus can take
+MESSAGE_BUS_DEFINE(bench_bus4, 16);
+MESSAGE_SINK_DEFINE(bench_sink_a, 2, MESSAGE_SINK_DROP_OLDEST);
+MESSAGE_SINK_DEFINE(bench_sink_b, 2, MESSAGE_SINK_DROP_OLDEST);
+MESSAGE_SINK_DEFINE(bench_sink_c, 2, MESSAGE_SINK_DROP_NEWEST);
+MESSAGE_SINK_DEFINE(bench_sink_d, 2, MESSAGE_SINK_DROP_NEWEST);
+static message_sink_t *const bench_sinks4[] = {&bench_sink_a, &bench_sink_b, &bench_sink_c, &bench_sink_d};
+
+// Sinks that keep the benchmarked work observable
+static volatile int sink_int;
+static char payload[PAYLOAD_MAX_LEN];
+static uint8_t series[128];
+static ts_point_t hour[BENCH_HOUR];
+
+
+// * --- REPORTING --- *
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static const struct bench_budget *find_budget(const char *name)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(bench_budgets); i++) {
+        if (bench_budgets[i].name != NULL && strcmp(bench_budgets[i].name, name) == 0) {
+            return &bench_budgets[i];
+        }
+    }
+    return NULL;
+}
+
+void bench_report(const char *name, uint64_t *rounds, uint32_t iterations)
+{
+    qsort(rounds, CONFIG_BENCH_ROUNDS, sizeof(rounds[0]), cmp_u64);
+    double per_op = (double)rounds[CONFIG_BENCH_ROUNDS / 2] / iterations;
+
+    TC_PRINT("BENCH {\"name\":\"%s\",\"unit\":\"%s\",\"per_op\":%.1f,\"iterations\":%u,\"rounds\":%d}\n",
+             name, BENCH_UNIT, per_op, iterations, CONFIG_BENCH_ROUNDS);
+
+    const struct bench_budget *budget = find_budget(name);
+    if (budget == NULL) {
+        TC_PRINT("No %s budget for %s on %s, not checked\n", BENCH_UNIT, name, BENCH_BUDGET_BOARD);
+        return;
+    }
+    double limit = budget->per_op * (100.0 + CONFIG_BENCH_TOLERANCE_PCT) / 100.0;
+#if defined(CONFIG_BENCH_ENFORCE_BUDGETS)
+    zassert_true(per_op <= limit, "%s: %.1f %s per op, budget %u (+%d%%)", name, per_op,
+                 BENCH_UNIT, budget->per_op, CONFIG_BENCH_TOLERANCE_PCT);
+#else
+    if (per_op > limit) {
+        TC_PRINT("Over budget (not enforced) %s: %.1f %s per op, budget %u (+%d%%)\n", name, per_op,
+                 BENCH_UNIT, budget->per_op, CONFIG_BENCH_TOLERANCE_PCT);
+    }
+#endif
+}
+
+
+// * --- SENSOR NODE --- *
+
+// One day of hourly steps: wet night, dry afternoon (growth and decline)
+static const float vtt_temp[8] = {18.0f, 17.5f, 19.0f, 22.0f, 24.0f, 23.0f, 21.0f, 19.5f};
+static const float vtt_humi[8] = {92.0f, 95.0f, 88.0f, 70.0f, 55.0f, 60.0f, 78.0f, 90.0f};
+
+ZTEST(bench_sensor, test_vtt_update)
+{
+    vtt_state_t state;
+
+    vtt_init(&state, VTT_MAT_SENSITIVE);
+    BENCH_RUN("vtt_update", ITER_FAST,
+              vtt_update(&state, vtt_temp[bench_i & 7], vtt_humi[bench_i & 7], 1.0f));
+    sink_int = (int)state.mold_index;
+}
+
+ZTEST(bench_sensor, test_vtt_ensemble_update)
+{
+    static vtt_ensemble_t ens;
+
+    vtt_ensemble_init(&ens, VTT_MAT_SENSITIVE, VTT_ENSEMBLE_SIGMA_TEMP, VTT_ENSEMBLE_SIGMA_HUMI);
+    BENCH_RUN("vtt_ensemble_update", ITER_FAST,
+              vtt_ensemble_update(&ens, vtt_temp[bench_i & 7], vtt_humi[bench_i & 7], 1.0f));
+    sink_int = (int)ens.member[0].mold_index;
+}
+
+ZTEST(bench_sensor, test_vtt_ensemble_report)
+{
+    static vtt_ensemble_t ens;
+    vtt_ensemble_report_t report;
+
+    vtt_ensemble_init(&ens, VTT_MAT_SENSITIVE, VTT_ENSEMBLE_SIGMA_TEMP, VTT_ENSEMBLE_SIGMA_HUMI);
+    for (int i = 0; i < 24 * 30; i++) {
+        vtt_ensemble_update(&ens, vtt_temp[i & 7], vtt_humi[i & 7], 1.0f);
+    }
+    BENCH_RUN("vtt_ensemble_report", ITER_FAST,
+              vtt_ensemble_report(&ens, 0.75f, &report));
+    sink_int = (int)report.risk_confident;
+}
+
+ZTEST(bench_sensor, test_cond_monitor_update)
+{
+    cond_monitor_t mon;
+    cond_report_t report;
+
+    cond_monitor_init(&mon);
+    BENCH_RUN("cond_monitor_update", ITER_FAST,
+              cond_monitor_update(&mon, vtt_temp[bench_i & 7], vtt_humi[bench_i & 7], bench_i * 60000LL, &report));
+    sink_int = (int)report.level;
+}
+
+ZTEST(bench_sensor, test_encode_mold_status)
+{
+    BENCH_RUN("encode_mold_status", ITER_SLOW,
+              sink_int = payload_encode_mold_status(payload, sizeof(payload), "DATA", "Living Room",
+                                                    21.37f, 64.25f, 1.73f, 1, true, false, BENCH_FLEET_MS));
+}
+
+ZTEST(bench_sensor, test_encode_simple_data)
+{
+    BENCH_RUN("encode_simple_data", ITER_SLOW,
+              sink_int = payload_encode_simple_data(payload, sizeof(payload), "DATA", "Living Room",
+                                                    21.37f, 64.25f, false, BENCH_FLEET_MS));
+}
+
+ZTEST(bench_sensor, test_encode_condensation_alert)
+{
+    BENCH_RUN("encode_condensation_alert", ITER_SLOW,
+              sink_int = payload_encode_condensation_alert(payload, sizeof(payload), "ALERT", "Living Room",
+                                                           2, 19.80f, 97.40f, 19.38f, 0.85f, BENCH_FLEET_MS));
+}
+
+// A child of router 12, ten minutes of SED traffic
+static const link_metrics_t bench_link = {
+    .role = 2, .router_id = LINK_NO_ROUTER_ID, .parent_id = 12, .parent_rssi = -67, .parent_lqi = 3,
+    .tx = 120, .tx_retry = 9, .tx_err = 1, .rx = 140, .rx_err = 0,
+};
+
+ZTEST(bench_sensor, test_encode_health_status)
+{
+    BENCH_RUN("encode_health_status", ITER_SLOW,
+              sink_int = payload_encode_health_status(payload, sizeof(payload), "DATA", "Living Room", 0, 1,
+                                                      &bench_link));
+}
+
+ZTEST(bench_sensor, test_encode_health_heartbeat)
+{
+    BENCH_RUN("encode_health_heartbeat", ITER_SLOW,
+              sink_int = payload_encode_health_heartbeat(payload, sizeof(payload), "Living Room", 0, 0,
+                                                         &bench_link));
+}
+
+ZTEST(bench_sensor, test_encode_latest)
+{
+    BENCH_RUN("encode_latest", ITER_SLOW,
+              sink_int = payload_encode_latest(payload, sizeof(payload), "Living Room", 21.37f, 64.25f, 1.73f, 1,
+                                               true, 0, 0, false, BENCH_FLEET_MS));
+}
+
+ZTEST(bench_sensor, test_encode_system_alert)
+{
+    BENCH_RUN("encode_system_alert", ITER_SLOW,
+              sink_int = payload_encode_system_alert(payload, sizeof(payload), "sensor_fail", "Living Room", 4, 0));
+}
+
+/**
+ * @brief One hour of minute samples with a slow drift: the shape /batch
+ * frames carry (reporter jitter stays below the 100 ms unit).
+ */
+static void fill_hour(void)
+{
+    for (int i = 0; i < BENCH_HOUR; i++) {
+        ts_point_quantize(&hour[i], BENCH_FLEET_MS + i * 60000LL,
+                          21.37f + 0.02f * i, 64.25f - 0.05f * i, 1.73f + 0.001f * i);
+    }
+}
+
+static size_t encode_hour(void)
+{
+    ts_encoder_t enc;
+
+    ts_encoder_init(&enc, series, sizeof(series), 100);
+    for (int i = 0; i < BENCH_HOUR; i++) {
+        ts_encoder_append(&enc, &hour[i]);
+    }
+    return ts_encoder_finish(&enc);
+}
+
+ZTEST(bench_sensor, test_ts_encode_hour)
+{
+    fill_hour();
+    BENCH_RUN("ts_encode_hour", ITER_SLOW, sink_int = (int)encode_hour());
+    zassert_true(sink_int > 0 && sink_int <= 100, "hour encoded in %d bytes", sink_int);
+}
+
+
+// * --- SERVER NODE --- *
+
+ZTEST(bench_server, test_parse_room_name)
+{
+    char room[20];
+
+    // Largest payload the server receives (mold status)
+    payload_encode_mold_status(payload, sizeof(payload), "DATA", "Living Room", 21.37f, 64.25f, 1.73f, 1, true, false, BENCH_FLEET_MS);
+    BENCH_RUN("parse_room_name", ITER_FAST, parse_room_name(payload, room, sizeof(room)); sink_int = room[0]);
+    zassert_str_equal(room, "Living Room");
+}
+
+ZTEST(bench_server, test_parse_link_report)
+{
+    link_report_t link;
+
+    payload_encode_health_heartbeat(payload, sizeof(payload), "Living Room", 0, 0, &bench_link);
+    BENCH_RUN("parse_link_report", ITER_FAST, sink_int = parse_link_report(payload, &link));
+    zassert_equal(link.parent_id, 12);
+    zassert_equal(link.tx_retry, 9);
+}
+
+static void drain_sink(message_sink_t *sink)
+{
+    const server_message_t *msg;
+
+    while ((msg = message_bus_get(sink, K_NO_WAIT)) != NULL) {
+        message_bus_release(msg);
+    }
+}
+
+/**
+ * @brief Takes and releases one message from each sink (a consumer's work per message).
+ */
+static void consume_one(message_sink_t *const *sinks, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        const server_message_t *msg = message_bus_get(sinks[i], K_NO_WAIT);
+
+        if (msg != NULL) {
+            sink_int = msg->source_ip[0];
+            message_bus_release(msg);
+        }
+    }
+}
+
+/*
+ * @brief Grows the registry to `fleet` nodes, then times a packet from the
+ * last one (worst case: the search walks every occupied slot).
+ */
+static void bench_fleet(int fleet, const char *name)
+{
+    static int registered;
+    char ip[40];
+
+    zassert_true(fleet <= CONFIG_APP_MAX_NODES, "fleet %d > CONFIG_APP_MAX_NODES", fleet);
+    for (; registered < fleet; registered++) {
+        snprintf(ip, sizeof(ip), "fdde:ad00:beef:0:0:0:0:%x", registered + 2);
+        node_manager_update(ip, "Bench Room", &bench_bus);
+        drain_sink(&bench_sink); // Join alerts
+    }
+    snprintf(ip, sizeof(ip), "fdde:ad00:beef:0:0:0:0:%x", fleet + 1);
+    BENCH_RUN(name, ITER_FAST, node_manager_update(ip, "Bench Room", &bench_bus));
+}
+
+// Ascending sizes: the registry only grows
+ZTEST(bench_server, test_node_manager_update_fleet)
+{
+    bench_fleet(1, "node_manager_update_1");
+    bench_fleet(8, "node_manager_update_8");
+    bench_fleet(32, "node_manager_update_32");
+    bench_fleet(64, "node_manager_update_64");
+
+    // Admission of the last node: its bucket empties within the first
+    // round, so this mostly times the rejection path a flood takes
+    uint32_t retry_s = 0;
+    BENCH_RUN("node_manager_admit_64", ITER_FAST,
+              node_manager_admit("fdde:ad00:beef:0:0:0:0:41", &bench_bus, &retry_s));
+    zassert_true(retry_s > 0, "bucket never emptied");
+    drain_sink(&bench_sink); // Throttle alert
+}
+
+ZTEST(bench_server, test_server_bus_publish_get)
+{
+    static server_message_t in;
+    message_sink_t *const sinks1[] = {&bench_sink};
+
+    strcpy(in.source_ip, "fdde:ad00:beef:0:0:0:0:2");
+    in.batch_len = 0;
+    payload_encode_simple_data(in.json_payload, sizeof(in.json_payload), "DATA", "Living Room", 21.37f, 64.25f, false, BENCH_FLEET_MS);
+    drain_sink(&bench_sink);
+    BENCH_RUN("server_bus_publish_get_1", ITER_FAST,
+              message_bus_publish(&bench_bus, &in); consume_one(sinks1, 1));
+    zassert_equal(sink_int, 'f', "message not delivered");
+
+    BENCH_RUN("server_bus_publish_get_4", ITER_FAST,
+              message_bus_publish(&bench_bus4, &in); consume_one(bench_sinks4, ARRAY_SIZE(bench_sinks4)));
+    zassert_equal(atomic_get(&bench_sink_d.dropped), 0, "fan-out dropped a message");
+}
+
+ZTEST(bench_server, test_ts_decode_hour)
+{
+    ts_decoder_t dec;
+    ts_point_t point;
+
+    fill_hour();
+    size_t len = encode_hour();
+    BENCH_RUN("ts_decode_hour", ITER_SLOW,
+              ts_decoder_init(&dec, series, len); while (ts_decoder_next(&dec, &point)) {} sink_int = dec.index);
+    zassert_equal(sink_int, BENCH_HOUR, "decoded %d samples", sink_int);
+}
+
+static void *bench_setup(void)
+{
+    static bool subscribed;
+
+    bench_clock_init();
+    if (!subscribed) {
+        message_bus_subscribe(&bench_bus, &bench_sink);
+        for (size_t i = 0; i < ARRAY_SIZE(bench_sinks4); i++) {
+            message_bus_subscribe(&bench_bus4, bench_sinks4[i]);
+        }
+        subscribed = true;
+    }
+    TC_PRINT("Benchmarks on %s, unit %s, %d rounds, tolerance %d%%%s\n", BENCH_BUDGET_BOARD, BENCH_UNIT,
+             CONFIG_BENCH_ROUNDS, CONFIG_BENCH_TOLERANCE_PCT,
+             IS_ENABLED(CONFIG_BENCH_ENFORCE_BUDGETS) ? "" : " (report only)");
+    zassert_true(BENCH_BUDGET_UNIT[0] == '\0' || strcmp(BENCH_BUDGET_UNIT, BENCH_UNIT) == 0,
+                 "budgets.json unit %s, clock unit %s", BENCH_BUDGET_UNIT, BENCH_UNIT);
+    return NULL;
+}
+
+ZTEST_SUITE(bench_sensor, NULL, bench_setup, NULL, NULL, NULL);
+ZTEST_SUITE(bench_server, NULL, bench_setup, NULL, NULL, NULL);
@@ -0,0 +1,132 @@
+/**
+ * @file test_detectors.c
+ * @brief Decisions of the Health Detectors (ztest)
+ * * Scripted sensor readings through the detectors of System Health: a slow
+ * drift is caught just past the tolerance, a single spike raises no alarm,
+ * a frozen or barely moving sensor is flagged as stuck while the other one
+ * moves, and two moving sensors are not. A suite of its own, without budgets, so a timing regression in
+ * the benchmark suites can never hide a wrong decision.
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <stdint.h>
+
+// Code under test
+#include "drift_detector.h"
+#include "flatline_detector.h"
+#include "system_health.h"
+
+// * --- CONFIGURATION --- *
+#define DRIFT_CHECKS 2000   // Longest drift scenario in health checks (10 s apart, 360 per hour)
+
+/**
+ * @brief Deterministic noise in [-1, 1] (LCG), so a failing run can be replayed.
+ */
+static float test_noise(uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (float)(*state >> 8) / (float)(1u << 23) - 1.0f;
+}
+
+ZTEST(detectors, test_drift_detector_slow_drift)
+{
+    drift_detector_t det;
+    uint32_t seed = 1;
+    float diff = 0.0f;
+    int alarm_at = -1;
+
+    // A - B creeps by 0.005 C per check (1.8 C per hour) on top of the sensor noise
+    drift_detector_init(&det, DRIFT_TOLERANCE_TEMP, DRIFT_NOISE_FLOOR_TEMP);
+    for (int i = 0; i < DRIFT_CHECKS && alarm_at < 0; i++) {
+        diff = 0.2f + 0.005f * i + 0.02f * test_noise(&seed);
+        if (drift_detector_update(&det, diff)) {
+            alarm_at = i;
+        }
+    }
+    TC_PRINT("Drift detected after %d checks at %.2f C\n", alarm_at, (double)diff);
+    zassert_true(alarm_at >= 0, "drift never detected");
+    zassert_true(diff > DRIFT_TOLERANCE_TEMP, "alarm at %.2f C, inside the tolerance", (double)diff);
+    // The old check only fired once one reading differed by 5.0
+    zassert_true(diff < 1.5f, "alarm at %.2f C", (double)diff);
+}
+
+ZTEST(detectors, test_drift_detector_spike)
+{
+    drift_detector_t det;
+    uint32_t seed = 2;
+
+    // Steady 0.3 C offset, then one reading 6 C off (above the old 5.0 threshold)
+    drift_detector_init(&det, DRIFT_TOLERANCE_TEMP, DRIFT_NOISE_FLOOR_TEMP);
+    for (int i = 0; i < 400; i++) {
+        float diff = (i == 200) ? 6.0f : 0.3f + 0.02f * test_noise(&seed);
+
+        zassert_false(drift_detector_update(&det, diff), "alarm at check %d", i);
+    }
+    zassert_within(det.mean, 0.3f, 0.1f, "offset estimate %.2f", (double)det.mean);
+}
+
+ZTEST(detectors, test_flatline_detector_stuck)
+{
+    flatline_detector_t det;
+    const bool valid[2] = {true, true};
+    float temp[2] = {21.0f, 21.0f};
+    float humi[2] = {55.0f, 55.0f};
+    bool stuck[2];
+    uint32_t seed = 3;
+    int stuck_at = -1;
+
+    // Sensor A returns the same frame, Sensor B keeps moving with the room
+    flatline_detector_init(&det, FLATLINE_NOISE_TEMP, FLATLINE_NOISE_HUMI);
+    for (int i = 0; i < 120; i++) {
+        temp[1] += 0.02f * test_noise(&seed);
+        humi[1] += 0.06f * test_noise(&seed);
+        flatline_detector_update(&det, valid, temp, humi, stuck);
+        zassert_false(stuck[1], "moving sensor flagged at check %d", i);
+        if (stuck[0] && stuck_at < 0) {
+            stuck_at = i;
+        }
+    }
+    TC_PRINT("Frozen sensor flagged at check %d\n", stuck_at);
+    zassert_true(stuck_at > 0 && stuck_at <= 31, "frozen sensor flagged at check %d", stuck_at);
+
+    // Moving again: the verdict clears with the first new value
+    temp[0] += 0.05f;
+    flatline_detector_update(&det, valid, temp, humi, stuck);
+    zassert_false(stuck[0]);
+}
+
+ZTEST(detectors, test_flatline_detector_quiet)
+{
+    flatline_detector_t det;
+    const bool valid[2] = {true, true};
+    float temp[2] = {21.0f, 21.0f};
+    float humi[2] = {55.0f, 55.0f};
+    bool stuck[2];
+    uint32_t seed = 4;
+    bool flagged = false;
+
+    // Sensor A only toggles its last bit (never two identical frames), Sensor B moves
+    flatline_detector_init(&det, FLATLINE_NOISE_TEMP, FLATLINE_NOISE_HUMI);
+    for (int i = 0; i < 120; i++) {
+        temp[0] = (i & 1) ? 21.0f : 21.0001f;
+        temp[1] += 0.02f * test_noise(&seed);
+        humi[1] += 0.06f * test_noise(&seed);
+        flatline_detector_update(&det, valid, temp, humi, stuck);
+        flagged |= stuck[0];
+        zassert_false(stuck[1], "moving sensor flagged at check %d", i);
+    }
+    zassert_true(flagged, "quiet sensor never flagged");
+
+    // Both sensors moving: no verdict
+    flatline_detector_init(&det, FLATLINE_NOISE_TEMP, FLATLINE_NOISE_HUMI);
+    for (int i = 0; i < 300; i++) {
+        for (int s = 0; s < 2; s++) {
+            temp[s] += 0.02f * test_noise(&seed);
+            humi[s] += 0.06f * test_noise(&seed);
+        }
+        flatline_detector_update(&det, valid, temp, humi, stuck);
+        zassert_false(stuck[0] || stuck[1], "moving sensors flagged at check %d", i);
+    }
+}
+
+ZTEST_SUITE(detectors, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,165 @@
+/**
+ * @file test_ts_codec.c
+ * @brief Series Codec Round Trip (ztest)
+ * * Values, timestamps and every bucket size survive ts_encoder_append() and
+ * ts_decoder_next(), a sample that does not fit leaves the stream as it was,
+ * and truncated or foreign streams are rejected or stop cleanly. A suite of
+ * its own, without budgets, so a timing regression in the benchmark suites
+ * can never hide a codec bug.
+ */
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <stdint.h>
+#include <string.h>
+
+// Code under test
+#include "ts_codec.h"
+
+// * --- CONFIGURATION --- *
+#define CODEC_FLEET_MS 86400123LL // Sample time on the fleet clock (one day of server uptime)
+#define CODEC_HOUR 60             // Samples in one batch (minute sampling)
+
+static uint8_t frame[128];
+static ts_point_t hour[CODEC_HOUR];
+
+/**
+ * @brief One hour of minute samples with a slow drift (the shape /batch frames carry).
+ */
+static void fill_hour(void)
+{
+    for (int i = 0; i < CODEC_HOUR; i++) {
+        ts_point_quantize(&hour[i], CODEC_FLEET_MS + i * 60000LL,
+                          21.37f + 0.02f * i, 64.25f - 0.05f * i, 1.73f + 0.001f * i);
+    }
+}
+
+static size_t encode_hour(void)
+{
+    ts_encoder_t enc;
+
+    ts_encoder_init(&enc, frame, sizeof(frame), 100);
+    for (int i = 0; i < CODEC_HOUR; i++) {
+        ts_encoder_append(&enc, &hour[i]);
+    }
+    return ts_encoder_finish(&enc);
+}
+
+/**
+ * @brief Expected decoded time of a sample: rounded to the 100 ms unit.
+ */
+static int64_t unit_rounded(int64_t timestamp_ms)
+{
+    return (timestamp_ms + 50) / 100 * 100;
+}
+
+static void assert_point_equal(const ts_point_t *got, const ts_point_t *want, int i)
+{
+    zassert_equal(got->timestamp_ms, unit_rounded(want->timestamp_ms), "sample %d: timestamp", i);
+    zassert_equal(got->temp_q, want->temp_q, "sample %d: temperature", i);
+    zassert_equal(got->humi_q, want->humi_q, "sample %d: RH", i);
+    zassert_equal(got->mold_q, want->mold_q, "sample %d: mold index", i);
+}
+
+ZTEST(ts_codec, test_ts_codec_round_trip)
+{
+    ts_encoder_t enc;
+    ts_decoder_t dec;
+    ts_point_t point;
+    // Irregular period, sign changes and full-scale jumps: every bucket size
+    ts_point_t edges[5];
+
+    ts_point_quantize(&edges[0], CODEC_FLEET_MS, 21.37f, 64.25f, 1.73f);
+    ts_point_quantize(&edges[1], CODEC_FLEET_MS + 60000, -12.5f, 100.0f, 0.0f);
+    ts_point_quantize(&edges[2], CODEC_FLEET_MS + 61000, 45.0f, 0.0f, 6.0f);
+    ts_point_quantize(&edges[3], CODEC_FLEET_MS + 3661000, 45.0f, 0.0f, 6.0f);
+    ts_point_quantize(&edges[4], CODEC_FLEET_MS + 3661000, -0.1f, 0.1f, 0.01f);
+    zassert_equal(edges[0].temp_q, 214);
+    zassert_equal(edges[0].humi_q, 643);
+    zassert_equal(edges[0].mold_q, 173);
+    zassert_equal(edges[1].temp_q, -125);
+
+    ts_encoder_init(&enc, frame, sizeof(frame), 100);
+    for (size_t i = 0; i < ARRAY_SIZE(edges); i++) {
+        zassert_true(ts_encoder_append(&enc, &edges[i]), "sample %d not appended", i);
+    }
+    size_t len = ts_encoder_finish(&enc);
+    zassert_true(ts_decoder_init(&dec, frame, len));
+    zassert_equal(dec.count, ARRAY_SIZE(edges));
+    for (size_t i = 0; i < ARRAY_SIZE(edges); i++) {
+        zassert_true(ts_decoder_next(&dec, &point), "sample %d missing", i);
+        assert_point_equal(&point, &edges[i], (int)i);
+    }
+    zassert_false(ts_decoder_next(&dec, &point), "sample past the count");
+
+    // A regular hour
+    fill_hour();
+    len = encode_hour();
+    zassert_true(ts_decoder_init(&dec, frame, len));
+    for (int i = 0; i < CODEC_HOUR; i++) {
+        zassert_true(ts_decoder_next(&dec, &point), "sample %d missing", i);
+        assert_point_equal(&point, &hour[i], i);
+    }
+}
+
+ZTEST(ts_codec, test_ts_codec_full_buffer)
+{
+    ts_encoder_t enc;
+    ts_decoder_t dec;
+    ts_point_t point;
+    uint8_t small[16];
+    int appended = 0;
+
+    // Fill a small frame: the first sample that does not fit leaves the stream as it was
+    fill_hour();
+    ts_encoder_init(&enc, small, sizeof(small), 100);
+    for (; appended < CODEC_HOUR; appended++) {
+        ts_encoder_t before = enc;
+
+        if (!ts_encoder_append(&enc, &hour[appended])) {
+            zassert_equal(enc.bit_pos, before.bit_pos, "rejected sample moved the stream");
+            zassert_equal(enc.count, before.count);
+            zassert_equal(enc.last_ts, before.last_ts);
+            zassert_equal(enc.last_delta, before.last_delta);
+            zassert_equal(memcmp(enc.last_q, before.last_q, sizeof(enc.last_q)), 0, "rejected sample kept its values");
+            break;
+        }
+    }
+    zassert_true(appended > 1 && appended < CODEC_HOUR, "%d samples in %u bytes", appended, (unsigned int)sizeof(small));
+
+    // What was kept decodes exactly
+    size_t len = ts_encoder_finish(&enc);
+    zassert_true(len <= sizeof(small));
+    zassert_true(ts_decoder_init(&dec, small, len));
+    zassert_equal(dec.count, appended);
+    for (int i = 0; i < appended; i++) {
+        zassert_true(ts_decoder_next(&dec, &point), "sample %d missing", i);
+        assert_point_equal(&point, &hour[i], i);
+    }
+    zassert_false(ts_decoder_next(&dec, &point));
+}
+
+ZTEST(ts_codec, test_ts_codec_truncated)
+{
+    ts_decoder_t dec;
+    ts_point_t point;
+
+    fill_hour();
+    size_t len = encode_hour();
+
+    // Header cut short: version, count and unit only
+    zassert_false(ts_decoder_init(&dec, frame, 3));
+    // Other version
+    frame[0]++;
+    zassert_false(ts_decoder_init(&dec, frame, len));
+    frame[0]--;
+
+    // Stream cut in half: the prefix decodes, then the decoder stops
+    zassert_true(ts_decoder_init(&dec, frame, len / 2));
+    while (ts_decoder_next(&dec, &point)) {
+        assert_point_equal(&point, &hour[dec.index - 1], dec.index - 1);
+    }
+    zassert_true(dec.index > 0 && dec.index < dec.count, "decoded %u of %u", dec.index, dec.count);
+    zassert_false(ts_decoder_next(&dec, &point), "decoder resumed past the end");
+}
+
+ZTEST_SUITE(ts_codec, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,228 @@
+/**
+ * @file ts_codec.c
+ * @brief Implementation of the Compressed Time-Series Codec
+ */
+#include "ts_codec.h"
+#include <math.h>
+#include <string.h>
+
+// * --- CONFIGURATION --- *
+#define BUCKETS 5
+
+/**
+ * @brief Payload widths of the prefix-coded buckets.
+ * Bucket i has the prefix "1" x i + "0", the last one "1" x (BUCKETS - 1).
+ */
+static const uint8_t ts_bucket_bits[BUCKETS] = {0, 7, 12, 20, 32};    // delta-of-delta (units)
+static const uint8_t value_bucket_bits[BUCKETS] = {0, 3, 6, 12, 32};  // value delta (quantization steps)
+
+// --- Bit I/O (MSB first) ---
+
+static bool put_bits(ts_encoder_t *enc, uint32_t value, int n) {
+    if (enc->bit_pos + n > enc->size * 8) {
+        return false;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        uint8_t mask = 0x80 >> (enc->bit_pos & 7);
+        if ((value >> i) & 1) {
+            enc->buf[enc->bit_pos >> 3] |= mask;
+        } else {
+            enc->buf[enc->bit_pos >> 3] &= ~mask;
+        }
+        enc->bit_pos++;
+    }
+    return true;
+}
+
+static bool get_bits(ts_decoder_t *dec, int n, uint32_t *value) {
+    if (dec->bit_pos + n > dec->len * 8) {
+        return false;
+    }
+    *value = 0;
+    for (int i = 0; i < n; i++) {
+        uint8_t bit = (dec->buf[dec->bit_pos >> 3] >> (7 - (dec->bit_pos & 7))) & 1;
+        *value = (*value << 1) | bit;
+        dec->bit_pos++;
+    }
+    return true;
+}
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t u) {
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+/**
+ * @brief Writes a zigzag value in the smallest bucket that holds it.
+ */
+static bool put_bucketed(ts_encoder_t *enc, const uint8_t *bits, uint32_t u) {
+    for (int b = 0; b < BUCKETS; b++) {
+        if (bits[b] < 32 && (u >> bits[b]) != 0) {
+            continue;
+        }
+        bool last = (b == BUCKETS - 1);
+        uint32_t prefix = ((1u << b) - 1) << (last ? 0 : 1);
+        return put_bits(enc, prefix, last ? b : b + 1) && put_bits(enc, u, bits[b]);
+    }
+    return false;
+}
+
+static bool get_bucketed(ts_decoder_t *dec, const uint8_t *bits, uint32_t *u) {
+    int b = 0;
+    uint32_t bit;
+
+    while (b < BUCKETS - 1) {
+        if (!get_bits(dec, 1, &bit)) {
+            return false;
+        }
+        if (bit == 0) {
+            break;
+        }
+        b++;
+    }
+    return get_bits(dec, bits[b], u);
+}
+
+// --- Header (byte aligned) ---
+
+static bool put_varint(ts_encoder_t *enc, uint64_t v) {
+    do {
+        uint8_t byte = v & 0x7F;
+        v >>= 7;
+        if (!put_bits(enc, byte | (v ? 0x80 : 0), 8)) {
+            return false;
+        }
+    } while (v);
+    return true;
+}
+
+static bool get_varint(ts_decoder_t *dec, uint64_t *v) {
+    uint32_t byte;
+
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (!get_bits(dec, 8, &byte)) {
+            return false;
+        }
+        *v |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- Public API ---
+
+void ts_point_quantize(ts_point_t *point, int64_t timestamp_ms, float temp_c, float rh_percent, float mold_index) {
+    point->timestamp_ms = timestamp_ms;
+    point->temp_q = (int32_t)lroundf(temp_c * TS_CODEC_TEMP_SCALE);
+    point->humi_q = (int32_t)lroundf(rh_percent * TS_CODEC_HUMI_SCALE);
+    point->mold_q = (int32_t)lroundf(mold_index * TS_CODEC_MOLD_SCALE);
+}
+
+void ts_encoder_init(ts_encoder_t *enc, uint8_t *buf, size_t size, uint32_t unit_ms) {
+    memset(enc, 0, sizeof(*enc));
+    enc->buf = buf;
+    enc->size = size;
+    enc->unit_ms = (unit_ms > 0) ? unit_ms : 1;
+    put_bits(enc, TS_CODEC_VERSION, 8);
+    put_bits(enc, 0, 8);    // Count, written by ts_encoder_finish()
+    put_varint(enc, enc->unit_ms);
+}
+
+bool ts_encoder_append(ts_encoder_t *enc, const ts_point_t *point) {
+    const int32_t q[3] = {point->temp_q, point->humi_q, point->mold_q};
+    int64_t ts = (point->timestamp_ms + enc->unit_ms / 2) / enc->unit_ms;
+    ts_encoder_t saved = *enc;
+    bool ok = true;
+
+    if (enc->count == TS_CODEC_MAX_SAMPLES) {
+        return false;
+    }
+
+    if (enc->count == 0) {
+        ok = put_varint(enc, (uint64_t)ts);
+    } else {
+        int64_t delta = ts - enc->last_ts;
+        int64_t dod = delta - enc->last_delta;
+        ok = (dod >= INT32_MIN && dod <= INT32_MAX) && put_bucketed(enc, ts_bucket_bits, zigzag((int32_t)dod));
+        enc->last_delta = delta;
+    }
+    for (int v = 0; ok && v < 3; v++) {
+        // Modulo 2^32: any pair of values has a delta, and the decoder wraps back
+        ok = put_bucketed(enc, value_bucket_bits, zigzag((int32_t)((uint32_t)q[v] - (uint32_t)enc->last_q[v])));
+        enc->last_q[v] = q[v];
+    }
+
+    if (!ok) {
+        *enc = saved;
+        return false;
+    }
+    enc->last_ts = ts;
+    enc->count++;
+    return true;
+}
+
+size_t ts_encoder_finish(ts_encoder_t *enc) {
+    if (enc->count == 0) {
+        return 0;
+    }
+    enc->buf[1] = enc->count;
+    // Zero the padding bits so equal series give equal bytes
+    if (enc->bit_pos & 7) {
+        put_bits(enc, 0, 8 - (enc->bit_pos & 7));
+    }
+    return enc->bit_pos / 8;
+}
+
+bool ts_decoder_init(ts_decoder_t *dec, const uint8_t *buf, size_t len) {
+    uint32_t version, count;
+    uint64_t unit_ms, first_ts;
+
+    memset(dec, 0, sizeof(*dec));
+    dec->buf = buf;
+    dec->len = len;
+    if (!get_bits(dec, 8, &version) || version != TS_CODEC_VERSION || !get_bits(dec, 8, &count) ||
+        !get_varint(dec, &unit_ms) || unit_ms == 0 || unit_ms > UINT32_MAX) {
+        return false;
+    }
+    dec->count = (uint8_t)count;
+    dec->unit_ms = (uint32_t)unit_ms;
+    if (dec->count > 0) {
+        if (!get_varint(dec, &first_ts)) {
+            return false;
+        }
+        dec->last_ts = (int64_t)first_ts;
+    }
+    return true;
+}
+
+bool ts_decoder_next(ts_decoder_t *dec, ts_point_t *point) {
+    int32_t *q[3] = {&point->temp_q, &point->humi_q, &point->mold_q};
+    uint32_t u;
+
+    if (dec->index >= dec->count) {
+        return false;
+    }
+    if (dec->index > 0) {
+        if (!get_bucketed(dec, ts_bucket_bits, &u)) {
+            return false;
+        }
+        dec->last_delta += unzigzag(u);
+        dec->last_ts += dec->last_delta;
+    }
+    for (int v = 0; v < 3; v++) {
+        if (!get_bucketed(dec, value_bucket_bits, &u)) {
+            return false;
+        }
+        dec->last_q[v] = (int32_t)((uint32_t)dec->last_q[v] + (uint32_t)unzigzag(u));
+        *q[v] = dec->last_q[v];
+    }
+    point->timestamp_ms = dec->last_ts * dec->unit_ms;
+    dec->index++;
+    return true;
+}
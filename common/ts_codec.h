@@ -0,0 +1,125 @@
+/**
+ * @file ts_codec.h
+ * @brief Compressed Time-Series Codec (shared by the sensor and server firmware)
+ * * Packs sequences of (timestamp, Temperature, RH, Mold Index) samples into a
+ * bit stream, for batched frames and on-node history:
+ * - Fixed-point values: 0.1 C, 0.1 %RH, 0.01 Mold Index (below the DHT20
+ *   accuracy of +-0.3 C / +-3 %RH, so nothing measurable is lost)
+ * - Timestamps: delta-of-delta in units of unit_ms, a regular sampling
+ *   period costs 1 bit per sample
+ * - Values: zigzag delta from the previous sample in prefix-coded buckets,
+ *   an unchanged value costs 1 bit, a typical minute step 5 bits
+ * * A minute-resolution hour (60 samples) is about 75 bytes, one 802.15.4
+ * frame, instead of 60 JSON payloads of about 150 bytes.
+ * * Stream layout:
+ *   [0] TS_CODEC_VERSION  [1] sample count  varint unit_ms  varint first timestamp / unit_ms
+ *   then the bit stream (MSB first), padded to a byte.
+ * * Pure C, no kernel calls: the same file builds in both applications and
+ * in the benchmarks.
+ */
+#ifndef TS_CODEC_H
+#define TS_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TS_CODEC_VERSION        1
+#define TS_CODEC_MAX_SAMPLES    255     /**< The count is one byte */
+#define TS_CODEC_HEADER_MAX     22      /**< Version, count and two 64-bit varints */
+
+/**
+ * @brief Batch frame: CoAP PUT /batch (application/octet-stream) carrying
+ * the room name, a NUL, one flags byte (TS_BATCH_FLAG_*), then one stream.
+ */
+#define TS_BATCH_URI_PATH       "batch"
+#define TS_BATCH_FLAG_SIMULATED 0x01    /**< Samples come from the simulation source */
+#define TS_BATCH_FLAG_UPTIME    0x02    /**< Timestamps are the node's uptime (no time beacon yet) */
+
+#define TS_CODEC_TEMP_SCALE     10      /**< Temperature steps per C */
+#define TS_CODEC_HUMI_SCALE     10      /**< RH steps per % */
+#define TS_CODEC_MOLD_SCALE     100     /**< Mold Index steps per unit */
+
+/**
+ * @brief One sample, quantized.
+ */
+typedef struct {
+    int64_t timestamp_ms;   /**< Sample time (fleet clock, or uptime with TS_BATCH_FLAG_UPTIME), a multiple of unit_ms after decoding */
+    int32_t temp_q;         /**< Temperature (1/TS_CODEC_TEMP_SCALE C) */
+    int32_t humi_q;         /**< Relative Humidity (1/TS_CODEC_HUMI_SCALE %) */
+    int32_t mold_q;         /**< Mold Index (1/TS_CODEC_MOLD_SCALE) */
+} ts_point_t;
+
+/**
+ * @brief Encoder state. The buffer holds the header and the bit stream.
+ */
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t bit_pos;         /**< Next bit to write (from the start of buf) */
+    uint32_t unit_ms;
+    uint8_t count;
+    int64_t last_ts;        /**< Previous timestamp (units) */
+    int64_t last_delta;     /**< Previous timestamp delta (units) */
+    int32_t last_q[3];      /**< Previous quantized values */
+} ts_encoder_t;
+
+/**
+ * @brief Decoder state.
+ */
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t bit_pos;
+    uint32_t unit_ms;
+    uint8_t count;          /**< Samples in the stream */
+    uint8_t index;          /**< Samples read so far */
+    int64_t last_ts;
+    int64_t last_delta;
+    int32_t last_q[3];
+} ts_decoder_t;
+
+/**
+ * @brief Quantizes one sample.
+ * @param[out] point Quantized sample.
+ * @param timestamp_ms Sample time.
+ * @param temp_c Temperature (Celsius).
+ * @param rh_percent Relative Humidity (%).
+ * @param mold_index Mold Index (0.0 to 6.0).
+ */
+void ts_point_quantize(ts_point_t *point, int64_t timestamp_ms, float temp_c, float rh_percent, float mold_index);
+
+/**
+ * @brief Starts an empty stream.
+ * @param enc Encoder.
+ * @param buf Output buffer (header + stream).
+ * @param size Buffer size, at least TS_CODEC_HEADER_MAX.
+ * @param unit_ms Timestamp resolution (e.g. 100 ms).
+ */
+void ts_encoder_init(ts_encoder_t *enc, uint8_t *buf, size_t size, uint32_t unit_ms);
+
+/**
+ * @brief Appends one sample.
+ * @return false if the sample does not fit (the stream is left unchanged).
+ */
+bool ts_encoder_append(ts_encoder_t *enc, const ts_point_t *point);
+
+/**
+ * @brief Completes the stream (sample count, padding).
+ * @return Stream length in bytes, 0 if no sample was appended.
+ */
+size_t ts_encoder_finish(ts_encoder_t *enc);
+
+/**
+ * @brief Opens a stream for reading.
+ * @return false if the header is truncated or of another version.
+ */
+bool ts_decoder_init(ts_decoder_t *dec, const uint8_t *buf, size_t len);
+
+/**
+ * @brief Reads the next sample.
+ * @return false at the end of the stream or if it is truncated.
+ */
+bool ts_decoder_next(ts_decoder_t *dec, ts_point_t *point);
+
+#endif
@@ -197,7 +197,8 @@ static int dht20_read_sample(const struct dht20_config *cfg, struct dht20_data *
 	uint8_t crc = crc8(rx_buf, 6, DHT20_CRC_POLYNOM, 0xFF, false);
 
 	if (crc != rx_buf[DHT20_MEAS_CRC_IDX]) {
-		return -EIO;
+		/* Distinct from -EIO (bus error) so health can tell them apart */
+		return -EBADMSG;
 	}
 #endif
 
@@ -0,0 +1,68 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file dht20_emul.h
+ * @brief Backend API of the DHT20 I2C emulator (CONFIG_EMUL_DHT20)
+ *
+ * The emulator answers the same I2C transactions as a real DHT20, so the
+ * unmodified driver and the whole sensor node firmware run on native_sim.
+ * Readings follow a scripted temperature/humidity trace and bus faults can be
+ * injected to exercise the health and recovery paths.
+ */
+#ifndef DHT20_EMUL_H
+#define DHT20_EMUL_H
+
+#include <zephyr/drivers/emul.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One point of a scripted trace. Values between points are interpolated.
+ */
+struct dht20_emul_point {
+	uint32_t time_s;      /**< Trace time (seconds since the trace was set) */
+	int16_t temp_centi_c; /**< Temperature in 0.01 degC */
+	uint16_t rh_centi;    /**< Relative humidity in 0.01 % */
+};
+
+/**
+ * @brief Faults the emulator can inject.
+ */
+enum dht20_emul_fault {
+	DHT20_EMUL_FAULT_NONE = 0,  /**< Normal operation */
+	DHT20_EMUL_FAULT_NACK,      /**< Every transfer is NACKed (-EIO) */
+	DHT20_EMUL_FAULT_BUSY,      /**< Measurement frames keep the busy bit set */
+	DHT20_EMUL_FAULT_CRC,       /**< Measurement frames carry a wrong CRC byte */
+	DHT20_EMUL_FAULT_POWER_LOSS, /**< Sensor unpowered: NACKs, then needs a power-on reset */
+	DHT20_EMUL_FAULT_FREEZE     /**< Measurement frames repeat the last reading (valid CRC) */
+};
+
+/**
+ * @brief Replaces the trace of an emulated sensor.
+ *
+ * @param target Emulator instance (EMUL_DT_GET()).
+ * @param points Trace points, sorted by time_s. Must stay valid while in use.
+ * @param count  Number of points (0 restores the built-in trace).
+ * @param loop   Restart the trace after the last point instead of holding it.
+ */
+void dht20_emul_set_trace(const struct emul *target, const struct dht20_emul_point *points,
+			  size_t count, bool loop);
+
+/**
+ * @brief Injects a fault.
+ *
+ * @param target Emulator instance.
+ * @param fault  Fault to inject (DHT20_EMUL_FAULT_NONE clears it).
+ * @param count  Number of affected transfers, 0 = until cleared.
+ */
+void dht20_emul_set_fault(const struct emul *target, enum dht20_emul_fault fault, uint32_t count);
+
+/**
+ * @brief Number of I2C transfers answered so far (faulty ones included).
+ */
+uint32_t dht20_emul_transfer_count(const struct emul *target);
+
+#endif
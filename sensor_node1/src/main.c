@@ -5,6 +5,15 @@
  * 1. System Health Monitoring (Fault Detection)
  * 2. Telemetry Reporting (Temp/Humidity)
  * 3. VTT Mold Risk Modeling (Edge Computing)
+ * * Services exchange data only through zbus channels (modules/app_channels.h):
+ *   Health    -> health_chan   (sensor enable flags, status codes)
+ *   Telemetry -> sample_chan   (one acquisition, shared by every consumer)
+ *   VTT       -> model_chan    (model output, hourly and on RH_crit crossings)
+ *   Condensation listener: sample_chan -> outbound_chan (early warning)
+ *   *         -> outbound_chan (frames for the Messaging TX thread)
+ * * Each service is a run-once function wrapped in a periodic_service_t. By
+ * default every service gets its own thread; with CONFIG_APP_WORKQUEUE_MODEL
+ * all of them share one work queue (see overlay-workqueue.conf).
  * * @platform Nordic nRF52840 (Zephyr RTOS)
  * @authors: muzamil.py, Google Gemini 3 Pro
  * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
@@ -14,14 +23,23 @@
 #include <zephyr/device.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/sensor.h>
+#include <zephyr/zbus/zbus.h>
 
 // Sensor Driver
 #include "sensor/dht20/dht20.c"
 
 // Custom Modules
+#include "modules/app_channels.h"
 #include "modules/system_health.h"
 #include "modules/vtt_model.h"
+#include "modules/vtt_ensemble.h"
+#include "modules/condensation_monitor.h"
 #include "modules/messaging_service.h"
+#include "modules/trace_spans.h"
+#include "modules/app_workqueue.h"
+#include "modules/resource_report.h"
+#include "modules/weather_replay.h"
+#include "modules/latest_resource.h"
 
 #if !DT_HAS_COMPAT_STATUS_OKAY(aosong_dht20)
 #error "No aosong,dht20 compatible node found in the device tree"
@@ -32,14 +50,21 @@
 #define ROOM_NAME "Living Room"
 #define ALERT_MESSAGE "ALERT"
 #define DATA_MESSAGE "DATA"
-#define TIME_STEP 1.0f
+#define TIME_STEP 1.0f // Model hours per VTT period
+#define ROOM_MATERIAL VTT_MAT_SENSITIVE
 #define STACK_SIZE 2048
 #define IS_SIMULATION_NODE false
 int sim_flag = IS_SIMULATION_NODE ? 1 : 0;
 
-// * --- Global Status Flags (Protected by Logic) --- *
-bool sensor_a_enabled = false;
-bool sensor_b_enabled = false;
+// * --- Service Periods --- *
+#define HEALTH_PERIOD_MS 10000
+#define HEALTH_HEARTBEAT_MS (CONFIG_APP_HEALTH_HEARTBEAT_S * 1000LL) // Unchanged health is only re-sent this often
+#define TELEMETRY_PERIOD_MS 60000
+#define VTT_PERIOD_MS 3600000 // 1 hour = 3600000 milliseconds
+#define VTT_WAKE_HYST_RH 1.0f // RH beyond RH_crit (either way) that counts as a growth/decline crossing
+
+// A cached sample older than this is treated as "Sensors unavailable"
+#define SAMPLE_MAX_AGE_MS (2 * TELEMETRY_PERIOD_MS)
 
 
 // * --- SHARED RESOURCES --- * 
@@ -55,9 +80,47 @@ const struct device *dht20_dev_b = DEVICE_DT_GET(DT_ALIAS(sensor_b));
 // * --- OS PRIMITIVES --- *
 
 // * MUTEX LOCKS
-K_MUTEX_DEFINE(sensors_lock); // Protects I2C Bus Access
-K_MUTEX_DEFINE(coap_lock); // Protects OpenThread Radio Buffer
+K_MUTEX_DEFINE(sensors_lock); // Protects I2C Bus Access (Health probes vs Telemetry reads)
+
+/*
+ * @brief Hold-time statistics of sensors_lock for one holder.
+ * A failing probe (I2C timeouts, 80 ms conversion) runs inside the Health
+ * hold and delays the Telemetry read of the healthy sensor.
+ */
+typedef struct {
+        const char *holder;
+        uint32_t holds;
+        uint32_t max_us;
+        uint64_t total_us;
+} lock_hold_stats_t;
+
+static lock_hold_stats_t health_lock_stats = {.holder = "health"};
+static lock_hold_stats_t telemetry_lock_stats = {.holder = "telemetry"};
+
+static uint32_t sensors_lock_take(void)
+{
+        k_mutex_lock(&sensors_lock, K_FOREVER);
+        trace_span_begin(SPAN_SENSORS_LOCK);
+        return k_cycle_get_32();
+}
 
+static void sensors_lock_give(lock_hold_stats_t *stats, uint32_t start_cycles)
+{
+        uint32_t held_us = k_cyc_to_us_floor32(k_cycle_get_32() - start_cycles);
+
+        trace_span_end(SPAN_SENSORS_LOCK, held_us);
+        k_mutex_unlock(&sensors_lock);
+
+        stats->holds++;
+        stats->total_us += held_us;
+        if (held_us > stats->max_us) {
+                stats->max_us = held_us;
+                LOG_INF("[LOCK] sensors_lock held %u us by %s (new max, avg %llu us)", held_us,
+                        stats->holder, stats->total_us / stats->holds);
+        }
+}
+
+#if !defined(CONFIG_APP_WORKQUEUE_MODEL)
 // * THREAD STACKS & DATA 
 struct k_thread system_health_data;
 struct k_thread vtt_model_data;
@@ -66,250 +129,550 @@ struct k_thread simple_data;
 K_THREAD_STACK_DEFINE(system_health_stack, STACK_SIZE);
 K_THREAD_STACK_DEFINE(vtt_model_stack, STACK_SIZE);
 K_THREAD_STACK_DEFINE(simple_data_stack, STACK_SIZE);
+#endif
 
 
-bool get_simulated_weather(float *temp, float *hum) {
-        // 1 Real Minute = 1 Simulated Hour
-        // k_uptime_get() returns milliseconds. 
-        // Divide by 60,000 to get "Real Minutes" which equal "Sim Hours".
-        int64_t sim_hour = k_uptime_get() / 60000; 
-        
-        // Use modulo (%) to loop the 300-hour cycle automatically
-        int64_t current_cycle_hour = sim_hour % 300;
-    
-        bool is_valid = true;
-    
-        // --- PHASE 1: TROPICAL STORM (Hours 0-100) ---
-        if (current_cycle_hour <= 100) {
-            *temp = 28.0; 
-            *hum = 95.0; 
-        } 
-        // --- PHASE 2: DRY SPELL (Hours 101-200) ---
-        else if (current_cycle_hour <= 200) {
-            *temp = 25.0;
-            *hum = 45.0; 
-        }
-        // --- PHASE 3: FREEZE (Hours 201-299) ---
-        else {
-            *temp = 5.0; 
-            *hum = 90.0; 
-        }
-        
-        return is_valid;
-    }
-
 /*
  * @brief Helper function to safely read active sensors.
- * Handles fetching, and averaging if redundant sensors are active.
- * * @param[out] out_temp  Pointer to store final temperature (deg C)
- * @param[out] out_hum   Pointer to store final humidity (%)
+ * Handles fetching, and averaging if redundant sensors are active. Every
+ * read goes through system_health_acquire(), so its outcome also feeds the
+ * passive health of the sensor (no extra probe by the Health service).
+ * * @param[in]  health       Latest health_chan message (which sensors are usable)
+ * @param[out] temparature  Pointer to store final temperature (deg C)
+ * @param[out] humidity     Pointer to store final humidity (%)
  * @return true if valid data read, false if all sensors failed
  */
-bool get_sensor_data(float *temparature, float *humidity)
+bool get_sensor_data(const health_msg_t *health, float *temparature, float *humidity)
         {
-                struct sensor_value temparature_value, humidity_value;
-                // Case 1: Redundancy Mode (Both Active)
-                if (sensor_a_enabled && sensor_b_enabled) {
-                        LOG_DBG("[HELPER] Reading Both Sensors...");
-
-                        // 1. Fetch Raw Data
-                        sensor_sample_fetch(dht20_dev_a);
-                        sensor_sample_fetch(dht20_dev_b);
-
-                        // 2. Process Sensor A
-                        sensor_channel_get(dht20_dev_a, SENSOR_CHAN_AMBIENT_TEMP, &temparature_value);
-                        sensor_channel_get(dht20_dev_a, SENSOR_CHAN_HUMIDITY, &humidity_value);
-                        float sensor_a_temp = sensor_value_to_double(&temparature_value);
-                        float sensor_a_humi = sensor_value_to_double(&humidity_value);
+                float sensor_a_temp, sensor_a_humi, sensor_b_temp, sensor_b_humi;
+                bool a_ok = false, b_ok = false;
 
-                        // 3. Process Sensor B
-                        sensor_channel_get(dht20_dev_b, SENSOR_CHAN_AMBIENT_TEMP, &temparature_value);
-                        sensor_channel_get(dht20_dev_b, SENSOR_CHAN_HUMIDITY, &humidity_value);
-                        float sensor_b_temp = sensor_value_to_double(&temparature_value);
-                        float sensor_b_humi = sensor_value_to_double(&humidity_value);
+                // 1. Fetch & Validate (each enabled sensor once)
+                if (health->sensor_a_enabled) {
+                        a_ok = (system_health_acquire(0, dht20_dev_a, &sensor_a_temp, &sensor_a_humi) == HEALTH_OK);
+                }
+                if (health->sensor_b_enabled) {
+                        b_ok = (system_health_acquire(1, dht20_dev_b, &sensor_b_temp, &sensor_b_humi) == HEALTH_OK);
+                }
 
-                        // 4. Average
+                // Case 1: Redundancy Mode (Both Valid)
+                if (a_ok && b_ok) {
+                        LOG_DBG("[HELPER] Reading Both Sensors...");
+                        // 2. Average
                         *temparature = (sensor_a_temp + sensor_b_temp) / 2.0f;
                         *humidity = (sensor_a_humi + sensor_b_humi) / 2.0f;
                         return true;
 
-                } else if (sensor_a_enabled || sensor_b_enabled) {
-                        const struct device *working_sensor = sensor_a_enabled ? dht20_dev_a : dht20_dev_b;
+                } else if (a_ok || b_ok) {
                         LOG_WRN("[HELPER] Failover: Using Single Sensor.");
-
-                        sensor_sample_fetch(working_sensor);
-                        sensor_channel_get(working_sensor, SENSOR_CHAN_AMBIENT_TEMP, &temparature_value);
-                        sensor_channel_get(working_sensor, SENSOR_CHAN_HUMIDITY, &humidity_value);
-                        *temparature = sensor_value_to_double(&temparature_value);
-                        *humidity = sensor_value_to_double(&humidity_value);
+                        *temparature = a_ok ? sensor_a_temp : sensor_b_temp;
+                        *humidity = a_ok ? sensor_a_humi : sensor_b_humi;
                         return true;
                 }
                 return false; // No Sensor Available
 }
 
+/*
+ * @brief Publishes a frame for the Messaging TX thread.
+ * Never blocks the caller on the radio, only on the (short) channel lock.
+ */
+static void publish_frame(const outbound_frame_t *frame)
+{
+        if (zbus_chan_pub(&outbound_chan, frame, K_MSEC(100)) != 0) {
+                LOG_WRN("[MAIN] Outbound channel busy, frame %d dropped", frame->kind);
+        }
+}
+
+
+/*
+ * @listener Telemetry Reporter
+ * Turns every published sample into a DATA frame. Runs in the publisher's
+ * context, so it must stay short and non-blocking.
+ */
+static void telemetry_reporter_cb(const struct zbus_channel *chan)
+{
+        const sample_msg_t *sample = zbus_chan_const_msg(chan);
+        outbound_frame_t frame = {
+                .kind = FRAME_SIMPLE_DATA,
+                .message_type = DATA_MESSAGE,
+                .room_name = ROOM_NAME,
+                .temperature = sample->temperature,
+                .humidity = sample->humidity,
+                .origin_ms = (uint32_t)sample->timestamp_ms,
+                .is_simulated = sample->is_simulated,
+        };
+
+        LOG_DBG("[TELEMETRY] Sending Sensor Data....");
+        if (zbus_chan_pub(&outbound_chan, &frame, K_NO_WAIT) != 0) {
+                LOG_WRN("[TELEMETRY] Outbound channel busy, sample dropped");
+        }
+}
+
+ZBUS_LISTENER_DEFINE(telemetry_reporter, telemetry_reporter_cb);
+ZBUS_CHAN_ADD_OBS(sample_chan, telemetry_reporter, 0);
+
+#if defined(CONFIG_APP_CONDENSATION_ALERT)
+/*
+ * @listener Condensation Early Warning
+ * Evaluates dew point, margin to saturation and RH slope on every sample and
+ * sends an alert when the level changes, without waiting for the hourly VTT
+ * step. Runs in the publisher's context (one logf per sample).
+ * A level change is only kept once its frame is on outbound_chan, so a
+ * dropped alert is sent again with the next sample.
+ */
+static cond_monitor_t condensation; // Zeroed = level NONE, no previous sample
+
+static void condensation_listener_cb(const struct zbus_channel *chan)
+{
+        const sample_msg_t *sample = zbus_chan_const_msg(chan);
+        cond_risk_t sent_level = condensation.level;
+        cond_report_t report;
+
+        if (!cond_monitor_update(&condensation, sample->temperature, sample->humidity, sample->timestamp_ms, &report)) {
+                return;
+        }
+
+        LOG_WRN("[COND] Level %d: dew point %.1f C, margin %.1f C, RH slope %.2f %%/min",
+                report.level, (double)report.dew_point, (double)report.margin, (double)report.rh_slope);
+        outbound_frame_t frame = {
+                .kind = FRAME_CONDENSATION_ALERT,
+                .message_type = (report.level == COND_RISK_NONE) ? DATA_MESSAGE : ALERT_MESSAGE,
+                .room_name = ROOM_NAME,
+                .temperature = sample->temperature,
+                .humidity = sample->humidity,
+                .dew_point = report.dew_point,
+                .rh_slope = report.rh_slope,
+                .origin_ms = (uint32_t)sample->timestamp_ms,
+                .risk_level = report.level,
+                .is_simulated = sample->is_simulated,
+        };
+        if (zbus_chan_pub(&outbound_chan, &frame, K_NO_WAIT) != 0) {
+                // Back to the level the server knows: the next sample re-evaluates the change
+                condensation.level = sent_level;
+                LOG_WRN("[COND] Outbound channel busy, alert deferred to the next sample");
+        }
+}
+
+ZBUS_LISTENER_DEFINE(condensation_listener, condensation_listener_cb);
+ZBUS_CHAN_ADD_OBS(sample_chan, condensation_listener, 1);
+#endif
+
 
 /*
- * @thread System Health
+ * @service System Health
  * @priority HIGH (1)
  * @period 10 Seconds
- * Checks physical sensor wiring/status. Generates alerts on failure.
+ * Derives sensor wiring/status from the recorded acquisitions (probing only
+ * failed or idle sensors), publishes health_chan and
+ * generates alerts on failure. The server only gets a health report when a
+ * status changes, plus a heartbeat every CONFIG_APP_HEALTH_HEARTBEAT_S.
  */
-void system_health_entry_point(void *p1, void *p2, void *p3){
+static void system_health_run(void){
+        static health_status_code_t previous_status[2] = {0,0};
         health_status_code_t status[2] = {0,0};
-        health_status_code_t previous_status[2] = {0,0};
         bool state_changed = false;
 
-        while(1){
-                LOG_DBG("[HEALTH] Checking Hardware...");
-
-                // 1. Hardware Check (Protected)
-                k_mutex_lock(&sensors_lock, K_FOREVER);
-                check_system_health(dht20_dev_a, dht20_dev_b, status);
-                
-                // Update Global Flags safely
-                sensor_a_enabled = (status[0] <= 1);
-                sensor_b_enabled = (status[1] <= 1);
-                k_mutex_unlock(&sensors_lock);
-
-                // 2. Reporting (Protected)
-                k_mutex_lock(&coap_lock, K_FOREVER);
-
-                // Logic: Send ALERT only if Critical Error (>1)
-                // ? Keeping this block just for logging to db, in Python, we would remove sending the Alert by checking status (previous implementation)
-                bool is_critical = (status[0] > 1 || status[1] > 1);
-                if (is_critical){
-                        LOG_ERR("[HEALTH] CRITICAL FAILURE! A:%d B:%d", status[0], status[1]);
-                        // if critical or not critical, just send the data as simple. 
-                        msg_send_system_health_status(ALERT_MESSAGE, ROOM_NAME, status[0], status[1]);
-                } else {
-                        // ! IN CASE OF SENSOR DRIFT - SYSTEM HEALTH WILL BE SENT AS NORMAL
-                        msg_send_system_health_status(DATA_MESSAGE, ROOM_NAME, status[0], status[1]);
-                }
+        trace_span_begin(SPAN_SVC_HEALTH);
+        LOG_DBG("[HEALTH] Checking Hardware...");
+
+        // 1. Hardware Check (Protected: shares the I2C buses with Telemetry)
+        uint32_t lock_start = sensors_lock_take();
+        trace_span_begin(SPAN_HEALTH_CHECK);
+        check_system_health(dht20_dev_a, dht20_dev_b, status);
+        trace_span_end(SPAN_HEALTH_CHECK, (status[0] << 8) | status[1]);
+        sensors_lock_give(&health_lock_stats, lock_start);
+
+        // 2. Publish Health State (replaces the old global enable flags)
+        health_msg_t health = {
+                .status = {status[0], status[1]},
+                .sensor_a_enabled = (status[0] <= VALUE_DRIFT),
+                .sensor_b_enabled = (status[1] <= VALUE_DRIFT),
+        };
+        get_drift_report(&health.drift);
+        health.reliability[0] = get_sensor_reliability(0);
+        health.reliability[1] = get_sensor_reliability(1);
+        zbus_chan_pub(&health_chan, &health, K_FOREVER);
+        if (health.drift.drifting && previous_status[0] != VALUE_DRIFT && previous_status[1] != VALUE_DRIFT) {
+                LOG_WRN("[HEALTH] Sensor Drift: T_Off %.2f C, H_Off %.2f %%, confidence %.2f",
+                        (double)health.drift.temp_offset, (double)health.drift.humi_offset, (double)health.drift.confidence);
+        }
+
+        // 3. Reporting (by exception): full report on change, compact heartbeat otherwise
+        static bool reported = false;
+        static int64_t last_report_ms;
+        int64_t now = k_uptime_get();
+        outbound_frame_t frame = {
+                .kind = FRAME_HEALTH_STATUS,
+                .room_name = ROOM_NAME,
+                .sensor_status = {status[0], status[1]},
+        };
+
+        // Logic: If status(current states) are different from Previous States, send an alert. (Sensor/s either broke or fixed)
+        state_changed = (status[0] != previous_status[0]) || (status[1] != previous_status[1]);
+
+        // Logic: Send ALERT only if Critical Error (>1)
+        bool is_critical = (status[0] > 1 || status[1] > 1);
+        if (state_changed && is_critical) {
+                LOG_ERR("[HEALTH] CRITICAL FAILURE! A:%d B:%d", status[0], status[1]);
+        }
+
+        if (state_changed || !reported) {
+                // ! IN CASE OF SENSOR DRIFT - SYSTEM HEALTH WILL BE SENT AS NORMAL
+                frame.message_type = is_critical ? ALERT_MESSAGE : DATA_MESSAGE;
+                publish_frame(&frame);
+                reported = true;
+                last_report_ms = now;
+        } else if (now - last_report_ms >= HEALTH_HEARTBEAT_MS) {
+                frame.kind = FRAME_HEALTH_HEARTBEAT;
+                publish_frame(&frame);
+                last_report_ms = now;
+        }
 
-                // Logic: If status(current states) are different from Previous States, send an alert. (Sensor/s either broke or fixed)
-                state_changed = (status[0] != previous_status[0]) || (status[1] != previous_status[1]);
-                if (state_changed){
-                        if (!(previous_status[0] == status[0] && previous_status[1] == status[1])){
-                                if((status[0] == HEALTH_OK && status[1] == HEALTH_OK)){
-                                        msg_send_system_alert("sensor_fixed", ROOM_NAME, status[0], status[1]);
-                                        LOG_INF("✅ Sensor State Changed: FIXED");
-                                } else if ((status[0] != HEALTH_OK || status[1] != HEALTH_OK)){
-                                        msg_send_system_alert("sensor_fail", ROOM_NAME, status[0], status[1]);
-                                        LOG_ERR("⚠️ Sensor State Changed: FAILURE Detected");
-                                }
-                        }
+        if (state_changed){
+                frame.kind = FRAME_SYSTEM_ALERT;
+                if((status[0] == HEALTH_OK && status[1] == HEALTH_OK)){
+                        frame.message_type = "sensor_fixed";
+                        publish_frame(&frame);
+                        LOG_INF("✅ Sensor State Changed: FIXED");
+                } else {
+                        frame.message_type = "sensor_fail";
+                        publish_frame(&frame);
+                        LOG_ERR("⚠️ Sensor State Changed: FAILURE Detected");
                 }
-                previous_status[0] = status[0];
-                previous_status[1] = status[1];
-                k_mutex_unlock(&coap_lock);
-                k_msleep(10000); // Check every 10s
         }
+        previous_status[0] = status[0];
+        previous_status[1] = status[1];
+        trace_span_end(SPAN_SVC_HEALTH, 0);
 }
 
 
 /*
- * @thread Telemetry (Simple Data)
+ * @service Telemetry (Simple Data)
  * @priority MEDIUM (2)
  * @period 60 Seconds
- * Sends raw Temperature & Humidity data to dashboard.
+ * Sole acquisition point: reads the sensors (or the weather replay) once and
+ * publishes the sample on sample_chan for every consumer.
  */
-void simple_data_entry_point(void *p1, void *p2, void *p3){
-        while(1){
-                float temparature = 0.0f, humidity = 0.0f;  
-                bool valid_read = false;
+static void simple_data_run(void){
+        sample_msg_t sample = {.is_simulated = IS_SIMULATION_NODE};
+        health_msg_t health;
+        bool valid_read = false;
+
+        trace_span_begin(SPAN_SVC_TELEMETRY);
+        // 1. Get Data
+        if (IS_SIMULATION_NODE) {
+                // Recorded climate trace, same contract as get_sensor_data()
+                valid_read = weather_replay_read(&sample.temperature, &sample.humidity);
+        } else {
+                zbus_chan_read(&health_chan, &health, K_FOREVER);
+                uint32_t lock_start = sensors_lock_take();
+                valid_read = get_sensor_data(&health, &sample.temperature, &sample.humidity);
+                sensors_lock_give(&telemetry_lock_stats, lock_start);
+        }
 
-                // 1. Get Data
-                k_mutex_lock(&sensors_lock, K_FOREVER);
-                if (IS_SIMULATION_NODE) {
-                        valid_read = get_simulated_weather(&temparature, &humidity);
-                } else {
-                        valid_read = get_sensor_data(&temparature, &humidity);
-                }
-                k_mutex_unlock(&sensors_lock);
-
-                // 2. Send Data
-                if (valid_read){
-                        k_mutex_lock(&coap_lock, K_FOREVER);
-                        
-                        LOG_INF("[TELEMETRY] Sending Sensor Data....");
-                        msg_send_simple_data(DATA_MESSAGE, ROOM_NAME, temparature, humidity, sim_flag);
-                        k_mutex_unlock(&coap_lock);
-                } else {
-                        LOG_WRN("[TELEMETRY] Skipped: Sensors unavailable");
-                }
-                k_msleep(60000);
+        // 2. Publish (Telemetry Reporter, VTT and future consumers pick it up)
+        if (valid_read){
+                sample.timestamp_ms = k_uptime_get();
+                zbus_chan_pub(&sample_chan, &sample, K_FOREVER);
+        } else {
+                LOG_WRN("[TELEMETRY] Skipped: Sensors unavailable");
         }
+        trace_span_end(SPAN_SVC_TELEMETRY, valid_read);
 }
 
 /*
- * @thread VTT Model
+ * @service VTT Model
  * @priority LOW (3)
- * @period 15 Minutes (900s)
- * Calculates Mold Risk Index using VTT equation.
+ * @period 1 Hour
+ * Calculates Mold Risk Index using VTT equation on the latest cached sample
+ * (no extra I2C transaction) and publishes model_chan. Also woken by the VTT
+ * Phase Watcher when a sample crosses RH_crit; every run integrates the
+ * exact time since the previous one.
  */
-void vtt_model_entry_point(void *p1, void *p2, void *p3){
-        vtt_state_t room_state;
+#if defined(CONFIG_APP_VTT_ENSEMBLE)
+static vtt_ensemble_t room_ensemble; // Initialized in main()
+#define VTT_ALERT_CONFIDENCE (CONFIG_APP_VTT_ALERT_CONFIDENCE_PCT / 100.0f)
+#else
+static vtt_state_t room_state; // Initialized in main()
+#endif
 
-        // Initialize Model (Material Class: Sensitive)
-        vtt_init(&room_state, VTT_MAT_SENSITIVE);
+/**
+ * @brief Steps the model (single state or ensemble) and fills its output.
+ * @param dt_hours Model hours since the previous step.
+ */
+static void vtt_model_step(const sample_msg_t *sample, float dt_hours, model_msg_t *model){
+        model->temperature = sample->temperature;
+        model->humidity = sample->humidity;
+
+#if defined(CONFIG_APP_VTT_ENSEMBLE)
+        vtt_ensemble_report_t report;
+
+        trace_span_begin(SPAN_VTT_UPDATE);
+        vtt_ensemble_update(&room_ensemble, sample->temperature, sample->humidity, dt_hours);
+        vtt_ensemble_report(&room_ensemble, VTT_ALERT_CONFIDENCE, &report);
+        trace_span_end(SPAN_VTT_UPDATE, report.risk_confident);
+
+        model->mold_index = report.index_median;
+        model->mold_index_low = report.index_low;
+        model->mold_index_high = report.index_high;
+        model->risk_confidence = report.risk_confidence;
+        model->rh_crit = report.rh_crit;
+        model->risk_level = report.risk_median;
+        model->risk_confident = report.risk_confident;
+        model->growing_condition = report.growing_share >= VTT_ALERT_CONFIDENCE;
+
+        LOG_DBG("[VTT] M=%.2f [%.2f..%.2f], risk %d [%d..%d] (%.0f%%), confident risk %d, growing %.0f%%",
+                (double)report.index_median, (double)report.index_low, (double)report.index_high,
+                report.risk_median, report.risk_low, report.risk_high, (double)(report.risk_confidence * 100.0f),
+                report.risk_confident, (double)(report.growing_share * 100.0f));
+#else
+        trace_span_begin(SPAN_VTT_UPDATE);
+        vtt_update(&room_state, sample->temperature, sample->humidity, dt_hours);
+        trace_span_end(SPAN_VTT_UPDATE, room_state.growing_condition);
+
+        model->mold_index = room_state.mold_index;
+        model->mold_index_low = room_state.mold_index;
+        model->mold_index_high = room_state.mold_index;
+        model->risk_confidence = 1.0f;
+        model->rh_crit = room_state.rh_crit;
+        model->risk_level = vtt_get_risk_level(&room_state);
+        model->risk_confident = model->risk_level;
+        model->growing_condition = room_state.growing_condition;
+#endif
+}
 
-        while(1){
-                bool valid_read = false;
-                float temparature = 0.0f, humidity = 0.0f;  
+/**
+ * @brief Growth/decline crossing seen by the phase watcher, consumed by the VTT service.
+ */
+static struct {
+        struct k_spinlock lock;
+        bool pending;
+        sample_msg_t before;    /**< Last sample of the old phase */
+        int64_t at_ms;          /**< Acquisition time of the first sample of the new phase */
+} vtt_crossing;
 
-                // 1. Get Data
-                k_mutex_lock(&sensors_lock, K_FOREVER);
-                if (IS_SIMULATION_NODE) {
-                        valid_read = get_simulated_weather(&temparature, &humidity);
-                } else {
-                        valid_read = get_sensor_data(&temparature, &humidity);
+static int64_t vtt_last_step_ms; // End of the last integrated interval, 0 = none yet
+
+/**
+ * @brief Model hours from the last step to `until_ms` (one TIME_STEP for the first step).
+ */
+static float vtt_elapsed_hours(int64_t until_ms){
+        if (vtt_last_step_ms == 0) {
+                return TIME_STEP;
+        }
+        return TIME_STEP * (float)(until_ms - vtt_last_step_ms) / VTT_PERIOD_MS;
+}
+
+/**
+ * @brief Publishes the model output and its mold status frame.
+ */
+static void vtt_publish(const sample_msg_t *sample, const model_msg_t *model){
+        zbus_chan_pub(&model_chan, model, K_FOREVER);
+
+        // Determine Message Type (Alert if Risk High OR actively growing, by enough members)
+        outbound_frame_t frame = {
+                .kind = FRAME_MOLD_STATUS,
+                .message_type = (model->risk_confident == MOLD_RISK_CLEAN && !model->growing_condition) 
+                        ? DATA_MESSAGE : ALERT_MESSAGE,
+                .room_name = ROOM_NAME,
+                .temperature = sample->temperature,
+                .humidity = sample->humidity,
+                .mold_index = model->mold_index,
+                .origin_ms = (uint32_t)sample->timestamp_ms,
+                .risk_level = model->risk_confident,
+                .growing_condition = model->growing_condition,
+                .is_simulated = sample->is_simulated,
+        };
+        publish_frame(&frame);
+}
+
+static void vtt_model_run(void){
+        sample_msg_t sample;
+        model_msg_t model;
+        bool crossed;
+        sample_msg_t before;
+        int64_t crossing_ms;
+
+        trace_span_begin(SPAN_SVC_VTT);
+        // 1. Get Data (latest sample, must be fresh)
+        zbus_chan_read(&sample_chan, &sample, K_FOREVER);
+        int64_t now = k_uptime_get();
+        bool valid_read = (sample.timestamp_ms != 0) && (now - sample.timestamp_ms <= SAMPLE_MAX_AGE_MS);
+
+        k_spinlock_key_t key = k_spin_lock(&vtt_crossing.lock);
+        crossed = vtt_crossing.pending;
+        before = vtt_crossing.before;
+        crossing_ms = vtt_crossing.at_ms;
+        vtt_crossing.pending = false;
+        k_spin_unlock(&vtt_crossing.lock, key);
+
+        // 2. Process & Publish
+        if (valid_read){
+                LOG_DBG("[VTT] Running Model...");
+
+                // The old phase held up to the crossing sample: integrate that part with it
+                if (crossed && vtt_last_step_ms != 0 && crossing_ms > vtt_last_step_ms) {
+                        vtt_model_step(&before, vtt_elapsed_hours(crossing_ms), &model);
+                        vtt_last_step_ms = crossing_ms;
                 }
-                k_mutex_unlock(&sensors_lock);
 
-                // 2. Process & Send
-                if (valid_read){
-                        LOG_INF("[VTT] Running Model...");
+                // The rest of the interval (a few ms after an early wake) with the latest sample
+                vtt_model_step(&sample, vtt_elapsed_hours(now), &model);
+                vtt_last_step_ms = now;
+                vtt_publish(&sample, &model);
 
-                        vtt_update(&room_state, temparature, humidity, TIME_STEP);
-                        vtt_risk_level_t mold_risk_level = vtt_get_risk_level(&room_state); 
-                        k_mutex_lock(&coap_lock, K_FOREVER);
+                if (crossed) {
+                        LOG_INF("[VTT] RH_crit crossed (growing: %d), published %lld ms after the crossing sample",
+                                model.growing_condition, now - crossing_ms);
+                }
+        } else {
+                // Unknown conditions: the interval is dropped, not integrated later
+                vtt_last_step_ms = now;
+                LOG_WRN("[VTT] Skipped: Sensors unavailable");
+        }
+        trace_span_end(SPAN_SVC_VTT, valid_read);
+}
 
-                        // Determine Message Type (Alert if Risk High OR actively growing)
-                        char *msg_type = (mold_risk_level == MOLD_RISK_CLEAN && !room_state.growing_condition) 
-                             ? DATA_MESSAGE : ALERT_MESSAGE;
+// * --- SERVICE TABLE --- *
+static periodic_service_t system_health_svc = {.run = system_health_run, .period_ms = HEALTH_PERIOD_MS};
+static periodic_service_t simple_data_svc = {.run = simple_data_run, .period_ms = TELEMETRY_PERIOD_MS};
+static periodic_service_t vtt_model_svc = {.run = vtt_model_run, .period_ms = VTT_PERIOD_MS};
 
-                        msg_send_mold_status(msg_type, ROOM_NAME, temparature, humidity, room_state.mold_index, mold_risk_level, room_state.growing_condition, sim_flag);
-                        k_mutex_unlock(&coap_lock);
+#if !defined(CONFIG_APP_WORKQUEUE_MODEL)
+/*
+ * @brief Thread model: one thread per service, running it in a sleep loop.
+ * @param p1 periodic_service_t to run.
+ */
+void periodic_service_entry_point(void *p1, void *p2, void *p3){
+        periodic_service_t *svc = p1;
 
-                } else {
-                        LOG_WRN("[VTT] Skipped: Sensors unavailable");
+        while(1){
+                svc->run();
+
+                // Extra iterations (service_wake()) do not move the regular one
+                int64_t due = k_uptime_get() + svc->period_ms;
+                while (k_sem_take(&svc->wake, K_MSEC(MAX(due - k_uptime_get(), 0))) == 0) {
+                        svc->run();
+                }
+        }
+}
+#endif
+
+/**
+ * @brief Runs one extra iteration of a service now, in its own context.
+ */
+static void service_wake(periodic_service_t *svc){
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+        app_workqueue_wake(svc);
+#else
+        k_sem_give(&svc->wake);
+#endif
+}
+
+/*
+ * @listener VTT Phase Watcher
+ * Tracks whether the samples are above or below RH_crit (with
+ * VTT_WAKE_HYST_RH of hysteresis) and wakes the VTT service when they cross
+ * it, so growth/decline transitions are published one sample after they
+ * happen instead of at the next hourly step.
+ */
+static void vtt_phase_watcher_cb(const struct zbus_channel *chan)
+{
+        static sample_msg_t last;
+        static bool growing;
+        const sample_msg_t *sample = zbus_chan_const_msg(chan);
+
+#if defined(CONFIG_APP_VTT_ENSEMBLE)
+        float rh_crit = vtt_rh_critical(&room_ensemble.member[VTT_ENSEMBLE_CENTER], sample->temperature);
+#else
+        float rh_crit = vtt_rh_critical(&room_state, sample->temperature);
+#endif
+
+        bool crossed = false;
+        if (last.timestamp_ms == 0) {
+                growing = sample->humidity > rh_crit;
+        } else if (!growing && sample->humidity > rh_crit + VTT_WAKE_HYST_RH) {
+                growing = crossed = true;
+        } else if (growing && sample->humidity < rh_crit - VTT_WAKE_HYST_RH) {
+                growing = false;
+                crossed = true;
+        }
+
+        if (crossed) {
+                k_spinlock_key_t key = k_spin_lock(&vtt_crossing.lock);
+                if (!vtt_crossing.pending) {
+                        vtt_crossing.pending = true;
+                        vtt_crossing.before = last;
+                        vtt_crossing.at_ms = sample->timestamp_ms;
                 }
-                k_msleep(3600000); // 1 hour = 3600000 milliseconds
+                k_spin_unlock(&vtt_crossing.lock, key);
+                service_wake(&vtt_model_svc);
         }
+        last = *sample;
 }
 
+ZBUS_LISTENER_DEFINE(vtt_phase_watcher, vtt_phase_watcher_cb);
+ZBUS_CHAN_ADD_OBS(sample_chan, vtt_phase_watcher, 2);
+
 int main(void)
 {
         LOG_INF("--- Sensor Node Booting ---");
 
-        // * 1. Initialize Network Stack
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+        // * 0. Start the shared work queue (hosts the Messaging TX work too)
+        app_workqueue_start();
+#endif
+
+        // * 1. Initialize Network Stack (also starts the Messaging TX thread)
         msg_init();
 
-        // * 2. Wait for Network Attachment
-        LOG_INF("[MAIN] Waiting for OpenThread Attachment (10s)...");
-        k_sleep(K_SECONDS(10));
+        // * 2. No wait for Network Attachment: the services warm up while the
+        // node attaches, the Messaging Service holds frames until the role is
+        // Child/Router/Leader and sends them right after.
+        LOG_INF("[MAIN] Starting services, attach in progress (attached: %d)", msg_is_attached());
+
+#if defined(CONFIG_APP_LATEST_RESOURCE)
+        // Pull mode: GET /latest answers from the channels below, no extra sensor read
+        latest_resource_start(ROOM_NAME, TELEMETRY_PERIOD_MS);
+#endif
 
+        if (IS_SIMULATION_NODE) {
+                weather_replay_init();
+        }
+
+        // Initialize Model (Material Class: Sensitive)
+#if defined(CONFIG_APP_VTT_ENSEMBLE)
+        vtt_ensemble_init(&room_ensemble, ROOM_MATERIAL, VTT_ENSEMBLE_SIGMA_TEMP, VTT_ENSEMBLE_SIGMA_HUMI);
+#else
+        vtt_init(&room_state, ROOM_MATERIAL);
+#endif
+
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+        // * 3. Schedule Services (scheduling order = priority order on the queue)
+        app_workqueue_schedule(&system_health_svc, K_NO_WAIT);
+        app_workqueue_schedule(&simple_data_svc, K_SECONDS(4));
+        app_workqueue_schedule(&vtt_model_svc, K_SECONDS(6));
+        LOG_INF("[MAIN] All services scheduled on app_wq. Entering Idle.");
+#else
         // * 3. Spawn Threads
+        k_sem_init(&system_health_svc.wake, 0, 1);
+        k_sem_init(&simple_data_svc.wake, 0, 1);
+        k_sem_init(&vtt_model_svc.wake, 0, 1);
 
         // System Health (Starts NOW)
-        k_thread_create(&system_health_data, system_health_stack, K_THREAD_STACK_SIZEOF(system_health_stack), system_health_entry_point, NULL,NULL,NULL, HIGHEST_PRIORITY, 0, K_NO_WAIT);
+        k_thread_create(&system_health_data, system_health_stack, K_THREAD_STACK_SIZEOF(system_health_stack), periodic_service_entry_point, &system_health_svc,NULL,NULL, HIGHEST_PRIORITY, 0, K_NO_WAIT);
+        k_thread_name_set(&system_health_data, "health");
 
-        // Telemetry (Starts +4s)
-        k_thread_create(&simple_data, simple_data_stack, K_THREAD_STACK_SIZEOF(simple_data_stack), simple_data_entry_point, NULL,NULL,NULL, MEDIUM_PRIORITY, 0, K_SECONDS(4));
+        // Telemetry (Starts +4s, after the first health check has enabled the sensors)
+        k_thread_create(&simple_data, simple_data_stack, K_THREAD_STACK_SIZEOF(simple_data_stack), periodic_service_entry_point, &simple_data_svc,NULL,NULL, MEDIUM_PRIORITY, 0, K_SECONDS(4));
+        k_thread_name_set(&simple_data, "telemetry");
         
-        // VTT Model (Starts +4s)
-        k_thread_create(&vtt_model_data, vtt_model_stack, K_THREAD_STACK_SIZEOF(vtt_model_stack), vtt_model_entry_point, NULL,NULL,NULL, LOWEST_PRIORITY, 0, K_SECONDS(4));
+        // VTT Model (Starts +6s, after the first sample has been published)
+        k_thread_create(&vtt_model_data, vtt_model_stack, K_THREAD_STACK_SIZEOF(vtt_model_stack), periodic_service_entry_point, &vtt_model_svc,NULL,NULL, LOWEST_PRIORITY, 0, K_SECONDS(6));
+        k_thread_name_set(&vtt_model_data, "vtt");
 
         LOG_INF("[MAIN] All threads spawned. Entering Idle.");
+#endif
+        resource_report_start();
         return 0;
-}
+}
\ No newline at end of file
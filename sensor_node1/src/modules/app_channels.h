@@ -0,0 +1,94 @@
+/**
+ * @file app_channels.h
+ * @brief zbus Channels of the Sensor Node
+ * * Every service talks to the others only through these channels:
+ * - sample_chan:   Latest averaged Temperature/Humidity sample (Telemetry -> *)
+ * - health_chan:   Sensor health codes and enable flags (Health -> *)
+ * - model_chan:    Latest VTT model output (VTT -> *)
+ * - outbound_chan: Frames waiting to be sent over CoAP (* -> Messaging)
+ * * Producers publish, consumers attach themselves with ZBUS_CHAN_ADD_OBS()
+ * in their own module, so adding a consumer (fusion, history, aggregation)
+ * touches neither the producers nor this file.
+ */
+#ifndef APP_CHANNELS_H
+#define APP_CHANNELS_H
+
+#include <zephyr/kernel.h>
+#include <zephyr/zbus/zbus.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "system_health.h"
+#include "vtt_model.h"
+
+/**
+ * @brief One processed sample (averaged or failover).
+ */
+typedef struct {
+    float temperature;      /**< Temperature (Celsius) */
+    float humidity;         /**< Relative Humidity (%) */
+    int64_t timestamp_ms;   /**< k_uptime_get() at acquisition, 0 = no sample yet */
+    bool is_simulated;      /**< True if the sample came from the simulation source */
+} sample_msg_t;
+
+/**
+ * @brief Result of one health check.
+ */
+typedef struct {
+    health_status_code_t status[2]; /**< Status codes for Sensor A and Sensor B */
+    bool sensor_a_enabled;          /**< Sensor A usable for acquisition (status <= VALUE_DRIFT) */
+    bool sensor_b_enabled;          /**< Sensor B usable for acquisition (status <= VALUE_DRIFT) */
+    drift_report_t drift;           /**< Estimated A - B offsets and confidence */
+    float reliability[2];           /**< Reliability score of Sensor A and B (1.0 = no failed acquisition) */
+} health_msg_t;
+
+/**
+ * @brief Output of one VTT model step.
+ */
+typedef struct {
+    float temperature;          /**< Input Temperature used for the step */
+    float humidity;             /**< Input Humidity used for the step */
+    float mold_index;           /**< Mold Index after the step (0.0 to 6.0), ensemble median */
+    float mold_index_low;       /**< Lowest ensemble member (= mold_index without the ensemble) */
+    float mold_index_high;      /**< Highest ensemble member (= mold_index without the ensemble) */
+    float risk_confidence;      /**< Share of members at or above risk_level (1.0 without the ensemble) */
+    float rh_crit;              /**< Critical Humidity for the input Temperature */
+    vtt_risk_level_t risk_level;/**< Simplified risk level of mold_index */
+    vtt_risk_level_t risk_confident; /**< Risk level the required share of members agrees on */
+    bool growing_condition;     /**< True if in Growth Phase (by the required share of members) */
+} model_msg_t;
+
+/**
+ * @brief Kinds of frames the Messaging Service knows how to encode.
+ */
+typedef enum {
+    FRAME_SIMPLE_DATA = 0,  /**< msg_send_simple_data() */
+    FRAME_MOLD_STATUS,      /**< msg_send_mold_status() */
+    FRAME_HEALTH_STATUS,    /**< msg_send_system_health_status() */
+    FRAME_SYSTEM_ALERT,     /**< msg_send_system_alert() */
+    FRAME_HEALTH_HEARTBEAT, /**< msg_send_health_heartbeat() */
+    FRAME_CONDENSATION_ALERT /**< msg_send_condensation_alert() */
+} frame_kind_t;
+
+/**
+ * @brief A frame waiting for transmission.
+ * * String members must point to string literals (they are not copied).
+ */
+typedef struct {
+    frame_kind_t kind;
+    const char *message_type;   /**< "DATA"/"ALERT", or the event name for FRAME_SYSTEM_ALERT */
+    const char *room_name;      /**< Location identifier */
+    float temperature;
+    float humidity;
+    float mold_index;
+    float dew_point;            /**< FRAME_CONDENSATION_ALERT: dew point (C) */
+    float rh_slope;             /**< FRAME_CONDENSATION_ALERT: RH trend (%RH per minute) */
+    uint32_t origin_ms;         /**< Acquisition time of the sample (k_uptime_get() truncated), sent as fleet time */
+    int risk_level;             /**< Mold risk level, or condensation level (cond_risk_t) */
+    int sensor_status[2];
+    bool growing_condition;
+    bool is_simulated;
+} outbound_frame_t;
+
+ZBUS_CHAN_DECLARE(sample_chan, health_chan, model_chan, outbound_chan);
+
+#endif
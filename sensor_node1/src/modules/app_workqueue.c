@@ -0,0 +1,53 @@
+/**
+ * @file app_workqueue.c
+ * @brief Implementation of the Shared Application Work Queue
+ */
+#include "app_workqueue.h"
+
+K_THREAD_STACK_DEFINE(app_work_q_stack, CONFIG_APP_WORKQUEUE_STACK_SIZE);
+struct k_work_q app_work_q;
+
+/**
+ * @brief Runs one iteration and re-arms the service for the next period.
+ */
+static void periodic_service_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    periodic_service_t *svc = CONTAINER_OF(dwork, periodic_service_t, work);
+
+    svc->run();
+    k_work_reschedule_for_queue(&app_work_q, &svc->work, K_MSEC(svc->period_ms));
+}
+
+/**
+ * @brief Runs one extra iteration (the delayable work keeps its deadline).
+ */
+static void periodic_service_wake_handler(struct k_work *work)
+{
+    periodic_service_t *svc = CONTAINER_OF(work, periodic_service_t, wake_work);
+
+    svc->run();
+}
+
+void app_workqueue_start(void)
+{
+    const struct k_work_queue_config cfg = {
+        .name = "app_wq",
+    };
+
+    k_work_queue_start(&app_work_q, app_work_q_stack,
+                       K_THREAD_STACK_SIZEOF(app_work_q_stack),
+                       CONFIG_APP_WORKQUEUE_PRIORITY, &cfg);
+}
+
+void app_workqueue_schedule(periodic_service_t *svc, k_timeout_t delay)
+{
+    k_work_init_delayable(&svc->work, periodic_service_handler);
+    k_work_init(&svc->wake_work, periodic_service_wake_handler);
+    k_work_reschedule_for_queue(&app_work_q, &svc->work, delay);
+}
+
+void app_workqueue_wake(periodic_service_t *svc)
+{
+    k_work_submit_to_queue(&app_work_q, &svc->wake_work);
+}
@@ -0,0 +1,50 @@
+/**
+ * @file app_workqueue.h
+ * @brief Shared Application Work Queue (CONFIG_APP_WORKQUEUE_MODEL)
+ * * In the work queue execution model every periodic service is a
+ * periodic_service_t scheduled on app_work_q. In the thread model the same
+ * descriptor is passed to a dedicated thread that runs the service in a
+ * sleep loop, so services are written once for both models.
+ */
+#ifndef APP_WORKQUEUE_H
+#define APP_WORKQUEUE_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+/**
+ * @brief A service that runs one iteration every period_ms.
+ */
+typedef struct {
+    struct k_work_delayable work;   /**< Used only in the work queue model */
+    struct k_work wake_work;        /**< Work queue model: extra iteration (app_workqueue_wake()) */
+    struct k_sem wake;              /**< Thread model: extra iteration, given by the waker */
+    void (*run)(void);              /**< One iteration of the service */
+    int32_t period_ms;              /**< Delay between two iterations */
+} periodic_service_t;
+
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+/** @brief The single application work queue. */
+extern struct k_work_q app_work_q;
+
+/**
+ * @brief Starts app_work_q. Must be called before scheduling any service.
+ */
+void app_workqueue_start(void);
+
+/**
+ * @brief Schedules a periodic service on app_work_q.
+ * @param svc   Service descriptor (must stay valid forever).
+ * @param delay Delay before the first iteration.
+ */
+void app_workqueue_schedule(periodic_service_t *svc, k_timeout_t delay);
+
+/**
+ * @brief Runs one extra iteration of a scheduled service as soon as possible.
+ * The regular schedule is not moved.
+ * @param svc Service descriptor passed to app_workqueue_schedule().
+ */
+void app_workqueue_wake(periodic_service_t *svc);
+#endif
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file condensation_monitor.c
+ * @brief Implementation of the Condensation Early Warning
+ */
+#include "condensation_monitor.h"
+#include <math.h>
+#include <string.h>
+
+// * --- CONFIGURATION --- *
+#define MAGNUS_B            17.62f
+#define MAGNUS_C            243.12f     // C
+#define SLOPE_ALPHA         0.5f        // EWMA weight of the newest step
+#define SLOPE_MIN_RISING    0.05f       // %RH/min below which RH is not trending up
+
+void cond_monitor_init(cond_monitor_t *mon) {
+    memset(mon, 0, sizeof(*mon));
+    mon->level = COND_RISK_NONE;
+}
+
+float cond_dew_point(float temp_c, float rh_percent) {
+    float rh = fminf(fmaxf(rh_percent, 1.0f), 100.0f);
+    float gamma = logf(rh / 100.0f) + (MAGNUS_B * temp_c) / (MAGNUS_C + temp_c);
+    return (MAGNUS_C * gamma) / (MAGNUS_B - gamma);
+}
+
+/**
+ * @brief Next level from the margin, the trend and the current level (hysteresis).
+ */
+static cond_risk_t next_level(cond_risk_t level, float margin, float rh, float slope) {
+    bool saturating_soon = (slope > SLOPE_MIN_RISING) && ((100.0f - rh) / slope <= COND_HORIZON_MIN);
+
+    if (margin <= COND_MARGIN_CONDENSING) {
+        return COND_RISK_CONDENSING;
+    }
+    if (level == COND_RISK_CONDENSING && margin <= COND_MARGIN_CONDENSING_EXIT) {
+        return COND_RISK_CONDENSING;
+    }
+    if (margin <= COND_MARGIN_NEAR || saturating_soon) {
+        return COND_RISK_NEAR;
+    }
+    if (level != COND_RISK_NONE && margin <= COND_MARGIN_NEAR_EXIT) {
+        return COND_RISK_NEAR;
+    }
+    return COND_RISK_NONE;
+}
+
+bool cond_monitor_update(cond_monitor_t *mon, float temp_c, float rh_percent, int64_t timestamp_ms,
+                         cond_report_t *report) {
+    if (mon->has_last && timestamp_ms > mon->last_ms) {
+        float minutes = (timestamp_ms - mon->last_ms) / 60000.0f;
+        float step = (rh_percent - mon->last_rh) / minutes;
+        mon->rh_slope += SLOPE_ALPHA * (step - mon->rh_slope);
+    }
+    mon->last_rh = rh_percent;
+    mon->last_ms = timestamp_ms;
+    mon->has_last = true;
+
+    report->dew_point = cond_dew_point(temp_c, rh_percent);
+    report->margin = fmaxf(temp_c - report->dew_point, 0.0f);
+    report->rh_slope = mon->rh_slope;
+
+    cond_risk_t level = next_level(mon->level, report->margin, rh_percent, mon->rh_slope);
+    bool changed = (level != mon->level);
+    mon->level = level;
+    report->level = level;
+    return changed;
+}
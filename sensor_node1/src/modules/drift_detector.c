@@ -0,0 +1,65 @@
+/**
+ * @file drift_detector.c
+ * @brief Implementation of the EWMA/CUSUM Drift Detector
+ */
+#include "drift_detector.h"
+#include <math.h>
+#include <string.h>
+
+// * --- CONFIGURATION --- *
+#define DRIFT_LAMBDA          0.05f  // EWMA weight (~40 samples memory)
+#define DRIFT_WARMUP_SAMPLES  10     // No decision before the noise estimate settles
+#define DRIFT_CUSUM_CLIP      3.0f   // Max contribution of one sample (noise units)
+#define DRIFT_CUSUM_LIMIT     8.0f   // Decision interval h (noise units)
+
+void drift_detector_init(drift_detector_t *det, float tolerance, float noise_floor) {
+    memset(det, 0, sizeof(*det));
+    det->tolerance = tolerance;
+    det->noise_floor = noise_floor;
+}
+
+bool drift_detector_update(drift_detector_t *det, float diff) {
+    if (det->samples == 0) {
+        det->mean = diff;
+        det->last = diff;
+        det->noise_var = det->noise_floor * det->noise_floor;
+    }
+    det->samples++;
+
+    // 1. Statistics (EWMA mean / variance, step-based noise)
+    float step = diff - det->last;
+    det->last = diff;
+    det->noise_var += DRIFT_LAMBDA * ((step * step) / 2.0f - det->noise_var);
+
+    float error = diff - det->mean;
+    det->mean += DRIFT_LAMBDA * error;
+    det->var = (1.0f - DRIFT_LAMBDA) * (det->var + DRIFT_LAMBDA * error * error);
+
+    // 2. CUSUM on the excess over the tolerance, in noise units
+    float sigma = fmaxf(sqrtf(det->noise_var), det->noise_floor);
+    float z_pos = fminf((diff - det->tolerance) / sigma, DRIFT_CUSUM_CLIP);
+    float z_neg = fminf((-diff - det->tolerance) / sigma, DRIFT_CUSUM_CLIP);
+
+    // Capped at 2h so the alarm clears within a few samples once drift stops
+    det->cusum_pos = fminf(fmaxf(0.0f, det->cusum_pos + z_pos), 2.0f * DRIFT_CUSUM_LIMIT);
+    det->cusum_neg = fminf(fmaxf(0.0f, det->cusum_neg + z_neg), 2.0f * DRIFT_CUSUM_LIMIT);
+
+    // 3. Decision
+    det->drifting = (det->samples >= DRIFT_WARMUP_SAMPLES) &&
+                    (det->cusum_pos > DRIFT_CUSUM_LIMIT || det->cusum_neg > DRIFT_CUSUM_LIMIT);
+    return det->drifting;
+}
+
+float drift_detector_confidence(const drift_detector_t *det) {
+    if (det->samples < DRIFT_WARMUP_SAMPLES) {
+        return 0.0f;
+    }
+
+    // Standard error of the EWMA mean: sigma_d * sqrt(lambda / (2 - lambda))
+    float noise = fmaxf(det->var, det->noise_floor * det->noise_floor);
+    float std_err = sqrtf(noise * DRIFT_LAMBDA / (2.0f - DRIFT_LAMBDA));
+
+    // P(|offset| > tolerance) under a normal estimate: Phi((|mean| - tol) / se)
+    float z = (fabsf(det->mean) - det->tolerance) / std_err;
+    return 0.5f * (1.0f + erff(z / sqrtf(2.0f)));
+}
@@ -0,0 +1,66 @@
+/**
+ * @file flatline_detector.c
+ * @brief Implementation of the Stuck-Value (Flatline) Detector
+ */
+#include "flatline_detector.h"
+#include <string.h>
+
+// * --- CONFIGURATION --- *
+#define FLATLINE_IDENTICAL_MAX  30      // 30 min of identical frames at a 60 s telemetry period
+#define FLATLINE_WINDOW         30      // Reading pairs per quiet-window verdict
+#define FLATLINE_QUIET_ENERGY   0.01f   // Mean squared step below (0.1 x noise)^2 = frozen
+#define FLATLINE_ACTIVE_ENERGY  0.25f   // The other sensor moves at least (0.5 x noise)^2
+
+void flatline_detector_init(flatline_detector_t *det, float temp_noise, float humi_noise) {
+    memset(det, 0, sizeof(*det));
+    det->temp_noise = temp_noise;
+    det->humi_noise = humi_noise;
+}
+
+/**
+ * @brief Accumulates one reading of one sensor.
+ */
+static void accumulate(flatline_detector_t *det, flatline_sensor_t *s, float temp, float humi) {
+    if (s->has_last) {
+        bool identical = (temp == s->last_temp) && (humi == s->last_humi);
+        s->identical_run = identical ? s->identical_run + 1 : 0;
+
+        float dt = (temp - s->last_temp) / det->temp_noise;
+        float dh = (humi - s->last_humi) / det->humi_noise;
+        s->step_energy += dt * dt + dh * dh;
+        s->steps++;
+    }
+    s->last_temp = temp;
+    s->last_humi = humi;
+    s->has_last = true;
+}
+
+void flatline_detector_update(flatline_detector_t *det, const bool valid[2],
+                              const float temp[2], const float humi[2], bool stuck[2]) {
+    for (int i = 0; i < 2; i++) {
+        if (valid[i]) {
+            accumulate(det, &det->sensor[i], temp[i], humi[i]);
+        } else {
+            // A failed read breaks the sequence, start over once it is back
+            memset(&det->sensor[i], 0, sizeof(det->sensor[i]));
+        }
+    }
+
+    // Window verdict: only when both sensors filled the same window
+    flatline_sensor_t *a = &det->sensor[0];
+    flatline_sensor_t *b = &det->sensor[1];
+    if (a->steps >= FLATLINE_WINDOW && b->steps >= FLATLINE_WINDOW) {
+        float energy_a = a->step_energy / a->steps;
+        float energy_b = b->step_energy / b->steps;
+
+        a->window_quiet = (energy_a < FLATLINE_QUIET_ENERGY) && (energy_b > FLATLINE_ACTIVE_ENERGY);
+        b->window_quiet = (energy_b < FLATLINE_QUIET_ENERGY) && (energy_a > FLATLINE_ACTIVE_ENERGY);
+        a->step_energy = b->step_energy = 0.0f;
+        a->steps = b->steps = 0;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        const flatline_sensor_t *s = &det->sensor[i];
+        stuck[i] = valid[i] && (s->identical_run >= FLATLINE_IDENTICAL_MAX || s->window_quiet);
+    }
+}
@@ -0,0 +1,31 @@
+/**
+ * @file latest_resource.h
+ * @brief Pull-Mode Latest Values (CONFIG_APP_LATEST_RESOURCE)
+ * * Serves `GET coap://[node]/latest`: the last sample, health codes and
+ * model output as one JSON payload (payload_encode_latest()), read from
+ * sample_chan, health_chan and model_chan. A request never triggers an
+ * I2C fetch, so a dashboard refresh or a commissioning check costs the
+ * node nothing but the radio.
+ * * Caching (RFC 7252 5.10):
+ * - ETag: CRC-32 of the payload, so it changes with the state only.
+ *   A request carrying the current ETag gets 2.03 Valid without payload.
+ * - Max-Age: seconds until the next telemetry sample is due.
+ * Before the first sample the node answers 5.03 with a short Max-Age.
+ * * The handler runs in the OpenThread context. On a Sleepy End Device the
+ * response waits for the next data poll (or CSL window).
+ */
+#ifndef LATEST_RESOURCE_H
+#define LATEST_RESOURCE_H
+
+#include <stdint.h>
+
+#define LATEST_URI_PATH "latest"
+
+/**
+ * @brief Registers the resource. Call after msg_init() (CoAP started).
+ * @param room_name Location identifier (string literal, not copied).
+ * @param sample_period_ms Telemetry period, for Max-Age.
+ */
+void latest_resource_start(const char *room_name, uint32_t sample_period_ms);
+
+#endif
@@ -3,16 +3,52 @@
  * @brief Implementation of CoAP Messaging over OpenThread
  * * Uses the Zephyr OpenThread API to construct CoAP Confirmable (CON) PUT requests
  * containing JSON payloads.
+ * * A dedicated TX thread (or, with CONFIG_APP_WORKQUEUE_MODEL, a work item on
+ * app_work_q) drains outbound_chan through a zbus message subscriber, so it
+ * is the only user of json_buffer and the OpenThread CoAP client.
+ * * Startup Gate: an OpenThread state-changed callback tracks the device role.
+ * Frames are queued until the node is attached (child/router/leader), so the
+ * services can warm up in parallel with the network attach and the first
+ * frames leave as soon as the role changes.
+ * * Radio-Aligned Batching (CONFIG_APP_SED_REPORTING): on a Sleepy End Device
+ * frames are collected and sent back-to-back once per poll period, on a grid
+ * anchored at the attach time, so one radio wake carries the whole batch.
+ * System alerts flush the batch at once.
+ * * Fleet Clock (CONFIG_APP_TIME_SYNC): the server multicasts time beacons to
+ * the "time" resource. The handler (OpenThread context) feeds them into the
+ * discipline filter; frames carry the sample's uptime and it is converted to
+ * fleet time at encode time, so frames queued before the first beacon (or
+ * held for a radio window) still leave with the best offset known.
+ * * Sample Batching (CONFIG_APP_SAMPLE_BATCH): telemetry samples are not sent
+ * one JSON payload each but appended to a compressed series (ts_codec.h)
+ * with the latest Mold Index, and sent as one Confirmable PUT /batch when
+ * it holds CONFIG_APP_SAMPLE_BATCH_SAMPLES samples or the next one does not
+ * fit the frame.
+ * * Loopback: without OpenThread (native_sim) the node counts as attached at
+ * once and every payload is logged and treated as delivered, so the whole
+ * pipeline runs on Linux.
  * @authors: muzamil.py, Google Gemini 3 Pro
  * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
  */
 #include "messaging_service.h"
+#include "app_channels.h"
+#include "app_workqueue.h"
+#include "trace_spans.h"
+#include "payload_encoder.h"
+#include "link_metrics.h"
+#include "time_sync.h"
+#include "ts_codec.h"
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#if defined(CONFIG_NET_L2_OPENTHREAD)
 #include <openthread/coap.h>
 #include <openthread/thread.h>
+#include <openthread/link.h>
+#include <zephyr/net/openthread.h>
+#endif
 #include <math.h>
 #include <stdio.h> 
+#include <string.h>
 
 LOG_MODULE_REGISTER(messaging, LOG_LEVEL_INF);
 
@@ -26,56 +62,320 @@ LOG_MODULE_REGISTER(messaging, LOG_LEVEL_INF);
 // The CoAP Resource Path on the server (e.g., coap://[addr]/storedata)
 #define URI_PATH "storedata"
 
-// Shared buffer for constructing JSON strings.
-// PROTECTED BY: coap_lock (defined in main.c)
-static char json_buffer[256];
+// Resource the server's time beacons are multicast to (coap://[ff03::1]/time)
+#define TIME_URI_PATH "time"
+#define TIME_BEACON_MAX_LEN 48
+
+// TX Thread Configuration
+#define MSG_TX_STACK_SIZE 2048
+#define MSG_TX_PRIORITY 2
+
+// Attach gate: role polling interval if no state-changed slot is free
+#define ATTACH_POLL_MS 250
+
+// ACK context marking telemetry samples (time-to-first-delivered-sample)
+#define MSG_CTX_SAMPLE ((void *)1)
+// Context marking Non-confirmable payloads (no ACK, no callback)
+#define MSG_CTX_NON ((void *)2)
+// Condensation alerts in flight at once, each with its own latency slot
+#define COND_ALERT_SLOTS 4
+
+// Buffer for constructing JSON strings.
+// OWNED BY: the TX thread (only caller of the msg_send_* functions)
+static char json_buffer[PAYLOAD_MAX_LEN];
+
+// --- zbus Wiring ---
+// Message subscriber: every published frame is copied into its own queue,
+// so bursts from several services are never overwritten before sending.
+ZBUS_MSG_SUBSCRIBER_DEFINE(msg_tx_sub);
+ZBUS_CHAN_ADD_OBS(outbound_chan, msg_tx_sub, 0);
+
+#if !defined(CONFIG_APP_WORKQUEUE_MODEL)
+// --- Thread Data ---
+struct k_thread msg_tx_thread_data;
+K_THREAD_STACK_DEFINE(msg_tx_stack, MSG_TX_STACK_SIZE);
+#endif
+
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+static struct k_work msg_tx_work;
+#endif
+
+#if defined(CONFIG_APP_SED_REPORTING)
+// --- Radio-Aligned Batching ---
+// OWNED BY: the TX thread / TX work (same as json_buffer)
+static outbound_frame_t tx_batch[CONFIG_APP_SED_BATCH_MAX];
+static size_t tx_batch_len;
+static int64_t window_anchor_ms;    /**< Grid origin: uptime of the last attach */
+static uint32_t window_period_ms;   /**< Poll period read back from OpenThread */
+static uint32_t sed_windows;        /**< Radio windows used for sending */
+static uint32_t sed_frames;         /**< Frames sent inside those windows */
+#endif
+
+// --- Attach Gate ---
+#define NET_EVENT_ATTACHED BIT(0)
+static K_EVENT_DEFINE(net_events);
+static int64_t attach_time_ms;          /**< Uptime of the first attach, 0 = never */
+static int64_t first_sample_ack_ms;     /**< Uptime of the first ACKed sample, 0 = none */
+
+// --- Condensation Alert Latency ---
+/**
+ * @brief An alert in flight: passed as its CoAP response context, so the
+ * latency is measured from its own sample even when alerts overlap.
+ */
+typedef struct {
+    atomic_t busy;          /**< Claimed by the TX thread, freed by the response */
+    uint32_t origin_ms;     /**< Sample time of the alert */
+} cond_alert_slot_t;
+
+static cond_alert_slot_t cond_alert_slots[COND_ALERT_SLOTS];
+// Written by the delivery callback
+static uint32_t cond_alert_count;
+static uint32_t cond_alert_total_ms;
+static uint32_t cond_alert_max_ms;
+
+#if defined(CONFIG_APP_SAMPLE_BATCH)
+// --- Sample Batching ---
+// OWNED BY: the TX thread / TX work (same as json_buffer)
+#define BATCH_ROOM_MAX 31
+#define BATCH_UNIT_MS 100   // Timestamp resolution of the series
+static uint8_t batch_frame[BATCH_ROOM_MAX + 2 + CONFIG_APP_SAMPLE_BATCH_MAX_BYTES];
+static size_t batch_header_len;     /**< Room name, NUL and flags before the series, 0 = no open batch */
+static ts_encoder_t batch_enc;
+static float batch_mold_index;      /**< Latest Mold Index sent, attached to every sample */
+static bool batch_uptime;           /**< Open batch is stamped with uptime (TS_BATCH_FLAG_UPTIME) */
+#endif
+
+#if defined(CONFIG_APP_TIME_SYNC)
+// --- Fleet Clock ---
+// Written by the beacon handler (OpenThread context), read by the TX thread
+static time_sync_t fleet_clock;
+static struct k_spinlock fleet_clock_lock;
+#endif
+
+/**
+ * @brief Opens or closes the gate.
+ * @param attached  New attach state.
+ * @param role_name Device role, for the log.
+ */
+static void _update_attach_gate(bool attached, const char *role_name) {
+    bool was_attached = msg_is_attached();
+
+    if (attached && !was_attached) {
+        if (attach_time_ms == 0) {
+            attach_time_ms = k_uptime_get();
+            LOG_INF("[NET] Attached as %s after %lld ms", role_name, attach_time_ms);
+        } else {
+            LOG_INF("[NET] Re-attached as %s", role_name);
+        }
+#if defined(CONFIG_APP_SED_REPORTING)
+        // The parent poll timer restarts on attach, align the send grid to it
+        window_anchor_ms = k_uptime_get();
+        window_period_ms = otLinkGetPollPeriod(openthread_get_default_instance());
+        LOG_INF("[SED] Poll period %u ms, batching up to %d frames", window_period_ms, CONFIG_APP_SED_BATCH_MAX);
+#endif
+        k_event_post(&net_events, NET_EVENT_ATTACHED);
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+        // Flush whatever was queued while detached
+        k_work_submit_to_queue(&app_work_q, &msg_tx_work);
+#endif
+    } else if (!attached && was_attached) {
+        LOG_WRN("[NET] Detached (%s), holding frames", role_name);
+        k_event_clear(&net_events, NET_EVENT_ATTACHED);
+    }
+}
+
+/**
+ * @brief The condensation alert slot a context points to, NULL for any other context.
+ */
+static cond_alert_slot_t *_cond_alert_slot(void *p_context) {
+    uintptr_t addr = (uintptr_t)p_context;
+
+    if (addr < (uintptr_t)&cond_alert_slots[0] || addr >= (uintptr_t)&cond_alert_slots[COND_ALERT_SLOTS]) {
+        return NULL;
+    }
+    return (cond_alert_slot_t *)p_context;
+}
+
+/**
+ * @brief Claims a free condensation alert slot.
+ * @return The slot (its origin set), NULL if COND_ALERT_SLOTS alerts are in flight.
+ */
+static cond_alert_slot_t *_cond_alert_claim(uint32_t origin_ms) {
+    for (int i = 0; i < COND_ALERT_SLOTS; i++) {
+        if (atomic_cas(&cond_alert_slots[i].busy, 0, 1)) {
+            cond_alert_slots[i].origin_ms = origin_ms;
+            return &cond_alert_slots[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Frees the slot of a context once its response (or its timeout) arrived.
+ */
+static void _cond_alert_release(void *p_context) {
+    cond_alert_slot_t *slot = _cond_alert_slot(p_context);
+
+    if (slot != NULL) {
+        atomic_clear(&slot->busy);
+    }
+}
+
+/**
+ * @brief Records a delivered payload (time to first delivered sample, alert latency).
+ * @param p_context MSG_CTX_SAMPLE for telemetry samples, a cond_alert_slot_t
+ *                  for condensation alerts, NULL otherwise.
+ */
+static void _on_delivered(void *p_context) {
+    cond_alert_slot_t *slot = _cond_alert_slot(p_context);
+
+    if (p_context == MSG_CTX_SAMPLE && first_sample_ack_ms == 0) {
+        first_sample_ack_ms = k_uptime_get();
+        LOG_INF("[NET] Time to first delivered sample: %lld ms (attach: %lld ms)", first_sample_ack_ms, attach_time_ms);
+    } else if (slot != NULL) {
+        uint32_t latency = (uint32_t)k_uptime_get() - slot->origin_ms;
+        cond_alert_count++;
+        cond_alert_total_ms += latency;
+        cond_alert_max_ms = MAX(cond_alert_max_ms, latency);
+        LOG_INF("[COND] Alert delivered %u ms after its sample (mean %u ms, max %u ms, n=%u)",
+                latency, cond_alert_total_ms / cond_alert_count, cond_alert_max_ms, cond_alert_count);
+    }
+}
+
+#if defined(CONFIG_NET_L2_OPENTHREAD)
+/**
+ * @brief Feeds an OpenThread role into the gate.
+ * Child, Router and Leader all mean the node is part of a partition.
+ */
+static void _update_attach_role(otDeviceRole role) {
+    bool attached = (role == OT_DEVICE_ROLE_CHILD || role == OT_DEVICE_ROLE_ROUTER || role == OT_DEVICE_ROLE_LEADER);
+    _update_attach_gate(attached, otThreadDeviceRoleToString(role));
+}
+
+/**
+ * @brief OpenThread state-changed callback (runs in the OpenThread context).
+ */
+static void _ot_state_changed_cb(otChangedFlags flags, void *context) {
+    if (flags & OT_CHANGED_THREAD_ROLE) {
+        _update_attach_role(otThreadGetDeviceRole((otInstance *)context));
+    }
+}
+
+/**
+ * @brief Fallback when no state-changed callback slot is free: poll the role.
+ */
+static void _attach_poll_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(attach_poll_work, _attach_poll_handler);
+
+static void _attach_poll_handler(struct k_work *work) {
+    _update_attach_role(otThreadGetDeviceRole(openthread_get_default_instance()));
+    k_work_reschedule(&attach_poll_work, K_MSEC(ATTACH_POLL_MS));
+}
+
+#if defined(CONFIG_APP_TIME_SYNC)
+/**
+ * @brief CoAP handler of "/time": one beacon from the server (Non-confirmable, no response).
+ */
+static void _time_beacon_handler(void *context, otMessage *message, const otMessageInfo *message_info) {
+    char payload[TIME_BEACON_MAX_LEN];
+    int64_t now = k_uptime_get();
+    int64_t fleet_ms;
+    uint32_t seq;
+
+    uint16_t length = otMessageRead(message, otMessageGetOffset(message), payload, sizeof(payload));
+    if (!time_sync_parse_beacon(payload, length, &fleet_ms, &seq)) {
+        LOG_WRN("[TIME] Malformed beacon (%u bytes)", length);
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&fleet_clock_lock);
+    bool was_synced = fleet_clock.synced;
+    uint32_t resets = fleet_clock.resets;
+    int64_t change = time_sync_beacon(&fleet_clock, fleet_ms, seq, now);
+    int64_t offset = fleet_clock.offset_ms;
+    bool restarted = (fleet_clock.resets != resets);
+    k_spin_unlock(&fleet_clock_lock, key);
+
+    if (!was_synced) {
+        LOG_INF("[TIME] Synced to the fleet clock (beacon %u), offset %lld ms", seq, offset);
+    } else if (restarted) {
+        LOG_WRN("[TIME] Server restarted (beacon %u), offset %lld ms", seq, offset);
+    } else {
+        LOG_DBG("[TIME] Beacon %u, offset %lld ms (%+lld ms)", seq, offset, change);
+    }
+}
+
+static otCoapResource m_time_resource = {
+    .mUriPath = TIME_URI_PATH,
+    .mHandler = _time_beacon_handler,
+    .mContext = NULL,
+    .mNext = NULL
+};
+#endif
 
 /**
  * @brief CoAP Delivery Callback
  * * Triggered when an ACK is received from the server (Success) 
  * or when the transaction times out (Failure).
+ * * @param p_context See _on_delivered().
  */
 static void _delivery_report_cb(void *p_context, otMessage *p_message,
                                 const otMessageInfo *p_message_info, otError result) 
 {
-    if (result == OT_ERROR_NONE) {
-        LOG_INF("✅ Delivery Confirmed by Server!");
+    if (result == OT_ERROR_NONE && p_message != NULL && otCoapMessageGetCode(p_message) >= OT_COAP_CODE(4, 0)) {
+        // 4.29 (over our admission rate) or 5.03 (server bus full): answered, not stored
+        otCoapCode code = otCoapMessageGetCode(p_message);
+        LOG_WRN("❌ Rejected by Server: %u.%02u", code >> 5, code & 0x1f);
+    } else if (result == OT_ERROR_NONE) {
+        LOG_DBG("✅ Delivery Confirmed by Server!");
+        _on_delivered(p_context);
     } else {
         LOG_ERR("❌ Delivery Failed! Error: %d", result);
     }
+    _cond_alert_release(p_context);
 }
 
 /**
  * @brief Internal helper to build and transmit a CoAP packet.
  * * 1. Allocates a new OpenThread Message buffer.
- * 2. Sets CoAP Type (Confirmable) and Code (PUT).
- * 3. Appends the URI Path and Content-Format (JSON).
- * 4. Appends the payload string.
+ * 2. Sets CoAP Type (Confirmable, unless ack_context is MSG_CTX_NON) and Code (PUT).
+ * 3. Appends the URI Path and Content-Format.
+ * 4. Appends the payload.
  * 5. Sends the request via the Thread Interface.
- * * @param payload_string Null-terminated JSON string to send.
+ * * @param uri_path       Resource on the server.
+ * @param format         CoAP Content-Format of the payload.
+ * @param payload        Payload bytes.
+ * @param length         Payload length.
+ * @param ack_context    Passed to _delivery_report_cb (see _on_delivered()),
+ *                       MSG_CTX_NON sends a Non-confirmable message without callback.
+ * @return OT_ERROR_NONE once OpenThread owns the message.
  */
-static void _send_coap_payload(const char* payload_string) {
+static otError _send_coap_request(const char *uri_path, otCoapOptionContentFormat format,
+                                  const void *payload, uint16_t length, void *ack_context) {
     otError error = OT_ERROR_NONE;
     otMessage *myMessage = NULL;
     otMessageInfo myMessageInfo;
     otInstance *myInstance = openthread_get_default_instance();
 
+    trace_span_begin(SPAN_COAP_SEND);
     do {
         // 1. New Message Allocation
         myMessage = otCoapNewMessage(myInstance, NULL);
         if (myMessage == NULL) {
             LOG_ERR("Failed to allocate CoAP message");
-            return;
+            trace_span_end(SPAN_COAP_SEND, OT_ERROR_NO_BUFS);
+            return OT_ERROR_NO_BUFS;
         }
 
         // 2. Header Setup (CON = Confirmable, PUT = Update Resource)
-        otCoapMessageInit(myMessage, OT_COAP_TYPE_CONFIRMABLE, OT_COAP_CODE_PUT);
-        otCoapMessageAppendUriPathOptions(myMessage, URI_PATH);
-        otCoapMessageAppendContentFormatOption(myMessage, OT_COAP_OPTION_CONTENT_FORMAT_JSON);
+        bool confirmable = (ack_context != MSG_CTX_NON);
+        otCoapMessageInit(myMessage, confirmable ? OT_COAP_TYPE_CONFIRMABLE : OT_COAP_TYPE_NON_CONFIRMABLE, OT_COAP_CODE_PUT);
+        otCoapMessageAppendUriPathOptions(myMessage, uri_path);
+        otCoapMessageAppendContentFormatOption(myMessage, format);
         otCoapMessageSetPayloadMarker(myMessage);
 
         // 3. Payload Append
-        error = otMessageAppend(myMessage, payload_string, (uint16_t)strlen(payload_string));
+        error = otMessageAppend(myMessage, payload, length);
         if (error != OT_ERROR_NONE) break;
 
         // 4. Destination Setup
@@ -84,7 +384,8 @@ static void _send_coap_payload(const char* payload_string) {
         myMessageInfo.mPeerPort = COAP_PORT;
 
         // 5. Transmit (with Callback for ACK)
-        error = otCoapSendRequest(myInstance, myMessage, &myMessageInfo, _delivery_report_cb, NULL);
+        error = otCoapSendRequest(myInstance, myMessage, &myMessageInfo,
+                                  confirmable ? _delivery_report_cb : NULL, ack_context);
 
     } while (false);
 
@@ -94,64 +395,454 @@ static void _send_coap_payload(const char* payload_string) {
         // If sending failed, we must free the message manually.
         // If sending succeeded, OpenThread stack owns the message now.
         if (myMessage) otMessageFree(myMessage);
-    } else {
-        LOG_INF("Sent: %s", payload_string);
     }
+    trace_span_end(SPAN_COAP_SEND, error);
+    return error;
+}
+
+/**
+ * @brief Sends a JSON payload to the storedata resource.
+ * @param payload_string Null-terminated JSON string to send.
+ * @param ack_context    See _send_coap_request().
+ * @return true once the stack owns the message (the callback will run for a confirmable one).
+ */
+static bool _send_coap_payload(const char* payload_string, void *ack_context) {
+    if (_send_coap_request(URI_PATH, OT_COAP_OPTION_CONTENT_FORMAT_JSON, payload_string,
+                           (uint16_t)strlen(payload_string), ack_context) != OT_ERROR_NONE) {
+        return false;
+    }
+    LOG_DBG("Sent: %s", payload_string);
+    return true;
+}
+
+#if defined(CONFIG_APP_SAMPLE_BATCH)
+/**
+ * @brief Sends a batch frame to the batch resource (Confirmable).
+ */
+static void _send_coap_batch(const uint8_t *frame, uint16_t length, void *ack_context) {
+    if (_send_coap_request(TS_BATCH_URI_PATH, OT_COAP_OPTION_CONTENT_FORMAT_OCTET_STREAM, frame,
+                           length, ack_context) == OT_ERROR_NONE) {
+        LOG_DBG("Sent batch: %u bytes", length);
+    }
+}
+#endif
+
+#else
+/**
+ * @brief Loopback transport (no OpenThread): logs the payload, counts it as delivered.
+ */
+static bool _send_coap_payload(const char* payload_string, void *ack_context) {
+    trace_span_begin(SPAN_COAP_SEND);
+    LOG_INF("[LOOPBACK] %s", payload_string);
+    _on_delivered(ack_context);
+    _cond_alert_release(ack_context);
+    trace_span_end(SPAN_COAP_SEND, 0);
+    return true;
+}
+
+#if defined(CONFIG_APP_SAMPLE_BATCH)
+static void _send_coap_batch(const uint8_t *frame, uint16_t length, void *ack_context) {
+    trace_span_begin(SPAN_COAP_SEND);
+    LOG_INF("[LOOPBACK] /%s: %u bytes", TS_BATCH_URI_PATH, length);
+    LOG_HEXDUMP_DBG(frame, length, "batch");
+    _on_delivered(ack_context);
+    trace_span_end(SPAN_COAP_SEND, 0);
+}
+#endif
+#endif
+
+#if defined(CONFIG_APP_SAMPLE_BATCH)
+/**
+ * @brief Opens a batch: room name, NUL and flags, then an empty series.
+ * @param uptime The series is stamped with uptime, not fleet time.
+ */
+static void _batch_open(const outbound_frame_t *frame, bool uptime) {
+    size_t room_len = MIN(strlen(frame->room_name), BATCH_ROOM_MAX);
+
+    memcpy(batch_frame, frame->room_name, room_len);
+    batch_frame[room_len] = '\0';
+    batch_frame[room_len + 1] = (frame->is_simulated ? TS_BATCH_FLAG_SIMULATED : 0) | (uptime ? TS_BATCH_FLAG_UPTIME : 0);
+    batch_header_len = room_len + 2;
+    batch_uptime = uptime;
+    ts_encoder_init(&batch_enc, batch_frame + batch_header_len, CONFIG_APP_SAMPLE_BATCH_MAX_BYTES, BATCH_UNIT_MS);
+}
+
+/**
+ * @brief Sends the open batch, if any.
+ */
+static void _batch_flush(void) {
+    if (batch_header_len == 0) {
+        return;
+    }
+    uint8_t count = batch_enc.count;
+    size_t len = batch_header_len + ts_encoder_finish(&batch_enc);
+    batch_header_len = 0;
+
+    LOG_DBG("[BATCH] %u samples in %u bytes", count, (unsigned int)len);
+    _send_coap_batch(batch_frame, (uint16_t)len, MSG_CTX_SAMPLE);
+}
+#endif
+
+/**
+ * @brief Full uptime of a frame's sample.
+ * @param origin_ms k_uptime_get() of the sample truncated to 32 bits (wraps
+ *                  every 49 days, a frame is always younger than that).
+ */
+static int64_t _sample_uptime_ms(uint32_t origin_ms) {
+    int64_t now = k_uptime_get();
+
+    return now - (uint32_t)((uint32_t)now - origin_ms);
+}
+
+/**
+ * @brief Fleet time of a frame's sample, 0 if unknown.
+ */
+static int64_t _sample_fleet_ms(uint32_t origin_ms) {
+    int64_t fleet_ms;
+
+    if (origin_ms == 0 || !msg_fleet_time(_sample_uptime_ms(origin_ms), &fleet_ms)) {
+        return 0;
+    }
+    return fleet_ms;
 }
 
+#if defined(CONFIG_APP_SAMPLE_BATCH)
+/**
+ * @brief Appends a telemetry sample to the open batch, sends the batch when it is complete.
+ * * Before the first time beacon the samples are stamped with uptime, so
+ * the series keeps its spacing. One batch never mixes the two clocks.
+ */
+static void _batch_add(const outbound_frame_t *frame) {
+    ts_point_t point;
+    int64_t timestamp_ms = _sample_fleet_ms(frame->origin_ms);
+    bool uptime = (timestamp_ms == 0);
+
+    if (uptime) {
+        timestamp_ms = _sample_uptime_ms(frame->origin_ms);
+    }
+    trace_span_begin(SPAN_BATCH_ENCODE);
+    ts_point_quantize(&point, timestamp_ms, frame->temperature, frame->humidity, batch_mold_index);
+    if (batch_header_len != 0 && batch_uptime != uptime) {
+        // First beacon mid-batch: close the uptime series
+        _batch_flush();
+    }
+    if (batch_header_len == 0) {
+        _batch_open(frame, uptime);
+    }
+    bool appended = ts_encoder_append(&batch_enc, &point);
+    trace_span_end(SPAN_BATCH_ENCODE, appended);
+
+    if (!appended) {
+        // Frame full: send it, the sample opens the next one
+        _batch_flush();
+        _batch_open(frame, uptime);
+        ts_encoder_append(&batch_enc, &point);
+    }
+    if (batch_enc.count >= CONFIG_APP_SAMPLE_BATCH_SAMPLES) {
+        _batch_flush();
+    }
+}
+#endif
+
+/**
+ * @brief Encodes and sends one frame taken from outbound_chan.
+ */
+static void _dispatch_frame(const outbound_frame_t *frame) {
+    switch (frame->kind) {
+    case FRAME_SIMPLE_DATA:
+#if defined(CONFIG_APP_SAMPLE_BATCH)
+        _batch_add(frame);
+#else
+        msg_send_simple_data(frame->message_type, frame->room_name, frame->temperature, frame->humidity, frame->is_simulated, frame->origin_ms);
+#endif
+        break;
+    case FRAME_MOLD_STATUS:
+#if defined(CONFIG_APP_SAMPLE_BATCH)
+        batch_mold_index = frame->mold_index;
+#endif
+        msg_send_mold_status(frame->message_type, frame->room_name, frame->temperature, frame->humidity, frame->mold_index, frame->risk_level, frame->growing_condition, frame->is_simulated, frame->origin_ms);
+        break;
+    case FRAME_HEALTH_STATUS:
+        msg_send_system_health_status(frame->message_type, frame->room_name, frame->sensor_status[0], frame->sensor_status[1]);
+        break;
+    case FRAME_SYSTEM_ALERT:
+        msg_send_system_alert(frame->message_type, frame->room_name, frame->sensor_status[0], frame->sensor_status[1]);
+        break;
+    case FRAME_HEALTH_HEARTBEAT:
+        msg_send_health_heartbeat(frame->room_name, frame->sensor_status[0], frame->sensor_status[1]);
+        break;
+    case FRAME_CONDENSATION_ALERT:
+        msg_send_condensation_alert(frame->message_type, frame->room_name, frame->risk_level, frame->temperature,
+                                    frame->humidity, frame->dew_point, frame->rh_slope, frame->origin_ms);
+        break;
+    default:
+        LOG_WRN("Unknown frame kind: %d", frame->kind);
+        break;
+    }
+}
+
+#if defined(CONFIG_APP_SED_REPORTING)
+/**
+ * @brief Time left until the next radio window, or K_FOREVER if nothing is batched.
+ */
+static k_timeout_t _tx_window_timeout(void) {
+    if (tx_batch_len == 0) {
+        return K_FOREVER;
+    }
+    if (window_period_ms == 0) {
+        return K_NO_WAIT;
+    }
+    int64_t now = k_uptime_get();
+    int64_t elapsed = now - window_anchor_ms;
+    int64_t next = window_anchor_ms + ((elapsed / window_period_ms) + 1) * window_period_ms;
+    return K_MSEC(next - now);
+}
+
+/**
+ * @brief Sends every batched frame inside the current radio window.
+ */
+static void _tx_flush(void) {
+    if (tx_batch_len == 0) {
+        return;
+    }
+    for (size_t i = 0; i < tx_batch_len; i++) {
+        _dispatch_frame(&tx_batch[i]);
+    }
+    sed_windows++;
+    sed_frames += tx_batch_len;
+    tx_batch_len = 0;
+
+    if ((sed_windows % 32) == 0) {
+        const otMacCounters *mac = otLinkGetCounters(openthread_get_default_instance());
+        LOG_INF("[SED] %u frames in %u windows, MAC TX %u (data polls %u), RX %u",
+                sed_frames, sed_windows, mac->mTxTotal, mac->mTxDataPoll, mac->mRxTotal);
+    }
+}
+#endif
+
+/**
+ * @brief Hands one frame to the radio path.
+ * * Without CONFIG_APP_SED_REPORTING the frame is sent at once. Otherwise it
+ * is batched until the next radio window, unless it is a system or
+ * condensation alert or the batch is full.
+ */
+static void _tx_accept(const outbound_frame_t *frame) {
+#if defined(CONFIG_APP_SED_REPORTING)
+    tx_batch[tx_batch_len++] = *frame;
+    if (frame->kind == FRAME_SYSTEM_ALERT || frame->kind == FRAME_CONDENSATION_ALERT ||
+        tx_batch_len == CONFIG_APP_SED_BATCH_MAX) {
+        _tx_flush();
+    }
+#else
+    _dispatch_frame(frame);
+#endif
+}
+
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+#if defined(CONFIG_APP_SED_REPORTING)
+static void msg_tx_window_handler(struct k_work *work) {
+    if (msg_is_attached()) {
+        _tx_flush();
+    }
+}
+static K_WORK_DELAYABLE_DEFINE(msg_tx_window_work, msg_tx_window_handler);
+#endif
+
+/**
+ * @brief TX work item: drains every queued frame, then returns to app_work_q.
+ */
+static void msg_tx_work_handler(struct k_work *work) {
+    const struct zbus_channel *chan;
+    outbound_frame_t frame;
+
+    // Frames stay queued while detached, the attach gate re-submits us
+    while (msg_is_attached() && zbus_sub_wait_msg(&msg_tx_sub, &chan, &frame, K_NO_WAIT) == 0) {
+        _tx_accept(&frame);
+    }
+#if defined(CONFIG_APP_SED_REPORTING)
+    // Keeps a pending window, a new frame never pushes the flush further out
+    if (tx_batch_len > 0) {
+        k_work_schedule_for_queue(&app_work_q, &msg_tx_window_work, _tx_window_timeout());
+    }
+#endif
+}
+static struct k_work msg_tx_work = Z_WORK_INITIALIZER(msg_tx_work_handler);
+
+/**
+ * @brief Listener: queues the TX work item whenever a frame is published.
+ * Submitting an already queued item is a no-op, so bursts cost one run.
+ */
+static void msg_tx_kick_cb(const struct zbus_channel *chan) {
+    k_work_submit_to_queue(&app_work_q, &msg_tx_work);
+}
+ZBUS_LISTENER_DEFINE(msg_tx_kick, msg_tx_kick_cb);
+ZBUS_CHAN_ADD_OBS(outbound_chan, msg_tx_kick, 1);
+
+#else
+/**
+ * @brief The TX worker thread loop.
+ * Sleeps until a frame is published on outbound_chan (or, with batching,
+ * until the next radio window), then sends it.
+ */
+static void msg_tx_thread_entry(void *p1, void *p2, void *p3) {
+    const struct zbus_channel *chan;
+    outbound_frame_t frame;
+
+    while (1) {
+#if defined(CONFIG_APP_SED_REPORTING)
+        int rc = zbus_sub_wait_msg(&msg_tx_sub, &chan, &frame, _tx_window_timeout());
+        // Hold the frame until the node is attached
+        k_event_wait(&net_events, NET_EVENT_ATTACHED, false, K_FOREVER);
+        if (rc == 0) {
+            _tx_accept(&frame);
+        } else {
+            // Timeout: the radio window is open
+            _tx_flush();
+        }
+#else
+        if (zbus_sub_wait_msg(&msg_tx_sub, &chan, &frame, K_FOREVER) == 0) {
+            // Hold the frame until the node is attached
+            k_event_wait(&net_events, NET_EVENT_ATTACHED, false, K_FOREVER);
+            _tx_accept(&frame);
+        }
+#endif
+    }
+}
+#endif
+
 // --- Public API Implementation ---
+bool msg_is_attached(void) {
+    return (k_event_test(&net_events, NET_EVENT_ATTACHED) != 0);
+}
+
+bool msg_fleet_time(int64_t uptime_ms, int64_t *fleet_ms) {
+#if defined(CONFIG_APP_TIME_SYNC)
+    k_spinlock_key_t key = k_spin_lock(&fleet_clock_lock);
+    bool synced = time_sync_to_fleet(&fleet_clock, uptime_ms, fleet_ms);
+    k_spin_unlock(&fleet_clock_lock, key);
+    return synced;
+#else
+    return false;
+#endif
+}
+
 void msg_init(void) {
+#if defined(CONFIG_NET_L2_OPENTHREAD)
     otInstance *p_instance = openthread_get_default_instance();
     otCoapStart(p_instance, OT_DEFAULT_COAP_PORT); 
+
+#if defined(CONFIG_APP_TIME_SYNC)
+    // Fleet clock: the server's time beacons (ff03::1 is joined by every Thread node)
+    m_time_resource.mContext = p_instance;
+    otCoapAddResource(p_instance, &m_time_resource);
+#endif
+
+#if defined(CONFIG_APP_SED_CSL_PERIOD_MS)
+    // SSED: the parent reaches us in CSL windows instead of waiting for a poll
+    otError csl_error = otLinkSetCslPeriod(p_instance, CONFIG_APP_SED_CSL_PERIOD_MS * 1000U);
+    if (csl_error != OT_ERROR_NONE) {
+        LOG_WRN("[SED] Failed to set CSL period: %d", csl_error);
+    }
+#endif
+
+    // Startup Gate: follow the device role instead of sleeping a fixed time
+    otError error = otSetStateChangedCallback(p_instance, _ot_state_changed_cb, p_instance);
+    if (error != OT_ERROR_NONE) {
+        LOG_WRN("[NET] No state-changed slot (%d), polling the role every %d ms", error, ATTACH_POLL_MS);
+        k_work_reschedule(&attach_poll_work, K_NO_WAIT);
+    } else {
+        // The role may have changed before the callback was registered
+        _update_attach_role(otThreadGetDeviceRole(p_instance));
+    }
+#else
+    LOG_WRN("[NET] No OpenThread, frames are logged (loopback)");
+    _update_attach_gate(true, "loopback");
+#endif
+
+#if !defined(CONFIG_APP_WORKQUEUE_MODEL)
+    k_thread_create(&msg_tx_thread_data,
+        msg_tx_stack,
+        K_THREAD_STACK_SIZEOF(msg_tx_stack),
+        msg_tx_thread_entry,
+        NULL, NULL, NULL,
+        MSG_TX_PRIORITY,
+        0,
+        K_NO_WAIT);
+    k_thread_name_set(&msg_tx_thread_data, "msg_tx");
+#endif
+}
+
+
+void msg_send_mold_status(const char *message_type, const char *room_name, float temp_c, float rh_percent, float mold_index, int mold_risk_status, bool growth_status, bool is_simulation_node, uint32_t origin_ms) {
+    trace_span_begin(SPAN_JSON_ENCODE);
+    int len = payload_encode_mold_status(json_buffer, sizeof(json_buffer), message_type, room_name,
+                                         temp_c, rh_percent, mold_index, mold_risk_status, growth_status, is_simulation_node,
+                                         _sample_fleet_ms(origin_ms));
+    trace_span_end(SPAN_JSON_ENCODE, len);
+             
+    _send_coap_payload(json_buffer, NULL);
 }
 
+void msg_send_system_health_status(const char *message_type, const char *room_name, int sensor_1, int sensor_2) {
+    link_metrics_t link;
+    bool has_link = link_metrics_collect(&link);
 
-void msg_send_mold_status(char* message_type, char* room_name, float temp_c, float rh_percent, float mold_index, int mold_risk_status, bool growth_status, bool is_simulation_node) {
-    // Note: We cast floats to (double) because standard snprintf implementation 
-    // in some embedded C libraries (like Newlib) expects doubles for %f.
-    snprintf(json_buffer, sizeof(json_buffer), 
-             "{\"message_type\":\"%s\",\"room_name\":\"%s\",\"temparature\":%.2f,\"humidity\":%.2f,\"mold_index\":%.2f,\"mold_risk_status\":%d,\"growth_status\":%d, \"is_simulated\":%d}", 
-             message_type, 
-             room_name, 
-             (double)temp_c, 
-             (double)rh_percent, 
-             (double)mold_index, 
-             mold_risk_status, 
-             (int)growth_status,
-             (int)is_simulation_node);
+    trace_span_begin(SPAN_JSON_ENCODE);
+    int len = payload_encode_health_status(json_buffer, sizeof(json_buffer), message_type, room_name, sensor_1, sensor_2,
+                                           has_link ? &link : NULL);
+    trace_span_end(SPAN_JSON_ENCODE, len);
              
-    _send_coap_payload(json_buffer);
+    _send_coap_payload(json_buffer, NULL);
 }
 
-void msg_send_system_health_status(char *message_type, char* room_name, int sensor_1, int sensor_2) {
-    snprintf(json_buffer, sizeof(json_buffer), 
-             "{\"message_type\":\"%s\",\"room_name\":\"%s\",\"sensor_1_status\":%d,\"sensor_2_status\":%d}", 
-             message_type, 
-             room_name, 
-             sensor_1, 
-             sensor_2);
+void msg_send_health_heartbeat(const char *room_name, int sensor_1, int sensor_2) {
+    link_metrics_t link;
+    bool has_link = link_metrics_collect(&link);
+
+    trace_span_begin(SPAN_JSON_ENCODE);
+    int len = payload_encode_health_heartbeat(json_buffer, sizeof(json_buffer), room_name, sensor_1, sensor_2,
+                                              has_link ? &link : NULL);
+    trace_span_end(SPAN_JSON_ENCODE, len);
              
-    _send_coap_payload(json_buffer);
+    _send_coap_payload(json_buffer, MSG_CTX_NON);
 }
 
-void msg_send_simple_data(char *message_type, char* room_name, float temp_c, float rh_percent, bool is_simulation_node){
-    snprintf(json_buffer, sizeof(json_buffer), 
-             "{\"message_type\":\"%s\",\"room_name\":\"%s\",\"temparature\":%.2f,\"humidity\":%.2f, \"is_simulated\":%d}", 
-             message_type, 
-             room_name, 
-             temp_c, 
-             rh_percent,
-            (int)is_simulation_node);
+void msg_send_simple_data(const char *message_type, const char *room_name, float temp_c, float rh_percent, bool is_simulation_node, uint32_t origin_ms){
+    trace_span_begin(SPAN_JSON_ENCODE);
+    int len = payload_encode_simple_data(json_buffer, sizeof(json_buffer), message_type, room_name,
+                                         temp_c, rh_percent, is_simulation_node, _sample_fleet_ms(origin_ms));
+    trace_span_end(SPAN_JSON_ENCODE, len);
              
-    _send_coap_payload(json_buffer);
-}
-
-void msg_send_system_alert(char *event, char* room_name, int sensor_1, int sensor_2){
-    snprintf(json_buffer, sizeof(json_buffer), 
-             "{\"event\":\"%s\",\"room_name\":\"%s\",\"s1\":%d, \"s2\":%d}", 
-             event, 
-             room_name, 
-             sensor_1,
-             sensor_2);
-    _send_coap_payload(json_buffer);
-}
\ No newline at end of file
+    _send_coap_payload(json_buffer, MSG_CTX_SAMPLE);
+}
+
+void msg_send_system_alert(const char *event, const char *room_name, int sensor_1, int sensor_2){
+    trace_span_begin(SPAN_JSON_ENCODE);
+    int len = payload_encode_system_alert(json_buffer, sizeof(json_buffer), event, room_name, sensor_1, sensor_2);
+    trace_span_end(SPAN_JSON_ENCODE, len);
+    _send_coap_payload(json_buffer, NULL);
+}
+
+void msg_send_condensation_alert(const char *message_type, const char *room_name, int level, float temp_c,
+                                 float rh_percent, float dew_point, float rh_slope, uint32_t origin_ms) {
+    trace_span_begin(SPAN_JSON_ENCODE);
+    int len = payload_encode_condensation_alert(json_buffer, sizeof(json_buffer), message_type, room_name,
+                                                level, temp_c, rh_percent, dew_point, rh_slope,
+                                                _sample_fleet_ms(origin_ms));
+    trace_span_end(SPAN_JSON_ENCODE, len);
+
+    cond_alert_slot_t *slot = _cond_alert_claim(origin_ms);
+    if (slot == NULL) {
+        LOG_WRN("[COND] %d alerts in flight, latency of this one not measured", COND_ALERT_SLOTS);
+    }
+    if (!_send_coap_payload(json_buffer, slot)) {
+        // No callback will come for it
+        _cond_alert_release(slot);
+    }
+}
+
+void msg_get_alert_latency(alert_latency_t *stats) {
+    stats->count = cond_alert_count;
+    stats->mean_ms = (cond_alert_count > 0) ? cond_alert_total_ms / cond_alert_count : 0;
+    stats->max_ms = cond_alert_max_ms;
+}
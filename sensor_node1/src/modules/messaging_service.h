@@ -3,9 +3,14 @@
  * @brief CoAP Messaging Interface for the Sensor Node
  * * This module handles the formatting of JSON payloads and the transmission
  * of data over the OpenThread Mesh network using the CoAP protocol.
- * * @note This module is NOT thread-safe by itself. The caller must ensure
- * mutex locking (e.g., using coap_lock) before calling send functions
- * to prevent buffer corruption.
+ * * Other services do not call the send functions directly: they publish an
+ * outbound_frame_t on outbound_chan (see app_channels.h) and the module's TX
+ * thread encodes and sends it.
+ * * * Fleet Clock (CONFIG_APP_TIME_SYNC): the module serves the "time" CoAP
+ * resource the server multicasts its beacons to, and converts sample times
+ * into fleet time when a frame is encoded (see time_sync.h).
+ * * @note The msg_send_* functions are NOT thread-safe. They are only called
+ * from the TX thread.
  * @authors: muzamil.py, Google Gemini 3 Pro
  * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
  */
@@ -20,9 +25,26 @@
  * @brief Initialize the OpenThread CoAP Service.
  * * Starts the CoAP engine on the default OpenThread instance. 
  * Must be called once at system startup before sending any messages.
+ * Also spawns the TX thread that drains outbound_chan and registers the
+ * OpenThread state-changed callback that gates it on network attachment.
  */
 void msg_init(void);
 
+/**
+ * @brief Checks the attach gate.
+ * @return true if the node is a Child, Router or Leader (frames are sent),
+ *         false while detached (frames stay queued on outbound_chan).
+ */
+bool msg_is_attached(void);
+
+/**
+ * @brief Converts a local uptime into fleet time (server clock).
+ * @param uptime_ms k_uptime_get() value, e.g. the acquisition time of a sample.
+ * @param[out] fleet_ms Fleet time (ms).
+ * @return false until the first time beacon (or without CONFIG_APP_TIME_SYNC).
+ */
+bool msg_fleet_time(int64_t uptime_ms, int64_t *fleet_ms);
+
 /**
  * @brief Sends VTT Mold Model results to the Server Node.
  * * Formats the mold risk data into a JSON string and sends a CoAP PUT request.
@@ -33,18 +55,30 @@ void msg_init(void);
  * @param mold_index      Calculated Mold Index (0.0 to 6.0)
  * @param mold_risk_status Risk Level Enum (0=Clean, 1=Warning, 2=Critical)
  * @param growth_status   Boolean indicating if mold is actively growing
+ * @param origin_ms       k_uptime_get() of the input sample (truncated to 32 bits), sent as fleet time
  */
-void msg_send_mold_status(char* message_type, char* room_name, float temp_c, float rh_percent, float mold_index, int mold_risk_status, bool growth_status, bool is_simulation_node);
+void msg_send_mold_status(const char *message_type, const char *room_name, float temp_c, float rh_percent, float mold_index, int mold_risk_status, bool growth_status, bool is_simulation_node, uint32_t origin_ms);
 
 /**
  * @brief Sends System Health diagnostic data.
- * * Used to report hardware failures or sensor drift issues.
+ * * Used to report hardware failures or sensor drift issues. Carries the
+ * mesh link metrics since the previous health report (link_metrics.h).
  * @param message_type    "DATA" (Heartbeat) or "ALERT" (Failure)
  * @param room_name       Location identifier
  * @param sensor_1        Status code for Sensor A (0=OK, 1=Drift, 2=Fail)
  * @param sensor_2        Status code for Sensor B
  */
-void msg_send_system_health_status(char *message_type, char* room_name, int sensor_1, int sensor_2);
+void msg_send_system_health_status(const char *message_type, const char *room_name, int sensor_1, int sensor_2);
+
+/**
+ * @brief Sends the compact health heartbeat (unchanged status).
+ * * Non-confirmable: a lost heartbeat is superseded by the next one.
+ * Carries the mesh link metrics since the previous health report.
+ * @param room_name       Location identifier
+ * @param sensor_1        Status code for Sensor A
+ * @param sensor_2        Status code for Sensor B
+ */
+void msg_send_health_heartbeat(const char *room_name, int sensor_1, int sensor_2);
 
 /**
  * @brief Sends Sensor Failure or Fix Alert.
@@ -54,7 +88,38 @@ void msg_send_system_health_status(char *message_type, char* room_name, int sens
  * @param sensor_1        Status code for Sensor A (0=OK, 1=Drift, 2=Fail)
  * @param sensor_2        Status code for Sensor B
  */
-void msg_send_system_alert(char *event, char* room_name, int sensor_1, int sensor_2);
+void msg_send_system_alert(const char *event, const char *room_name, int sensor_1, int sensor_2);
+
+/**
+ * @brief Sends a condensation early warning (level change).
+ * * Confirmable. The time from the triggering sample to the server's ACK is
+ * logged with its running mean (see msg_get_alert_latency()).
+ * @param message_type    "ALERT" (level raised) or "DATA" (level back to none)
+ * @param room_name       Location identifier
+ * @param level           Condensation level (cond_risk_t)
+ * @param temp_c          Temperature (Celsius)
+ * @param rh_percent      Relative Humidity (%)
+ * @param dew_point       Dew point (Celsius)
+ * @param rh_slope        RH trend (%RH per minute)
+ * @param origin_ms       k_uptime_get() of the triggering sample (truncated to 32 bits)
+ */
+void msg_send_condensation_alert(const char *message_type, const char *room_name, int level, float temp_c,
+                                 float rh_percent, float dew_point, float rh_slope, uint32_t origin_ms);
+
+/**
+ * @brief Condensation alert latency (sample acquisition to delivery).
+ */
+typedef struct {
+    uint32_t count;         /**< Delivered alerts */
+    uint32_t mean_ms;       /**< Mean latency */
+    uint32_t max_ms;        /**< Worst latency */
+} alert_latency_t;
+
+/**
+ * @brief Returns the condensation alert latency measured so far.
+ * @param[out] stats Count, mean and max.
+ */
+void msg_get_alert_latency(alert_latency_t *stats);
 
 /**
  * @brief Sends raw telemetry data (Temperature & Humidity).
@@ -62,7 +127,8 @@ void msg_send_system_alert(char *event, char* room_name, int sensor_1, int senso
  * @param room_name       Location identifier
  * @param temp_c          Temperature (Celsius)
  * @param rh_percent      Relative Humidity (%)
+ * @param origin_ms       k_uptime_get() of the sample (truncated to 32 bits), sent as fleet time
  */
-void msg_send_simple_data(char *message_type, char* room_name, float temp_c, float rh_percent, bool is_simulation_nod);
+void msg_send_simple_data(const char *message_type, const char *room_name, float temp_c, float rh_percent, bool is_simulation_nod, uint32_t origin_ms);
 
 #endif
\ No newline at end of file
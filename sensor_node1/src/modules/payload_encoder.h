@@ -0,0 +1,57 @@
+/**
+ * @file payload_encoder.h
+ * @brief JSON Payload Encoders of the Sensor Node
+ * * Pure formatting functions behind the msg_send_* API: no radio, no
+ * global state, so they can be benchmarked on their own (see benchmarks/).
+ * Every function follows snprintf(): it returns the length the payload
+ * needs, and the payload is truncated if that is >= size.
+ * * Sample payloads carry "ts": the acquisition time on the fleet clock in
+ * seconds with millisecond resolution (see time_sync.h), 0 while the node
+ * has not received a time beacon yet.
+ * * Health payloads end with "link": the node's mesh link metrics
+ * (link_metrics.h), omitted when `link` is NULL:
+ *   "link":{"role":2,"rid":255,"parent":12,"rssi":-67,"lqi":3,"tx":120,"retry":9,"tx_err":1,"rx":140,"rx_err":0}
+ */
+#ifndef PAYLOAD_ENCODER_H
+#define PAYLOAD_ENCODER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "link_metrics.h"
+
+/** @brief Buffer size that fits every payload below. */
+#define PAYLOAD_MAX_LEN 256
+
+/** @brief VTT model result (see msg_send_mold_status()). */
+int payload_encode_mold_status(char *buf, size_t size, const char *message_type, const char *room_name,
+                               float temp_c, float rh_percent, float mold_index, int mold_risk_status,
+                               bool growth_status, bool is_simulation_node, int64_t fleet_ms);
+
+/** @brief Full health report (see msg_send_system_health_status()). */
+int payload_encode_health_status(char *buf, size_t size, const char *message_type, const char *room_name,
+                                 int sensor_1, int sensor_2, const link_metrics_t *link);
+
+/** @brief Compact health heartbeat (see msg_send_health_heartbeat()). */
+int payload_encode_health_heartbeat(char *buf, size_t size, const char *room_name, int sensor_1, int sensor_2,
+                                    const link_metrics_t *link);
+
+/** @brief Condensation early warning (see msg_send_condensation_alert()). */
+int payload_encode_condensation_alert(char *buf, size_t size, const char *message_type, const char *room_name,
+                                      int level, float temp_c, float rh_percent, float dew_point, float rh_slope,
+                                      int64_t fleet_ms);
+
+/** @brief Telemetry sample (see msg_send_simple_data()). */
+int payload_encode_simple_data(char *buf, size_t size, const char *message_type, const char *room_name,
+                               float temp_c, float rh_percent, bool is_simulation_node, int64_t fleet_ms);
+
+/** @brief Latest cached state, served on GET /latest (see latest_resource.h). */
+int payload_encode_latest(char *buf, size_t size, const char *room_name, float temp_c, float rh_percent,
+                          float mold_index, int mold_risk_status, bool growth_status, int sensor_1, int sensor_2,
+                          bool is_simulation_node, int64_t fleet_ms);
+
+/** @brief Sensor failure/fix alert (see msg_send_system_alert()). */
+int payload_encode_system_alert(char *buf, size_t size, const char *event, const char *room_name,
+                                int sensor_1, int sensor_2);
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file sensor_reliability.h
+ * @brief Sliding-Window Reliability of one Sensor
+ * * Every acquisition (telemetry read or health probe) ends in one outcome
+ * class. The last RELIABILITY_WINDOW outcomes are kept in a ring with a
+ * running count per class, so error rates and the score cost O(1) and the
+ * memory is constant.
+ */
+#ifndef SENSOR_RELIABILITY_H
+#define SENSOR_RELIABILITY_H
+
+#include <stdint.h>
+
+#define RELIABILITY_WINDOW 32   /**< Outcomes per sliding window */
+
+/**
+ * @brief Outcome of one acquisition attempt.
+ */
+typedef enum {
+    ACQ_OK = 0,         /**< Valid frame, values in range */
+    ACQ_NACK,           /**< I2C transfer failed (-EIO): wiring or power */
+    ACQ_BUSY,           /**< Measurement not ready (-EBUSY), retried */
+    ACQ_CRC,            /**< Frame CRC mismatch (-EBADMSG) */
+    ACQ_FETCH_FAIL,     /**< Any other fetch error */
+    ACQ_INVALID,        /**< Not ready, channel get failure or value out of range */
+    ACQ_CLASS_COUNT
+} acq_outcome_t;
+
+/**
+ * @brief Ring of the last outcomes and their per-class counts.
+ */
+typedef struct {
+    uint8_t history[RELIABILITY_WINDOW];
+    uint8_t head;                       /**< Next slot to write */
+    uint8_t len;                        /**< Valid entries (<= RELIABILITY_WINDOW) */
+    uint8_t count[ACQ_CLASS_COUNT];     /**< Entries per class in the window */
+} reliability_window_t;
+
+/**
+ * @brief Clears the window.
+ */
+void reliability_init(reliability_window_t *w);
+
+/**
+ * @brief Adds one outcome, evicting the oldest one once the window is full.
+ */
+void reliability_record(reliability_window_t *w, acq_outcome_t outcome);
+
+/**
+ * @brief Share of one outcome class in the window (0.0 if empty).
+ */
+float reliability_rate(const reliability_window_t *w, acq_outcome_t outcome);
+
+/**
+ * @brief Reliability score of the window (1.0 if empty).
+ * * Successful attempts count fully, busy attempts half (the retry usually
+ * succeeds, the sensor only answered early), every other class zero.
+ */
+float reliability_score(const reliability_window_t *w);
+
+#endif
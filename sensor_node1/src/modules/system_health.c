@@ -6,26 +6,86 @@
  * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
  */
 #include "system_health.h"
-#include <zephyr/sys/printk.h>
+#include "drift_detector.h"
+#include "flatline_detector.h"
+#include "sensor_reliability.h"
+#include "trace_spans.h"
 #include <zephyr/logging/log.h>
+#include <zephyr/random/random.h>
+#include <errno.h>
+#include <math.h>
 
 LOG_MODULE_REGISTER(system_health, LOG_LEVEL_INF);
 
+/**
+ * @brief Passive health record of one sensor.
+ * Written by every acquisition, consumed by the next check_system_health().
+ */
+typedef struct {
+    reliability_window_t window;    /**< Outcomes of the last acquisitions */
+    health_status_code_t last_code; /**< Status of the last acquisition */
+    int64_t last_acq_ms;            /**< k_uptime_get() of the last acquisition, 0 = never */
+    float temp;                     /**< Last valid Temperature */
+    float humi;                     /**< Last valid Humidity */
+    bool updated;                   /**< New outcome since the last check */
+    uint32_t backoff_ms;            /**< Current probe backoff of a failed sensor, 0 = healthy */
+    int64_t next_probe_ms;          /**< A failed sensor is not probed before this uptime */
+    bool unreliable;                /**< Score below RELIABILITY_MIN_SCORE (logged once) */
+    uint8_t ok_run;                 /**< Consecutive successful acquisitions (up to RELIABILITY_RECOVERY_OKS) */
+} sensor_record_t;
+
+// Passive records and detectors
+// OWNED BY: whoever holds the sensors lock (all callers of this module do)
+static sensor_record_t records[2];
+static bool records_initialized;
+
+// Drift detectors (A - B), fed by every check where both sensors have a new valid reading
+static drift_detector_t temp_drift;
+static drift_detector_t humi_drift;
+static bool drift_initialized;
+static flatline_detector_t flatline;
+static bool flatline_initialized;
+static bool flatline_reported[2];
+
+/**
+ * @brief Internal Helper: Maps a sensor_sample_fetch() error to an outcome class and status.
+ */
+static acq_outcome_t classify_fetch_error(int return_code, health_status_code_t *code) {
+    switch (return_code) {
+    case -EIO:
+        *code = SENSOR_VCC_FAIL;
+        return ACQ_NACK;
+    case -EBUSY:
+        *code = SENSOR_FETCH_FAIL;
+        return ACQ_BUSY;
+    case -EBADMSG:
+        *code = SENSOR_FETCH_FAIL;
+        return ACQ_CRC;
+    default:
+        *code = SENSOR_FETCH_FAIL;
+        return ACQ_FETCH_FAIL;
+    }
+}
+
 /**
  * @brief Internal Helper: Validates a single sensor.
  * * Performs a sequence of checks:
  * 1. Connectivity Check (device_is_ready) -> Detects SDA/SCL issues.
- * 2. Fetch Check (sensor_sample_fetch) -> Detects Power (VCC) issues.
+ * 2. Fetch Check (sensor_sample_fetch) -> Detects Power (VCC), CRC and busy issues.
+ *    A busy frame is retried once.
  * 3. Range Check -> Detects Sensor internal corruption.
- * * @param sensor The device instance to check.
+ * * Every attempt is recorded in the sensor's reliability window.
+ * * @param rec The record of the sensor.
+ * @param sensor The device instance to check.
  * @param final_temp Pointer to store the validated temperature.
  * @param final_humi Pointer to store the validated humidity.
  * @return health_status_code_t Diagnostic result.
  */
-static health_status_code_t check_sensor(const struct device *sensor, float* final_temp, float *final_humi) {
+static health_status_code_t check_sensor(sensor_record_t *rec, const struct device *sensor, float* final_temp, float *final_humi) {
     // 1. Connectivity Check
     int return_code = device_is_ready(sensor);
     if (return_code != 1){
+        reliability_record(&rec->window, ACQ_INVALID);
         if (return_code == 0) {
             LOG_ERR("Sensor %s SDA/SCL Wires not working. Return Code: %d", sensor->name, return_code);
             return SENSOR_SDASCL_FAIL;
@@ -37,16 +97,28 @@ static health_status_code_t check_sensor(const struct device *sensor, float* fin
     } 
     
     // 2. Data Fetch Check
-    return_code = sensor_sample_fetch(sensor);
+    health_status_code_t code = HEALTH_OK;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        trace_span_begin(SPAN_SENSOR_FETCH);
+        return_code = sensor_sample_fetch(sensor);
+        trace_span_end(SPAN_SENSOR_FETCH, return_code);
+        if (return_code == 0) {
+            break;
+        }
+        acq_outcome_t outcome = classify_fetch_error(return_code, &code);
+        reliability_record(&rec->window, outcome);
+        if (outcome != ACQ_BUSY) {
+            break;
+        }
+    }
     if (return_code != 0)
         {
-            if (return_code == -5){
+            if (code == SENSOR_VCC_FAIL){
                 LOG_ERR("Sensor %s VCC (Power) issue. ", sensor->name);
-                return SENSOR_VCC_FAIL;
             } else {
-                LOG_ERR("Sensor %s Fetch Fail. ", sensor->name);
-                return SENSOR_FETCH_FAIL;
+                LOG_ERR("Sensor %s Fetch Fail (%d). ", sensor->name, return_code);
             }
+            return code;
         }
     // 3. Channel Read & Range Check
     struct sensor_value temperature;
@@ -55,65 +127,224 @@ static health_status_code_t check_sensor(const struct device *sensor, float* fin
     int humi_value = sensor_channel_get(sensor, SENSOR_CHAN_HUMIDITY, &humidity);
 
     // Check for Get Failures
-    if (temp_value != 0 && humi_value != 0) return VALUES_GET_FAIL;
-    if (temp_value != 0 && humi_value == 0) return TEMP_VALUE_GET_FAIL;
-    if (humi_value != 0 && temp_value == 0) return HUMI_VALUE_GET_FAIL;
-
-    // Check for Physical Ranges
-    if (temperature.val1 < TEMP_MIN_VALID || temperature.val1 > TEMP_MAX_VALID) return TEMPERATURE_VAL_OUT_OF_RANGE;
-    if (humidity.val1 < HUMIDITY_MIN_VALID || humidity.val1 > HUMIDITY_MAX_VALID) return HUMIDITIY_VAL_OUT_OF_RANGE;
-    if ((temperature.val1 < TEMP_MIN_VALID || temperature.val1 > TEMP_MAX_VALID) && (humidity.val1 < HUMIDITY_MIN_VALID || humidity.val1 > HUMIDITY_MAX_VALID)) return VALUES_OUT_OF_RANGE;
+    code = HEALTH_OK;
+    if (temp_value != 0 && humi_value != 0) code = VALUES_GET_FAIL;
+    else if (temp_value != 0) code = TEMP_VALUE_GET_FAIL;
+    else if (humi_value != 0) code = HUMI_VALUE_GET_FAIL;
+    else {
+        // Check for Physical Ranges
+        bool temp_bad = (temperature.val1 < TEMP_MIN_VALID || temperature.val1 > TEMP_MAX_VALID);
+        bool humi_bad = (humidity.val1 < HUMIDITY_MIN_VALID || humidity.val1 > HUMIDITY_MAX_VALID);
+        if (temp_bad && humi_bad) code = VALUES_OUT_OF_RANGE;
+        else if (temp_bad) code = TEMPERATURE_VAL_OUT_OF_RANGE;
+        else if (humi_bad) code = HUMIDITIY_VAL_OUT_OF_RANGE;
+    }
+    if (code != HEALTH_OK) {
+        reliability_record(&rec->window, ACQ_INVALID);
+        return code;
+    }
     
     // Success: Convert to float
+    reliability_record(&rec->window, ACQ_OK);
     *final_temp = sensor_value_to_double(&temperature);
     *final_humi = sensor_value_to_double(&humidity);
-    // LOG_DBG("%s: T=%.2f, H=%.2f", sensor->name, *final_temp, *final_humi);
-    // printk("%s: T=%.2f, H=%.2f", sensor->name, *final_temp, *final_humi);
     return HEALTH_OK;
 }
 
-
 /**
  * @brief Internal Helper: Cross-references two sensors for drift.
- * * Compares the readings of Sensor A and Sensor B. If the absolute difference
- * exceeds MAX_DRIFT_THRESHOLD, flags both sensors as VALUE_DRIFT.
+ * * Feeds the A - B differences into the EWMA/CUSUM detectors. Both sensors
+ * are flagged as VALUE_DRIFT while either detector reports a drift, which
+ * catches a slow creeping offset early and ignores single spikes.
  */
 static void check_drift(float t1, float h1, float t2, float h2, health_status_code_t *status) {
-    float temp_diff = t1 - t2;
-    float hum_diff = h1 - h2;
+    if (!drift_initialized) {
+        drift_detector_init(&temp_drift, DRIFT_TOLERANCE_TEMP, DRIFT_NOISE_FLOOR_TEMP);
+        drift_detector_init(&humi_drift, DRIFT_TOLERANCE_HUMI, DRIFT_NOISE_FLOOR_HUMI);
+        drift_initialized = true;
+    }
 
-    // Absolute value calculation
-    if (temp_diff < 0) temp_diff = -temp_diff;
-    if (hum_diff < 0) hum_diff = -hum_diff;
+    bool temp_drifting = drift_detector_update(&temp_drift, t1 - t2);
+    bool humi_drifting = drift_detector_update(&humi_drift, h1 - h2);
 
-    if (temp_diff > MAX_DRIFT_THRESHOLD || hum_diff > MAX_DRIFT_THRESHOLD) {
-        LOG_WRN("Sensor Drift Detected! T_Diff: %d, H_Diff: %d", (int)temp_diff, (int)hum_diff);
+    if (temp_drifting || humi_drifting) {
         // Mark both sensors as having drift warning
         if (status[0] == HEALTH_OK) status[0] = VALUE_DRIFT;
         if (status[1] == HEALTH_OK) status[1] = VALUE_DRIFT;
     }
-    LOG_DBG("Sensor Drift: T_Diff: %f, H_Diff: %f", temp_diff, hum_diff);
-    printk("Sensor Drift: T_Diff: %f, H_Diff: %f", temp_diff, hum_diff);
+    LOG_DBG("Sensor Drift: T_Off: %.2f, H_Off: %.2f", (double)temp_drift.mean, (double)humi_drift.mean);
 }
 
+/**
+ * @brief Internal Helper: Flags sensors whose readings froze.
+ * Logged once per episode, the status stays SENSOR_STUCK until the readings move again.
+ */
+static void check_flatline(const struct device *A, const struct device *B,
+                           float t1, float h1, float t2, float h2, health_status_code_t *status) {
+    if (!flatline_initialized) {
+        flatline_detector_init(&flatline, FLATLINE_NOISE_TEMP, FLATLINE_NOISE_HUMI);
+        flatline_initialized = true;
+    }
+
+    bool valid[2] = {status[0] == HEALTH_OK, status[1] == HEALTH_OK};
+    float temp[2] = {t1, t2};
+    float humi[2] = {h1, h2};
+    bool stuck[2];
+    flatline_detector_update(&flatline, valid, temp, humi, stuck);
+
+    for (int i = 0; i < 2; i++) {
+        if (stuck[i] && !flatline_reported[i]) {
+            LOG_ERR("Sensor %s readings are frozen (T: %.2f, H: %.2f)", (i == 0) ? A->name : B->name,
+                    (double)temp[i], (double)humi[i]);
+        } else if (!stuck[i] && flatline_reported[i] && valid[i]) {
+            LOG_INF("Sensor %s readings are moving again", (i == 0) ? A->name : B->name);
+        }
+        flatline_reported[i] = stuck[i];
+        if (stuck[i]) status[i] = SENSOR_STUCK;
+    }
+}
+
+/**
+ * @brief Internal Helper: True if the recent acquisitions of a sensor keep failing.
+ */
+static bool record_unreliable(const sensor_record_t *rec) {
+    return (rec->window.len >= RELIABILITY_MIN_SAMPLES) && (reliability_score(&rec->window) < RELIABILITY_MIN_SCORE);
+}
+
+/**
+ * @brief Internal Helper: Status of a sensor from its passive record.
+ * The last outcome decides, but a sensor whose recent acquisitions keep
+ * failing is reported as SENSOR_FETCH_FAIL even if the last one succeeded.
+ */
+static health_status_code_t record_status(sensor_record_t *rec, const struct device *sensor) {
+    bool unreliable = record_unreliable(rec);
+
+    if (unreliable && !rec->unreliable) {
+        float score = reliability_score(&rec->window);
+        LOG_ERR("Sensor %s unreliable: score %.2f (NACK %.2f, busy %.2f, CRC %.2f, invalid %.2f)", sensor->name,
+                (double)score, (double)reliability_rate(&rec->window, ACQ_NACK),
+                (double)reliability_rate(&rec->window, ACQ_BUSY), (double)reliability_rate(&rec->window, ACQ_CRC),
+                (double)reliability_rate(&rec->window, ACQ_INVALID));
+    }
+    rec->unreliable = unreliable;
+
+    if (rec->last_code == HEALTH_OK && unreliable) {
+        return SENSOR_FETCH_FAIL;
+    }
+    return rec->last_code;
+}
+
+/**
+ * @brief Internal Helper: Schedules the next probe of a failed or unreliable sensor.
+ * Exponential backoff with +-PROBE_BACKOFF_JITTER_PCT jitter, capped at
+ * PROBE_BACKOFF_MAX_MS, so a dead sensor costs one probe every few minutes.
+ */
+static void schedule_probe(sensor_record_t *rec, const struct device *sensor, int64_t now) {
+    rec->backoff_ms = (rec->backoff_ms == 0) ? PROBE_BACKOFF_MIN_MS
+                                             : MIN(2 * rec->backoff_ms, PROBE_BACKOFF_MAX_MS);
+
+    uint32_t spread = rec->backoff_ms * PROBE_BACKOFF_JITTER_PCT / 100;
+    uint32_t delay = rec->backoff_ms - spread + (sys_rand32_get() % (2 * spread + 1));
+    rec->next_probe_ms = now + delay;
+    LOG_DBG("Sensor %s: next probe in %u ms", sensor->name, delay);
+}
+
+static void init_records(void) {
+    if (!records_initialized) {
+        for (int i = 0; i < 2; i++) {
+            reliability_init(&records[i].window);
+        }
+        records_initialized = true;
+    }
+}
 
 // --- Public API Implementation ---
+health_status_code_t system_health_acquire(int sensor_idx, const struct device *sensor, float *temp, float *humi) {
+    init_records();
+    sensor_record_t *rec = &records[sensor_idx];
+
+    float t = 0, h = 0;
+    rec->last_code = check_sensor(rec, sensor, &t, &h);
+    rec->last_acq_ms = k_uptime_get();
+    rec->updated = true;
+    rec->ok_run = (rec->last_code == HEALTH_OK) ? MIN(rec->ok_run + 1, RELIABILITY_RECOVERY_OKS) : 0;
+    if (rec->ok_run >= RELIABILITY_RECOVERY_OKS && record_unreliable(rec)) {
+        // A run of good reads outweighs the failures still in the window
+        reliability_init(&rec->window);
+    }
+    if (rec->last_code != HEALTH_OK) {
+        schedule_probe(rec, sensor, rec->last_acq_ms);
+    } else if (record_unreliable(rec)) {
+        // Good read of an unreliable sensor: restart the backoff, the next
+        // probes confirm the recovery within a minute
+        rec->backoff_ms = 0;
+        schedule_probe(rec, sensor, rec->last_acq_ms);
+    } else if (rec->backoff_ms != 0) {
+        // Any successful read (passive or probe) of a reliable sensor brings it straight back
+        LOG_INF("Sensor %s recovered", sensor->name);
+        rec->backoff_ms = 0;
+    }
+    if (rec->last_code == HEALTH_OK) {
+        rec->temp = t;
+        rec->humi = h;
+        *temp = t;
+        *humi = h;
+    }
+    return rec->last_code;
+}
+
 void check_system_health(const struct device *sensor_A, const struct device *sensor_B, health_status_code_t *status) {
     
-    const struct device *A = sensor_A;
-    const struct device *B = sensor_B;
+    const struct device *sensors[2] = {sensor_A, sensor_B};
+    float scratch_t, scratch_h;
+    int64_t now = k_uptime_get();
+
+    init_records();
+
+    // 1. Individual Hardware Checks: passive, probe only failed, unreliable or idle sensors
+    // (telemetry does not read a disabled sensor, so it could not recover otherwise).
+    // Sensors reported as failed (unreliable ones included) are probed on their backoff schedule.
+    for (int i = 0; i < 2; i++) {
+        sensor_record_t *rec = &records[i];
+        bool idle = (rec->last_acq_ms == 0) || (now - rec->last_acq_ms >= HEALTH_IDLE_PROBE_MS);
+        bool failed = (record_status(rec, sensors[i]) != HEALTH_OK);
+        bool due = !failed || (now >= rec->next_probe_ms);
+        if ((idle || failed) && due) {
+            system_health_acquire(i, sensors[i], &scratch_t, &scratch_h);
+        }
+        status[i] = record_status(rec, sensors[i]);
+    }
 
-    // Local scratchpad variables
-    float t1 = 0, h1 = 0;
-    float t2 = 0, h2 = 0;
+    // 2. Stuck-Value and Cross-Reference Checks, once per new pair of readings
+    if (records[0].updated && records[1].updated) {
+        records[0].updated = records[1].updated = false;
 
-    // 1. Individual Hardware Checks
-    status[0] = check_sensor(A, &t1, &h1);
-    status[1] = check_sensor(B, &t2, &h2);
+        // Only on the readings that passed the checks above
+        check_flatline(sensor_A, sensor_B, records[0].temp, records[0].humi, records[1].temp, records[1].humi, status);
 
-    // 2. Cross-Reference Check
-    // Only run drift check if both sensors are physically healthy
-    if (status[0] == HEALTH_OK && status[1] == HEALTH_OK){
-        check_drift(t1,h1,t2,h2,status);
-    } 
+        // Only run drift check if both sensors are physically healthy
+        if (status[0] == HEALTH_OK && status[1] == HEALTH_OK){
+            check_drift(records[0].temp, records[0].humi, records[1].temp, records[1].humi, status);
+        }
+    }
+
+    // 3. Keep the detector decisions between new readings
+    for (int i = 0; i < 2; i++) {
+        if (flatline_reported[i] && status[i] == HEALTH_OK) status[i] = SENSOR_STUCK;
+    }
+    if (status[0] <= VALUE_DRIFT && status[1] <= VALUE_DRIFT && (temp_drift.drifting || humi_drift.drifting)) {
+        status[0] = status[1] = VALUE_DRIFT;
+    }
+}
+
+float get_sensor_reliability(int sensor_idx) {
+    init_records();
+    return reliability_score(&records[sensor_idx].window);
+}
+
+void get_drift_report(drift_report_t *report) {
+    report->temp_offset = temp_drift.mean;
+    report->humi_offset = humi_drift.mean;
+    report->confidence = fmaxf(drift_detector_confidence(&temp_drift), drift_detector_confidence(&humi_drift));
+    report->drifting = temp_drift.drifting || humi_drift.drifting;
 }
\ No newline at end of file
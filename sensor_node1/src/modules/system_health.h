@@ -6,7 +6,13 @@
  * - Wiring faults (VCC/GND/SDA/SCL)
  * - Sensor initialization failures
  * - Data validity ranges
- * - Drift between redundant sensors
+ * - Drift between redundant sensors (EWMA/CUSUM, see drift_detector.h)
+ * - Stuck (frozen) readings (see flatline_detector.h)
+ * * Health is computed passively: every normal acquisition goes through
+ * system_health_acquire(), which records its outcome (NACK, busy, CRC,
+ * invalid) in a sliding window per sensor. check_system_health() only
+ * probes a sensor that failed (on an exponential backoff) or has been idle
+ * for HEALTH_IDLE_PROBE_MS.
  * @authors: muzamil.py, Google Gemini 3 Pro
  * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
  */
@@ -21,11 +27,49 @@
 #include <stdint.h>
 
 /**
- * @brief Maximum allowable difference between Sensor A and Sensor B.
- * If the difference exceeds this value (in degrees C or % RH), 
- * a DRIFT warning is generated.
+ * @brief Accepted offset between Sensor A and Sensor B (DHT20 accuracy of both sensors).
+ * A DRIFT warning is raised when the CUSUM detector is confident the offset
+ * stays beyond this value, not on a single reading.
  */
-#define MAX_DRIFT_THRESHOLD     5.0f
+#define DRIFT_TOLERANCE_TEMP    1.0f    // 2 x +-0.5 C
+#define DRIFT_TOLERANCE_HUMI    6.0f    // 2 x +-3 %RH
+
+/**
+ * @brief Smallest noise sigma of the A-B difference (sensor resolution and physical noise).
+ */
+#define DRIFT_NOISE_FLOOR_TEMP  0.02f
+#define DRIFT_NOISE_FLOOR_HUMI  0.05f
+
+/**
+ * @brief Typical step noise of one sensor between two readings.
+ * A sensor moving far less than this while the other one moves is stuck.
+ */
+#define FLATLINE_NOISE_TEMP     0.01f
+#define FLATLINE_NOISE_HUMI     0.03f
+
+/**
+ * @brief Passive health: probe a healthy sensor only after this long without an acquisition.
+ */
+#define HEALTH_IDLE_PROBE_MS    90000   // 1.5 telemetry periods
+
+/**
+ * @brief Probe schedule of a failed sensor: exponential backoff from MIN to MAX
+ * with +-JITTER_PCT random jitter. Any successful read resets it.
+ */
+#define PROBE_BACKOFF_MIN_MS     10000
+#define PROBE_BACKOFF_MAX_MS     320000  // ~5 min ceiling
+#define PROBE_BACKOFF_JITTER_PCT 25
+
+/**
+ * @brief A sensor whose reliability score (see sensor_reliability.h) drops
+ * below this, over at least RELIABILITY_MIN_SAMPLES outcomes, is reported as
+ * SENSOR_FETCH_FAIL even if its last acquisition succeeded. After
+ * RELIABILITY_RECOVERY_OKS successful acquisitions in a row its window is
+ * cleared and it is reported healthy again.
+ */
+#define RELIABILITY_MIN_SCORE    0.75f
+#define RELIABILITY_MIN_SAMPLES  8
+#define RELIABILITY_RECOVERY_OKS 3
 
 // --- Safe Operating Limits ---
 #define TEMP_MIN_VALID          -40
@@ -41,7 +85,7 @@ typedef enum {
     /** @brief System is healthy and operating normally. */
     HEALTH_OK = 0,
     
-    /** @brief Sensors disagree by more than MAX_DRIFT_THRESHOLD. */
+    /** @brief Sensors disagree by more than the drift tolerance (CUSUM decision). */
     VALUE_DRIFT,            // 1
     
     /** @brief Communication Bus Error. Often caused by swapped SDA/SCL wires. */
@@ -72,7 +116,10 @@ typedef enum {
     HUMIDITIY_VAL_OUT_OF_RANGE,   // 10
     
     /** @brief Both sensors reporting garbage data. */
-    VALUES_OUT_OF_RANGE     // 11
+    VALUES_OUT_OF_RANGE,    // 11
+
+    /** @brief Plausible but frozen readings (identical frames, or no noise while the other sensor moves). */
+    SENSOR_STUCK            // 12
 
 } health_status_code_t;
 
@@ -86,13 +133,49 @@ typedef struct {
 
 } system_health_t;
 
+/**
+ * @brief Latest drift estimate between the two sensors.
+ */
+typedef struct {
+    float temp_offset;  /**< Estimated A - B Temperature offset (C) */
+    float humi_offset;  /**< Estimated A - B Humidity offset (%RH) */
+    float confidence;   /**< Confidence (0.0 to 1.0) that an offset exceeds its tolerance */
+    bool drifting;      /**< CUSUM decision (maps to VALUE_DRIFT) */
+} drift_report_t;
+
+/**
+ * @brief Reads one sensor and records the outcome (the only way to read a sensor).
+ * * Callers must hold the sensors lock.
+ * @param sensor_idx 0 for Sensor A, 1 for Sensor B.
+ * @param sensor Device struct of that sensor.
+ * @param[out] temp Temperature (Celsius), only written on HEALTH_OK.
+ * @param[out] humi Relative Humidity (%), only written on HEALTH_OK.
+ * @return HEALTH_OK or the failure of this acquisition.
+ */
+health_status_code_t system_health_acquire(int sensor_idx, const struct device *sensor, float *temp, float *humi);
+
 /**
  * @brief Main diagnostic function.
- * Validates connectivity, power, and data integrity for both sensors.
+ * Validates connectivity, power, and data integrity for both sensors from the
+ * recorded acquisitions, probing only failed or idle sensors.
+ * Callers must hold the sensors lock.
  * * @param sensor_A Device struct for the first DHT20 sensor.
  * @param sensor_B Device struct for the second DHT20 sensor.
  * @param status Array of size 2 to store the resulting status codes.
  */
 void check_system_health(const struct device *sensor_A, const struct device *sensor_B, health_status_code_t *status);
 
+/**
+ * @brief Returns the drift estimate of the last check_system_health() call.
+ * @param[out] report Offsets, confidence and decision.
+ */
+void get_drift_report(drift_report_t *report);
+
+/**
+ * @brief Reliability score of a sensor over its last acquisitions.
+ * @param sensor_idx 0 for Sensor A, 1 for Sensor B.
+ * @return 1.0 (every attempt succeeded) down to 0.0.
+ */
+float get_sensor_reliability(int sensor_idx);
+
 #endif
\ No newline at end of file
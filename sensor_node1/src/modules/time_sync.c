@@ -0,0 +1,116 @@
+/**
+ * @file time_sync.c
+ * @brief Implementation of the Fleet Clock Discipline
+ */
+#include "time_sync.h"
+#include <string.h>
+
+void time_sync_init(time_sync_t *sync) {
+    memset(sync, 0, sizeof(*sync));
+}
+
+/**
+ * @brief Reads an unsigned decimal, returns the number of digits consumed.
+ */
+static size_t parse_digits(const char *p, const char *end, uint64_t *value, size_t max_digits) {
+    size_t n = 0;
+
+    *value = 0;
+    while (p + n < end && n < max_digits && p[n] >= '0' && p[n] <= '9') {
+        *value = *value * 10 + (uint64_t)(p[n] - '0');
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Finds "key": in the payload, returns the first byte of its value or NULL.
+ */
+static const char *find_value(const char *payload, const char *end, const char *key) {
+    size_t key_len = strlen(key);
+
+    for (const char *p = payload; p + key_len + 3 <= end; p++) {
+        if (p[0] == '"' && memcmp(p + 1, key, key_len) == 0 && p[key_len + 1] == '"' && p[key_len + 2] == ':') {
+            return p + key_len + 3;
+        }
+    }
+    return NULL;
+}
+
+bool time_sync_parse_beacon(const char *payload, size_t len, int64_t *fleet_ms, uint32_t *seq) {
+    const char *end = payload + len;
+    const char *p = find_value(payload, end, "t");
+    uint64_t seconds, millis = 0, value;
+
+    if (p == NULL) {
+        return false;
+    }
+    size_t n = parse_digits(p, end, &seconds, 12);
+    if (n == 0) {
+        return false;
+    }
+    p += n;
+    if (p < end && *p == '.') {
+        // Up to three fraction digits, scaled to milliseconds
+        size_t frac = parse_digits(p + 1, end, &millis, 3);
+        for (size_t i = frac; i < 3; i++) {
+            millis *= 10;
+        }
+    }
+    *fleet_ms = (int64_t)(seconds * 1000 + millis);
+
+    p = find_value(payload, end, "seq");
+    *seq = (p != NULL && parse_digits(p, end, &value, 10) > 0) ? (uint32_t)value : 0;
+    return true;
+}
+
+/**
+ * @brief Largest raw offset in the window (the least delayed beacon).
+ */
+static int64_t window_max(const time_sync_t *sync) {
+    int64_t best = sync->raw[0];
+
+    for (uint8_t i = 1; i < sync->count; i++) {
+        if (sync->raw[i] > best) {
+            best = sync->raw[i];
+        }
+    }
+    return best;
+}
+
+int64_t time_sync_beacon(time_sync_t *sync, int64_t fleet_ms, uint32_t seq, int64_t local_ms) {
+    int64_t raw = fleet_ms - local_ms;
+    bool restarted = sync->synced && seq < sync->last_seq;
+    int64_t previous = sync->offset_ms;
+
+    if (restarted) {
+        // The server restarted, the old offsets belong to another clock
+        sync->count = 0;
+        sync->next = 0;
+        sync->resets++;
+    }
+
+    sync->raw[sync->next] = raw;
+    sync->next = (sync->next + 1) % TIME_SYNC_WINDOW;
+    if (sync->count < TIME_SYNC_WINDOW) {
+        sync->count++;
+    }
+    sync->offset_ms = window_max(sync);
+    sync->last_beacon_ms = local_ms;
+    sync->last_seq = seq;
+    sync->beacons++;
+
+    if (!sync->synced || restarted) {
+        sync->synced = true;
+        return 0;
+    }
+    return sync->offset_ms - previous;
+}
+
+bool time_sync_to_fleet(const time_sync_t *sync, int64_t local_ms, int64_t *fleet_ms) {
+    if (!sync->synced) {
+        return false;
+    }
+    *fleet_ms = local_ms + sync->offset_ms;
+    return true;
+}
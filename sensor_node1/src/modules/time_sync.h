@@ -0,0 +1,74 @@
+/**
+ * @file time_sync.h
+ * @brief Fleet Clock Discipline
+ * * The server multicasts its uptime (the fleet clock) in CoAP time beacons.
+ * A beacon is only ever late: mesh hops, and on a Sleepy End Device up to a
+ * poll period in the parent's queue, so
+ *   raw offset = beacon fleet time - local uptime at reception
+ * is the true offset minus that delay. The filter keeps the largest raw
+ * offset of the last TIME_SYNC_WINDOW beacons (the least delayed one), which
+ * also follows the crystal drift (nRF52: tens of ppm, a few ms per beacon).
+ * * A beacon sequence number lower than the last one means the server
+ * restarted (its uptime, the fleet clock, started over), and the window
+ * starts over from that beacon.
+ * * Pure logic (no kernel calls): the caller locks and passes the uptime.
+ */
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TIME_SYNC_WINDOW        8       /**< Beacons kept by the filter */
+
+/**
+ * @brief Discipline state.
+ */
+typedef struct {
+    int64_t raw[TIME_SYNC_WINDOW];  /**< Raw offsets of the last beacons (ms) */
+    uint8_t count;                  /**< Valid entries in raw */
+    uint8_t next;                   /**< Next slot to overwrite */
+    bool synced;                    /**< At least one beacon accepted */
+    int64_t offset_ms;              /**< Filtered offset: fleet time - uptime */
+    int64_t last_beacon_ms;         /**< Uptime of the last beacon */
+    uint32_t last_seq;              /**< Sequence number of the last beacon */
+    uint32_t beacons;               /**< Beacons accepted */
+    uint32_t resets;                /**< Filter restarts (server restarted) */
+} time_sync_t;
+
+/**
+ * @brief Clears the state (not synced).
+ */
+void time_sync_init(time_sync_t *sync);
+
+/**
+ * @brief Parses a beacon payload: {"t":<seconds>.<ms>,"seq":<n>}.
+ * @param payload Payload bytes (not NUL-terminated).
+ * @param len Payload length.
+ * @param[out] fleet_ms Fleet time of the beacon (ms).
+ * @param[out] seq Beacon sequence number (0 if absent).
+ * @return true if a fleet time was found.
+ */
+bool time_sync_parse_beacon(const char *payload, size_t len, int64_t *fleet_ms, uint32_t *seq);
+
+/**
+ * @brief Feeds one beacon into the filter.
+ * @param sync Discipline state.
+ * @param fleet_ms Fleet time carried by the beacon.
+ * @param seq Sequence number carried by the beacon.
+ * @param local_ms Local uptime at reception.
+ * @return Change of the filtered offset (ms), 0 for the first beacon and after a restart.
+ */
+int64_t time_sync_beacon(time_sync_t *sync, int64_t fleet_ms, uint32_t seq, int64_t local_ms);
+
+/**
+ * @brief Converts a local uptime into fleet time.
+ * @param sync Discipline state.
+ * @param local_ms Local uptime (e.g. the acquisition time of a sample).
+ * @param[out] fleet_ms Fleet time.
+ * @return false (fleet_ms untouched) until the first beacon.
+ */
+bool time_sync_to_fleet(const time_sync_t *sync, int64_t local_ms, int64_t *fleet_ms);
+
+#endif
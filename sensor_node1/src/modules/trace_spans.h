@@ -0,0 +1,65 @@
+/**
+ * @file trace_spans.h
+ * @brief Latency Span Markers for Zephyr Tracing (CTF Backend)
+ * * Wraps `sys_trace_named_event()` so every pipeline stage emits a BEGIN and
+ * an END marker into the CTF stream. The host script
+ * `tools/trace_analysis/span_report.py` pairs the markers per thread and
+ * builds per-stage latency histograms and a critical-path breakdown.
+ * * When CONFIG_TRACING_CTF is disabled every call compiles to nothing, so the
+ * markers can stay in the production build.
+ * * @note Span names are truncated to 20 characters by the CTF metadata.
+ * Keep them short and unique.
+ */
+#ifndef TRACE_SPANS_H
+#define TRACE_SPANS_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+// --- Span Names (shared with tools/trace_analysis) ---
+#define SPAN_SENSOR_FETCH   "sensor_fetch"
+#define SPAN_HEALTH_CHECK   "health_check"
+#define SPAN_SENSORS_LOCK   "sensors_lock"
+#define SPAN_VTT_UPDATE     "vtt_update"
+#define SPAN_JSON_ENCODE    "json_encode"
+#define SPAN_COAP_SEND      "coap_send"
+#define SPAN_BATCH_ENCODE   "batch_encode"
+
+// Root spans: one per service loop iteration
+#define SPAN_SVC_HEALTH     "svc_health"
+#define SPAN_SVC_TELEMETRY  "svc_telemetry"
+#define SPAN_SVC_VTT        "svc_vtt"
+
+// --- Marker Phases (arg0 of the named event) ---
+#define TRACE_SPAN_PHASE_BEGIN  0
+#define TRACE_SPAN_PHASE_END    1
+
+/**
+ * @brief Marks the start of a span on the calling thread.
+ * @param name One of the SPAN_* names above.
+ */
+static inline void trace_span_begin(const char *name)
+{
+#if defined(CONFIG_TRACING_CTF)
+    sys_trace_named_event(name, TRACE_SPAN_PHASE_BEGIN, 0);
+#else
+    ARG_UNUSED(name);
+#endif
+}
+
+/**
+ * @brief Marks the end of a span on the calling thread.
+ * @param name   Must match the name passed to trace_span_begin().
+ * @param result Stage outcome (return code, byte count...), reported by the host script.
+ */
+static inline void trace_span_end(const char *name, int32_t result)
+{
+#if defined(CONFIG_TRACING_CTF)
+    sys_trace_named_event(name, TRACE_SPAN_PHASE_END, (uint32_t)result);
+#else
+    ARG_UNUSED(name);
+    ARG_UNUSED(result);
+#endif
+}
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * @file weather_replay.c
+ * @brief Implementation of the Trace-Driven Weather Source
+ * * .wtr layout (little-endian):
+ *   "WTR1" | uint32 step_s | uint32 count | count x {int16 temp_centi_c, uint16 rh_centi}
+ */
+#include "weather_replay.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include <errno.h>
+
+LOG_MODULE_REGISTER(weather_replay, LOG_LEVEL_INF);
+
+#define WTR_MAGIC "WTR1"
+#define WTR_HEADER_SIZE 12
+#define WTR_RECORD_SIZE 4
+
+// Embedded trace, generated from CONFIG_APP_WEATHER_TRACE_FILE by CMake
+static const uint8_t embedded_trace[] = {
+#include "weather_trace.inc"
+};
+
+// Active trace (set once by weather_replay_init(), read-only afterwards)
+static const uint8_t *trace_records;
+static uint32_t trace_step_s;
+static uint32_t trace_count;
+
+#if defined(CONFIG_ARCH_POSIX)
+// --- native_sim: optional trace from the host filesystem ---
+#include <cmdline.h>
+#include <posix_native_task.h>
+#include <nsi_host_trampolines.h>
+
+#define HOST_TRACE_MAX_BYTES (64 * 1024) // One year, hourly: ~35 KB
+#define HOST_O_RDONLY 0
+
+static char *host_trace_path;
+static uint8_t host_trace[HOST_TRACE_MAX_BYTES];
+
+static void weather_replay_add_options(void)
+{
+    static struct args_struct_t options[] = {
+        {.option = "weather-trace", .name = "path", .type = 's',
+         .dest = (void *)&host_trace_path,
+         .descript = "Weather trace (.wtr) replayed by the simulation node"},
+        ARG_TABLE_ENDMARKER};
+
+    native_add_command_line_opts(options);
+}
+NATIVE_TASK(weather_replay_add_options, PRE_BOOT_1, 1);
+
+/**
+ * @brief Loads the -weather-trace file into host_trace.
+ * @return Number of bytes read, or 0 if no host trace was given or it failed.
+ */
+static size_t load_host_trace(void)
+{
+    if (host_trace_path == NULL) {
+        return 0;
+    }
+
+    int fd = nsi_host_open(host_trace_path, HOST_O_RDONLY);
+    if (fd < 0) {
+        LOG_ERR("[REPLAY] Cannot open %s, using the embedded trace", host_trace_path);
+        return 0;
+    }
+    long len = nsi_host_read(fd, host_trace, sizeof(host_trace));
+    nsi_host_close(fd);
+
+    if (len <= 0 || len == sizeof(host_trace)) {
+        LOG_ERR("[REPLAY] %s is empty or larger than %d bytes", host_trace_path, HOST_TRACE_MAX_BYTES);
+        return 0;
+    }
+    return (size_t)len;
+}
+#endif
+
+/**
+ * @brief Validates a .wtr image and makes it the active trace.
+ */
+static int select_trace(const uint8_t *image, size_t len, const char *origin)
+{
+    if (len < WTR_HEADER_SIZE || memcmp(image, WTR_MAGIC, 4) != 0) {
+        LOG_ERR("[REPLAY] %s trace: bad header", origin);
+        return -EINVAL;
+    }
+
+    uint32_t step_s = sys_get_le32(&image[4]);
+    uint32_t count = sys_get_le32(&image[8]);
+    if (step_s == 0 || count == 0 || (len - WTR_HEADER_SIZE) / WTR_RECORD_SIZE < count) {
+        LOG_ERR("[REPLAY] %s trace: step %u s, %u records do not fit %u bytes", origin, step_s, count, (unsigned int)len);
+        return -EINVAL;
+    }
+
+    trace_records = &image[WTR_HEADER_SIZE];
+    trace_step_s = step_s;
+    trace_count = count;
+    LOG_INF("[REPLAY] %s trace: %u samples every %u s (%u h), x%d speed-up", origin, count, step_s,
+            (count * step_s) / 3600, CONFIG_APP_WEATHER_REPLAY_SPEEDUP);
+    return 0;
+}
+
+// --- Public API Implementation ---
+int weather_replay_init(void)
+{
+#if defined(CONFIG_ARCH_POSIX)
+    size_t host_len = load_host_trace();
+    if (host_len > 0 && select_trace(host_trace, host_len, "Host") == 0) {
+        return 0;
+    }
+#endif
+    return select_trace(embedded_trace, sizeof(embedded_trace), "Embedded");
+}
+
+/**
+ * @brief Trace time in milliseconds, compressed and wrapped to the trace length.
+ */
+static uint64_t trace_time_ms(void)
+{
+    uint64_t period_ms = (uint64_t)trace_count * trace_step_s * MSEC_PER_SEC;
+
+    return ((uint64_t)k_uptime_get() * CONFIG_APP_WEATHER_REPLAY_SPEEDUP) % period_ms;
+}
+
+bool weather_replay_read(float *temperature, float *humidity)
+{
+    if (trace_count == 0) {
+        return false;
+    }
+
+    uint64_t step_ms = (uint64_t)trace_step_s * MSEC_PER_SEC;
+    uint64_t t_ms = trace_time_ms();
+    uint32_t index = (uint32_t)(t_ms / step_ms);
+    float frac = (float)(t_ms % step_ms) / (float)step_ms;
+
+    // The last sample interpolates towards the first one (looping trace)
+    const uint8_t *a = &trace_records[index * WTR_RECORD_SIZE];
+    const uint8_t *b = &trace_records[((index + 1) % trace_count) * WTR_RECORD_SIZE];
+    float temp_a = (int16_t)sys_get_le16(&a[0]) / 100.0f;
+    float temp_b = (int16_t)sys_get_le16(&b[0]) / 100.0f;
+    float rh_a = sys_get_le16(&a[2]) / 100.0f;
+    float rh_b = sys_get_le16(&b[2]) / 100.0f;
+
+    *temperature = temp_a + (temp_b - temp_a) * frac;
+    *humidity = rh_a + (rh_b - rh_a) * frac;
+    return true;
+}
+
+float weather_replay_hours(void)
+{
+    if (trace_count == 0) {
+        return 0.0f;
+    }
+    return (float)trace_time_ms() / 3600000.0f;
+}
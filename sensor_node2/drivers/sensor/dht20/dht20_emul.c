@@ -0,0 +1,353 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * I2C emulator for the Aosong DHT20.
+ *
+ * Answers the transactions issued by dht20.c:
+ *   write {0x71} + read 1          -> status byte
+ *   write {reg, 0, 0} + read 3     -> reset register readback (init sequence)
+ *   write {0xB0 | reg, x, y}       -> reset register write (marks calibrated)
+ *   write {0xAC, 0x33, 0x00}       -> trigger, frame ready 80 ms later
+ *   read 7                         -> measurement frame + CRC8 (poly 0x31)
+ *
+ * Readings follow a scripted trace (built-in indoor day by default) whose
+ * clock runs CONFIG_EMUL_DHT20_TIME_SCALE times faster than the uptime, with a
+ * few raw LSB of dither so consecutive frames differ like on the real part.
+ */
+#define DT_DRV_COMPAT aosong_dht20
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+#if defined(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#include <stdlib.h>
+#endif
+
+#include "dht20_emul.h"
+
+LOG_MODULE_REGISTER(dht20_emul, CONFIG_SENSOR_LOG_LEVEL);
+
+#define DHT20_EMUL_CMD_STATUS      0x71
+#define DHT20_EMUL_CMD_TRIGGER     0xAC
+#define DHT20_EMUL_CMD_RESET_MASK  0xB0
+#define DHT20_EMUL_STATUS_BUSY     BIT(7)
+#define DHT20_EMUL_STATUS_CAL      0x18
+#define DHT20_EMUL_CRC_POLYNOM     0x31
+#define DHT20_EMUL_FRAME_LENGTH    7
+#define DHT20_EMUL_MEASURE_MS      80
+#define DHT20_EMUL_POWER_ON_MS     100
+#define DHT20_EMUL_RAW_MAX         0xFFFFF
+#define DHT20_EMUL_DITHER_LSB      8       /* +-8 raw LSB: ~0.0015 degC / ~0.0008 %RH */
+
+/* Built-in trace: one indoor day with a humid evening (loops) */
+static const struct dht20_emul_point dht20_emul_default_trace[] = {
+	{.time_s = 0,         .temp_centi_c = 2000, .rh_centi = 5500},
+	{.time_s = 6 * 3600,  .temp_centi_c = 1800, .rh_centi = 6500},
+	{.time_s = 12 * 3600, .temp_centi_c = 2300, .rh_centi = 5000},
+	{.time_s = 18 * 3600, .temp_centi_c = 2100, .rh_centi = 8500},
+	{.time_s = 24 * 3600, .temp_centi_c = 2000, .rh_centi = 5500},
+};
+
+struct dht20_emul_cfg {
+	uint16_t addr;
+};
+
+struct dht20_emul_data {
+	struct k_spinlock lock;
+	const struct dht20_emul_point *trace;
+	size_t trace_len;
+	bool loop;
+	int64_t trace_start_ms;
+
+	enum dht20_emul_fault fault;
+	uint32_t fault_left;     /* Remaining affected transfers, 0 = until cleared */
+
+	uint8_t last_cmd;        /* First byte of the last write */
+	bool calibrated;         /* Status bits 3/4, cleared by power loss */
+	int64_t ready_ms;        /* Uptime when the current frame stops being busy */
+	uint32_t transfers;
+
+	uint32_t noise;          /* xorshift32 state of the dither */
+	uint8_t last_frame[5];   /* Payload of the last frame, repeated by FAULT_FREEZE */
+	bool has_last_frame;
+};
+
+/* Interpolates the trace at the current (scaled) trace time */
+static void dht20_emul_trace_value(struct dht20_emul_data *data, int32_t *temp_cc,
+				   int32_t *rh_cc)
+{
+	const struct dht20_emul_point *p = data->trace;
+	int64_t t_ms = (k_uptime_get() - data->trace_start_ms) * CONFIG_EMUL_DHT20_TIME_SCALE;
+	int64_t end_ms = (int64_t)p[data->trace_len - 1].time_s * MSEC_PER_SEC;
+
+	if (data->loop && end_ms > 0) {
+		t_ms %= end_ms;
+	}
+
+	*temp_cc = p[data->trace_len - 1].temp_centi_c;
+	*rh_cc = p[data->trace_len - 1].rh_centi;
+	for (size_t i = 1; i < data->trace_len; i++) {
+		int64_t t0 = (int64_t)p[i - 1].time_s * MSEC_PER_SEC;
+		int64_t t1 = (int64_t)p[i].time_s * MSEC_PER_SEC;
+
+		if (t_ms < t1) {
+			int64_t span = MAX(t1 - t0, 1);
+			int64_t pos = CLAMP(t_ms - t0, 0, span);
+
+			*temp_cc = p[i - 1].temp_centi_c +
+				   (int32_t)(((int64_t)p[i].temp_centi_c - p[i - 1].temp_centi_c) *
+					     pos / span);
+			*rh_cc = p[i - 1].rh_centi +
+				 (int32_t)(((int64_t)p[i].rh_centi - p[i - 1].rh_centi) * pos / span);
+			break;
+		}
+	}
+}
+
+/* Uniform dither in [-DHT20_EMUL_DITHER_LSB, DHT20_EMUL_DITHER_LSB] */
+static int32_t dht20_emul_dither(struct dht20_emul_data *data)
+{
+	uint32_t x = data->noise;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	data->noise = x;
+	return (int32_t)(x % (2 * DHT20_EMUL_DITHER_LSB + 1)) - DHT20_EMUL_DITHER_LSB;
+}
+
+/* Builds a measurement frame with the inverse of dht20_temp_convert()/dht20_rh_convert() */
+static void dht20_emul_frame(struct dht20_emul_data *data, uint8_t *frame, bool busy, bool bad_crc,
+			     bool frozen)
+{
+	frame[0] = (data->calibrated ? DHT20_EMUL_STATUS_CAL : 0) | (busy ? DHT20_EMUL_STATUS_BUSY : 0);
+
+	if (frozen && data->has_last_frame) {
+		memcpy(&frame[1], data->last_frame, sizeof(data->last_frame));
+	} else {
+		int32_t temp_cc, rh_cc;
+
+		dht20_emul_trace_value(data, &temp_cc, &rh_cc);
+
+		/* S_T = (T + 50) / 200 * 2^20, S_RH = RH / 100 * 2^20 */
+		uint32_t t_raw = CLAMP((((int64_t)(temp_cc + 5000) << 20) / 20000) +
+					       dht20_emul_dither(data), 0, DHT20_EMUL_RAW_MAX);
+		uint32_t rh_raw = CLAMP((((int64_t)rh_cc << 20) / 10000) + dht20_emul_dither(data),
+					0, DHT20_EMUL_RAW_MAX);
+
+		frame[1] = rh_raw >> 12;
+		frame[2] = rh_raw >> 4;
+		frame[3] = ((rh_raw & 0x0F) << 4) | (t_raw >> 16);
+		frame[4] = t_raw >> 8;
+		frame[5] = t_raw;
+		if (!busy) {
+			memcpy(data->last_frame, &frame[1], sizeof(data->last_frame));
+			data->has_last_frame = true;
+		}
+	}
+	frame[6] = crc8(frame, 6, DHT20_EMUL_CRC_POLYNOM, 0xFF, false);
+	if (bad_crc) {
+		frame[6] ^= 0xA5;
+	}
+}
+
+/* Consumes one affected transfer, returns the fault that applies to it */
+static enum dht20_emul_fault dht20_emul_take_fault(struct dht20_emul_data *data, bool is_frame_read)
+{
+	enum dht20_emul_fault fault = data->fault;
+
+	switch (fault) {
+	case DHT20_EMUL_FAULT_BUSY:
+	case DHT20_EMUL_FAULT_CRC:
+	case DHT20_EMUL_FAULT_FREEZE:
+		if (!is_frame_read) {
+			return DHT20_EMUL_FAULT_NONE;
+		}
+		break;
+	case DHT20_EMUL_FAULT_NONE:
+		return fault;
+	default:
+		break;
+	}
+
+	if (data->fault_left > 0 && --data->fault_left == 0) {
+		data->fault = DHT20_EMUL_FAULT_NONE;
+		if (fault == DHT20_EMUL_FAULT_POWER_LOSS) {
+			/* Power is back: frames stay busy for the power-on time */
+			data->ready_ms = k_uptime_get() + DHT20_EMUL_POWER_ON_MS;
+		}
+	}
+	return fault;
+}
+
+static int dht20_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+			       int addr)
+{
+	const struct dht20_emul_cfg *cfg = target->cfg;
+	struct dht20_emul_data *data = target->data;
+	int rc = 0;
+
+	if (addr != cfg->addr) {
+		return -EIO;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+	data->transfers++;
+	bool is_frame_read = (num_msgs == 1) && (msgs[0].flags & I2C_MSG_READ) &&
+			     (msgs[0].len == DHT20_EMUL_FRAME_LENGTH);
+	enum dht20_emul_fault fault = dht20_emul_take_fault(data, is_frame_read);
+
+	if (fault == DHT20_EMUL_FAULT_NACK || fault == DHT20_EMUL_FAULT_POWER_LOSS) {
+		if (fault == DHT20_EMUL_FAULT_POWER_LOSS) {
+			data->calibrated = false;
+		}
+		k_spin_unlock(&data->lock, key);
+		return -EIO;
+	}
+
+	for (int i = 0; i < num_msgs && rc == 0; i++) {
+		struct i2c_msg *msg = &msgs[i];
+
+		if (!(msg->flags & I2C_MSG_READ)) {
+			if (msg->len == 0) {
+				continue;
+			}
+			data->last_cmd = msg->buf[0];
+			if (data->last_cmd == DHT20_EMUL_CMD_TRIGGER) {
+				data->ready_ms = MAX(data->ready_ms, k_uptime_get() + DHT20_EMUL_MEASURE_MS);
+			} else if ((data->last_cmd & 0xF0) == DHT20_EMUL_CMD_RESET_MASK) {
+				data->calibrated = true;
+			}
+			continue;
+		}
+
+		if (msg->len == DHT20_EMUL_FRAME_LENGTH) {
+			bool busy = (k_uptime_get() < data->ready_ms) || (fault == DHT20_EMUL_FAULT_BUSY);
+
+			dht20_emul_frame(data, msg->buf, busy, fault == DHT20_EMUL_FAULT_CRC,
+					 fault == DHT20_EMUL_FAULT_FREEZE);
+		} else if (data->last_cmd == DHT20_EMUL_CMD_STATUS && msg->len == 1) {
+			msg->buf[0] = (data->calibrated ? DHT20_EMUL_STATUS_CAL : 0) |
+				      ((k_uptime_get() < data->ready_ms) ? DHT20_EMUL_STATUS_BUSY : 0);
+		} else if (msg->len == 3) {
+			/* Reset register readback */
+			memset(msg->buf, 0, msg->len);
+		} else {
+			LOG_WRN("Unexpected %u byte read after 0x%02x", msg->len, data->last_cmd);
+			rc = -EIO;
+		}
+	}
+
+	k_spin_unlock(&data->lock, key);
+	return rc;
+}
+
+void dht20_emul_set_trace(const struct emul *target, const struct dht20_emul_point *points,
+			  size_t count, bool loop)
+{
+	struct dht20_emul_data *data = target->data;
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+	if (points == NULL || count == 0) {
+		points = dht20_emul_default_trace;
+		count = ARRAY_SIZE(dht20_emul_default_trace);
+		loop = true;
+	}
+	data->trace = points;
+	data->trace_len = count;
+	data->loop = loop;
+	data->trace_start_ms = k_uptime_get();
+
+	k_spin_unlock(&data->lock, key);
+}
+
+void dht20_emul_set_fault(const struct emul *target, enum dht20_emul_fault fault, uint32_t count)
+{
+	struct dht20_emul_data *data = target->data;
+	k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+	if (fault == DHT20_EMUL_FAULT_NONE && data->fault == DHT20_EMUL_FAULT_POWER_LOSS) {
+		data->ready_ms = k_uptime_get() + DHT20_EMUL_POWER_ON_MS;
+	}
+	data->fault = fault;
+	data->fault_left = count;
+
+	k_spin_unlock(&data->lock, key);
+}
+
+uint32_t dht20_emul_transfer_count(const struct emul *target)
+{
+	const struct dht20_emul_data *data = target->data;
+
+	return data->transfers;
+}
+
+static int dht20_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct dht20_emul_data *data = target->data;
+	const struct dht20_emul_cfg *cfg = target->cfg;
+
+	ARG_UNUSED(parent);
+
+	/* Per-instance seed so the two sensors do not dither in lockstep */
+	data->noise = 0x9E3779B9u ^ ((uint32_t)cfg->addr << 16) ^ (uint32_t)(uintptr_t)target;
+	dht20_emul_set_trace(target, NULL, 0, true);
+	return 0;
+}
+
+#if defined(CONFIG_SHELL)
+/* dht20_emul fault <device> <none|nack|busy|crc|power|freeze> [count] */
+static int cmd_dht20_emul_fault(const struct shell *sh, size_t argc, char **argv)
+{
+	static const char *const names[] = {"none", "nack", "busy", "crc", "power", "freeze"};
+	const struct emul *target = emul_get_binding(argv[1]);
+
+	if (target == NULL) {
+		shell_error(sh, "No emulator named %s", argv[1]);
+		return -ENODEV;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(names); i++) {
+		if (strcmp(argv[2], names[i]) == 0) {
+			uint32_t count = (argc > 3) ? strtoul(argv[3], NULL, 0) : 0;
+
+			dht20_emul_set_fault(target, (enum dht20_emul_fault)i, count);
+			shell_print(sh, "%s: fault %s for %u transfers (0 = until cleared)", argv[1],
+				    names[i], count);
+			return 0;
+		}
+	}
+
+	shell_error(sh, "Unknown fault %s", argv[2]);
+	return -EINVAL;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_dht20_emul,
+	SHELL_CMD_ARG(fault, NULL, "<device> <none|nack|busy|crc|power|freeze> [count]",
+		      cmd_dht20_emul_fault, 3, 1),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(dht20_emul, &sub_dht20_emul, "DHT20 emulator controls", NULL);
+#endif
+
+static const struct i2c_emul_api dht20_emul_api_i2c = {
+	.transfer = dht20_emul_transfer,
+};
+
+#define DHT20_EMUL(n)                                                                              \
+	static struct dht20_emul_data dht20_emul_data_##n;                                         \
+	static const struct dht20_emul_cfg dht20_emul_cfg_##n = {.addr = DT_INST_REG_ADDR(n)};    \
+	EMUL_DT_INST_DEFINE(n, dht20_emul_init, &dht20_emul_data_##n, &dht20_emul_cfg_##n,         \
+			    &dht20_emul_api_i2c, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(DHT20_EMUL)
@@ -0,0 +1,36 @@
+/**
+ * @file app_channels.c
+ * @brief zbus Channel Definitions of the Sensor Node
+ * * Channels are defined without static observers. Each consumer registers
+ * itself with ZBUS_CHAN_ADD_OBS() next to its own code.
+ */
+#include "app_channels.h"
+
+// Frames are copied into the fixed net_buf pool of the message subscriber
+BUILD_ASSERT(sizeof(outbound_frame_t) <= CONFIG_ZBUS_MSG_SUBSCRIBER_NET_BUF_STATIC_DATA_SIZE,
+             "outbound_frame_t does not fit the zbus message subscriber buffers");
+
+ZBUS_CHAN_DEFINE(sample_chan,
+                 sample_msg_t,
+                 NULL, NULL,
+                 ZBUS_OBSERVERS_EMPTY,
+                 ZBUS_MSG_INIT(0));
+
+// Both sensors start disabled until the first health check has run
+ZBUS_CHAN_DEFINE(health_chan,
+                 health_msg_t,
+                 NULL, NULL,
+                 ZBUS_OBSERVERS_EMPTY,
+                 ZBUS_MSG_INIT(0));
+
+ZBUS_CHAN_DEFINE(model_chan,
+                 model_msg_t,
+                 NULL, NULL,
+                 ZBUS_OBSERVERS_EMPTY,
+                 ZBUS_MSG_INIT(0));
+
+ZBUS_CHAN_DEFINE(outbound_chan,
+                 outbound_frame_t,
+                 NULL, NULL,
+                 ZBUS_OBSERVERS_EMPTY,
+                 ZBUS_MSG_INIT(0));
@@ -0,0 +1,88 @@
+/**
+ * @file condensation_monitor.h
+ * @brief Condensation Early Warning
+ * * The VTT model runs once per hour, so saturated air can sit on a wall for
+ * most of an hour before anyone is told. This evaluator is cheap enough to
+ * run on every sample (one logf, no history beyond the last sample):
+ * - Dew point (Magnus formula, Sonntag 1990 constants)
+ * - Margin to saturation: air Temperature minus dew point (C)
+ * - RH slope (%RH per minute, smoothed) to warn before saturation is reached
+ * * Levels have hysteresis so a reading hovering at a threshold does not
+ * toggle the alert every sample.
+ */
+#ifndef CONDENSATION_MONITOR_H
+#define CONDENSATION_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Margins (air Temperature - dew point) of the levels, entry / exit.
+ * 0.5 C is about 97 %RH, 1.5 C about 91 %RH at room temperature.
+ */
+#define COND_MARGIN_CONDENSING      0.5f
+#define COND_MARGIN_CONDENSING_EXIT 1.0f
+#define COND_MARGIN_NEAR            1.5f
+#define COND_MARGIN_NEAR_EXIT       2.5f
+
+/**
+ * @brief NEAR is also raised when the RH trend reaches saturation within this horizon.
+ */
+#define COND_HORIZON_MIN            15.0f
+
+/**
+ * @brief Condensation risk levels.
+ */
+typedef enum {
+    COND_RISK_NONE = 0,     /**< Dry enough */
+    COND_RISK_NEAR,         /**< Close to (or heading for) saturation */
+    COND_RISK_CONDENSING    /**< Saturated air: condensation on any colder surface */
+} cond_risk_t;
+
+/**
+ * @brief Result of one sample.
+ */
+typedef struct {
+    float dew_point;        /**< Dew point (C) */
+    float margin;           /**< Temperature - dew point (C), 0 at saturation */
+    float rh_slope;         /**< Smoothed RH slope (%RH per minute) */
+    cond_risk_t level;      /**< Level after this sample */
+} cond_report_t;
+
+/**
+ * @brief Evaluator state (last sample and smoothed slope).
+ */
+typedef struct {
+    bool has_last;
+    float last_rh;
+    int64_t last_ms;
+    float rh_slope;
+    cond_risk_t level;
+} cond_monitor_t;
+
+/**
+ * @brief Clears the state (level NONE).
+ */
+void cond_monitor_init(cond_monitor_t *mon);
+
+/**
+ * @brief Dew point from Temperature and Relative Humidity.
+ * @param temp_c Temperature (Celsius).
+ * @param rh_percent Relative Humidity (%), clamped to 1..100.
+ * @return Dew point (Celsius).
+ */
+float cond_dew_point(float temp_c, float rh_percent);
+
+/**
+ * @brief Evaluates one sample.
+ * @param mon Evaluator state.
+ * @param temp_c Temperature (Celsius).
+ * @param rh_percent Relative Humidity (%).
+ * @param timestamp_ms Acquisition time of the sample.
+ * @param[out] report Dew point, margin, slope and level.
+ * @return true if the level changed with this sample.
+ */
+bool cond_monitor_update(cond_monitor_t *mon, float temp_c, float rh_percent, int64_t timestamp_ms,
+                         cond_report_t *report);
+
+#endif
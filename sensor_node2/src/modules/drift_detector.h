@@ -0,0 +1,53 @@
+/**
+ * @file drift_detector.h
+ * @brief Streaming Drift Detector for Redundant Sensors
+ * * Watches the difference d = A - B of one quantity (Temperature or Humidity)
+ * measured by two sensors, one health check at a time, in constant memory:
+ * - EWMA mean of d: the estimated offset between the sensors.
+ * - EWMA variance of d around that mean: the uncertainty of the estimate.
+ * - Noise: EWMA of the squared step of d, which a slow drift does not inflate.
+ * - Two-sided CUSUM of the part of |d| above the accepted tolerance, in noise
+ *   units and clipped per sample, so a creeping offset accumulates while a
+ *   single spike cannot raise an alarm on its own.
+ */
+#ifndef DRIFT_DETECTOR_H
+#define DRIFT_DETECTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief State of one detector.
+ */
+typedef struct {
+    float tolerance;    /**< Offset accepted between the sensors (datasheet accuracy) */
+    float noise_floor;  /**< Smallest noise sigma assumed (sensor resolution) */
+    float mean;         /**< EWMA of d: estimated offset */
+    float var;          /**< EWMA variance of d around mean */
+    float noise_var;    /**< EWMA of (d - d_prev)^2 / 2 */
+    float last;         /**< Previous d */
+    float cusum_pos;    /**< CUSUM of d above +tolerance (noise units) */
+    float cusum_neg;    /**< CUSUM of d below -tolerance (noise units) */
+    uint32_t samples;   /**< Samples seen since init */
+    bool drifting;      /**< Current decision */
+} drift_detector_t;
+
+/**
+ * @brief Resets a detector.
+ * @param tolerance   Accepted offset between the two sensors.
+ * @param noise_floor Smallest noise sigma (avoids dividing by ~0 on quantized readings).
+ */
+void drift_detector_init(drift_detector_t *det, float tolerance, float noise_floor);
+
+/**
+ * @brief Feeds one difference d = A - B.
+ * @return true while the detector considers the sensors drifted apart.
+ */
+bool drift_detector_update(drift_detector_t *det, float diff);
+
+/**
+ * @brief Confidence (0.0 to 1.0) that the true offset exceeds the tolerance.
+ */
+float drift_detector_confidence(const drift_detector_t *det);
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * @file flatline_detector.h
+ * @brief Stuck-Value (Flatline) Detector for the Redundant Sensors
+ * * A DHT20 can keep returning a plausible but frozen value, which passes every
+ * range check. Real readings always move a little: the 20-bit raw value
+ * resolves far below the sensor noise. Two checks run on the health samples,
+ * in constant memory:
+ * - Identical frames: both channels bit-identical for FLATLINE_IDENTICAL_MAX
+ *   consecutive checks.
+ * - Quiet window: over FLATLINE_WINDOW checks the sensor moved less than the
+ *   physical noise while the other sensor kept moving.
+ */
+#ifndef FLATLINE_DETECTOR_H
+#define FLATLINE_DETECTOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Per-sensor state.
+ */
+typedef struct {
+    float last_temp;        /**< Previous Temperature reading */
+    float last_humi;        /**< Previous Humidity reading */
+    bool has_last;          /**< last_* are valid */
+    uint32_t identical_run; /**< Consecutive bit-identical frames */
+    float step_energy;      /**< Sum of squared (noise-normalized) steps in the window */
+    uint32_t steps;         /**< Steps accumulated in the window */
+    bool window_quiet;      /**< Verdict of the last complete window */
+} flatline_sensor_t;
+
+/**
+ * @brief Detector for a pair of sensors.
+ */
+typedef struct {
+    flatline_sensor_t sensor[2];
+    float temp_noise;       /**< Physical noise of a Temperature step (C) */
+    float humi_noise;       /**< Physical noise of a Humidity step (%RH) */
+} flatline_detector_t;
+
+/**
+ * @brief Resets the detector.
+ * @param temp_noise Typical Temperature step noise between two checks.
+ * @param humi_noise Typical Humidity step noise between two checks.
+ */
+void flatline_detector_init(flatline_detector_t *det, float temp_noise, float humi_noise);
+
+/**
+ * @brief Feeds one health check.
+ * @param valid  Which sensors returned a reading (status HEALTH_OK before this check).
+ * @param temp   Temperature of Sensor A and B.
+ * @param humi   Humidity of Sensor A and B.
+ * @param[out] stuck Set per sensor when its readings are implausibly constant.
+ */
+void flatline_detector_update(flatline_detector_t *det, const bool valid[2],
+                              const float temp[2], const float humi[2], bool stuck[2]);
+
+#endif
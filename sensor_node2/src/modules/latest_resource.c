@@ -0,0 +1,161 @@
+/**
+ * @file latest_resource.c
+ * @brief Implementation of the Pull-Mode Latest Values Resource
+ */
+#include "latest_resource.h"
+#include "app_channels.h"
+#include "messaging_service.h"
+#include "payload_encoder.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/net/openthread.h>
+#include <openthread/coap.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(latest_resource, LOG_LEVEL_INF);
+
+// * --- CONFIGURATION --- *
+#define LATEST_NO_SAMPLE_MAX_AGE_S 5    /**< Max-Age of the 5.03 sent before the first sample */
+#define LATEST_CHAN_TIMEOUT K_MSEC(10)  /**< Channel read wait (OpenThread context) */
+#define LATEST_ETAG_LEN 4
+
+// --- Globals ---
+static const char *latest_room_name;
+static uint32_t latest_period_ms;
+// OWNED BY: the OpenThread context (the handler)
+static char latest_payload[PAYLOAD_MAX_LEN];
+static uint32_t served;         /**< 2.05 responses */
+static uint32_t not_modified;   /**< 2.03 responses */
+
+/**
+ * @brief Seconds until the next sample is due, at least 1.
+ */
+static uint32_t max_age_s(const sample_msg_t *sample) {
+    int64_t age_ms = k_uptime_get() - sample->timestamp_ms;
+
+    if (age_ms < 0 || age_ms >= latest_period_ms) {
+        return 1;
+    }
+    return MAX((latest_period_ms - (uint32_t)age_ms) / 1000U, 1U);
+}
+
+/**
+ * @brief True if the request carries `etag` among its ETag options.
+ */
+static bool request_has_etag(const otMessage *request, const uint8_t *etag) {
+    otCoapOptionIterator iterator;
+    const otCoapOption *option;
+    uint8_t value[8];
+
+    if (otCoapOptionIteratorInit(&iterator, request) != OT_ERROR_NONE) {
+        return false;
+    }
+    for (option = otCoapOptionIteratorGetFirstOptionMatching(&iterator, OT_COAP_OPTION_E_TAG); option != NULL;
+         option = otCoapOptionIteratorGetNextOptionMatching(&iterator, OT_COAP_OPTION_E_TAG)) {
+        if (option->mLength == LATEST_ETAG_LEN && otCoapOptionIteratorGetOptionValue(&iterator, value) == OT_ERROR_NONE &&
+            memcmp(value, etag, LATEST_ETAG_LEN) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Sends the response (piggybacked on the ACK of a Confirmable request).
+ * Options go in ascending number order: ETag (4), Content-Format (12), Max-Age (14).
+ */
+static void send_latest_response(otMessage *request, const otMessageInfo *message_info, otCoapCode code,
+                                 const uint8_t *etag, uint32_t max_age, const char *payload) {
+    otInstance *instance = openthread_get_default_instance();
+    otCoapType type = (otCoapMessageGetType(request) == OT_COAP_TYPE_CONFIRMABLE) ? OT_COAP_TYPE_ACKNOWLEDGMENT
+                                                                                   : OT_COAP_TYPE_NON_CONFIRMABLE;
+    otError error = OT_ERROR_NONE;
+    otMessage *response = otCoapNewMessage(instance, NULL);
+
+    if (response == NULL) {
+        LOG_WRN("[LATEST] No buffer for the response");
+        return;
+    }
+    otCoapMessageInitResponse(response, request, type, code);
+    if (etag != NULL) {
+        error = otCoapMessageAppendOption(response, OT_COAP_OPTION_E_TAG, LATEST_ETAG_LEN, etag);
+    }
+    if (error == OT_ERROR_NONE && payload != NULL) {
+        error = otCoapMessageAppendContentFormatOption(response, OT_COAP_OPTION_CONTENT_FORMAT_JSON);
+    }
+    if (error == OT_ERROR_NONE && max_age > 0) {
+        error = otCoapMessageAppendMaxAgeOption(response, max_age);
+    }
+    if (error == OT_ERROR_NONE && payload != NULL) {
+        error = otCoapMessageSetPayloadMarker(response);
+        if (error == OT_ERROR_NONE) {
+            error = otMessageAppend(response, payload, (uint16_t)strlen(payload));
+        }
+    }
+    if (error == OT_ERROR_NONE) {
+        error = otCoapSendResponse(instance, response, message_info);
+    }
+    if (error != OT_ERROR_NONE) {
+        LOG_WRN("[LATEST] Response not sent: %d", error);
+        otMessageFree(response);
+    }
+}
+
+/**
+ * @brief CoAP handler of "/latest" (OpenThread context).
+ */
+static void latest_request_handler(void *context, otMessage *request, const otMessageInfo *message_info) {
+    sample_msg_t sample;
+    health_msg_t health;
+    model_msg_t model;
+    uint8_t etag[LATEST_ETAG_LEN];
+    int64_t fleet_ms = 0;
+
+    if (otCoapMessageGetCode(request) != OT_COAP_CODE_GET) {
+        send_latest_response(request, message_info, OT_COAP_CODE_METHOD_NOT_ALLOWED, NULL, 0, NULL);
+        return;
+    }
+
+    // Cached state only: the services keep these channels up to date
+    if (zbus_chan_read(&sample_chan, &sample, LATEST_CHAN_TIMEOUT) != 0 || sample.timestamp_ms == 0 ||
+        zbus_chan_read(&health_chan, &health, LATEST_CHAN_TIMEOUT) != 0 ||
+        zbus_chan_read(&model_chan, &model, LATEST_CHAN_TIMEOUT) != 0) {
+        send_latest_response(request, message_info, OT_COAP_CODE_SERVICE_UNAVAILABLE, NULL,
+                             LATEST_NO_SAMPLE_MAX_AGE_S, NULL);
+        return;
+    }
+
+    msg_fleet_time(sample.timestamp_ms, &fleet_ms);
+    payload_encode_latest(latest_payload, sizeof(latest_payload), latest_room_name, sample.temperature,
+                          sample.humidity, model.mold_index, model.risk_confident, model.growing_condition,
+                          health.status[0], health.status[1], sample.is_simulated, fleet_ms);
+    sys_put_be32(crc32_ieee((const uint8_t *)latest_payload, strlen(latest_payload)), etag);
+
+    if (request_has_etag(request, etag)) {
+        not_modified++;
+        send_latest_response(request, message_info, OT_COAP_CODE_VALID, etag, max_age_s(&sample), NULL);
+    } else {
+        served++;
+        send_latest_response(request, message_info, OT_COAP_CODE_CONTENT, etag, max_age_s(&sample), latest_payload);
+    }
+    LOG_DBG("[LATEST] %u served, %u not modified", served, not_modified);
+}
+
+static otCoapResource m_latest_resource = {
+    .mUriPath = LATEST_URI_PATH,
+    .mHandler = latest_request_handler,
+    .mContext = NULL,
+    .mNext = NULL
+};
+
+void latest_resource_start(const char *room_name, uint32_t sample_period_ms) {
+    otInstance *instance = openthread_get_default_instance();
+
+    latest_room_name = room_name;
+    latest_period_ms = sample_period_ms;
+    m_latest_resource.mContext = instance;
+    otCoapAddResource(instance, &m_latest_resource);
+    LOG_INF("[LATEST] Serving GET /%s (Max-Age up to %u s)", LATEST_URI_PATH, sample_period_ms / 1000U);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file link_metrics.c
+ * @brief Implementation of the Mesh Link Metrics
+ */
+#include "link_metrics.h"
+#include <string.h>
+#if defined(CONFIG_NET_L2_OPENTHREAD)
+#include <openthread/thread.h>
+#include <openthread/link.h>
+#include <zephyr/net/openthread.h>
+#endif
+
+#if defined(CONFIG_NET_L2_OPENTHREAD)
+/**
+ * @brief MAC counters at the previous report (the counters only grow).
+ */
+typedef struct {
+    uint32_t tx;
+    uint32_t tx_retry;
+    uint32_t tx_err;
+    uint32_t rx;
+    uint32_t rx_err;
+} link_counters_t;
+
+// OWNED BY: the TX thread / TX work (only caller)
+static link_counters_t baseline;
+
+static void read_counters(otInstance *instance, link_counters_t *c) {
+    const otMacCounters *mac = otLinkGetCounters(instance);
+
+    c->tx = mac->mTxTotal;
+    c->tx_retry = mac->mTxRetry;
+    c->tx_err = mac->mTxDirectMaxRetryExpiry + mac->mTxIndirectMaxRetryExpiry + mac->mTxErrCca +
+                mac->mTxErrAbort + mac->mTxErrBusyChannel;
+    c->rx = mac->mRxTotal;
+    c->rx_err = mac->mRxErrNoFrame + mac->mRxErrFcs + mac->mRxErrSec + mac->mRxErrOther;
+}
+
+bool link_metrics_collect(link_metrics_t *metrics) {
+    otInstance *instance = openthread_get_default_instance();
+    otDeviceRole role = otThreadGetDeviceRole(instance);
+    otRouterInfo parent;
+    link_counters_t now;
+    int8_t rssi;
+
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->role = (uint8_t)role;
+    metrics->router_id = LINK_NO_ROUTER_ID;
+    metrics->parent_id = LINK_NO_ROUTER_ID;
+
+    if (role == OT_DEVICE_ROLE_ROUTER || role == OT_DEVICE_ROLE_LEADER) {
+        // RLOC16 = router ID << 10 | child ID
+        metrics->router_id = (uint8_t)(otThreadGetRloc16(instance) >> 10);
+    } else if (role == OT_DEVICE_ROLE_CHILD && otThreadGetParentInfo(instance, &parent) == OT_ERROR_NONE) {
+        metrics->parent_id = parent.mRouterId;
+        metrics->parent_lqi = parent.mLinkQualityIn;
+        if (otThreadGetParentAverageRssi(instance, &rssi) == OT_ERROR_NONE) {
+            metrics->parent_rssi = rssi;
+        }
+    }
+
+    read_counters(instance, &now);
+    metrics->tx = now.tx - baseline.tx;
+    metrics->tx_retry = now.tx_retry - baseline.tx_retry;
+    metrics->tx_err = now.tx_err - baseline.tx_err;
+    metrics->rx = now.rx - baseline.rx;
+    metrics->rx_err = now.rx_err - baseline.rx_err;
+    baseline = now;
+    return true;
+}
+
+#else
+
+bool link_metrics_collect(link_metrics_t *metrics) {
+    memset(metrics, 0, sizeof(*metrics));
+    return false;
+}
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * @file link_metrics.h
+ * @brief Mesh Link Metrics of the Sensor Node
+ * * A compact picture of the node's place in the Thread mesh, attached to
+ * every health report and heartbeat so the server can build the topology
+ * table (which router each room hangs off, and how well it hears it):
+ * - Device role and router IDs (own one for a router, the parent's for a child)
+ * - Parent link: average RSSI and link quality in (0-3)
+ * - MAC counters since the previous report: frames sent, retries, failed
+ *   sends (retries exhausted, CCA, abort), frames received, receive errors
+ * * Collected from the OpenThread API by the Messaging Service (the only
+ * OpenThread client of the node), at encode time.
+ */
+#ifndef LINK_METRICS_H
+#define LINK_METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LINK_NO_ROUTER_ID 0xFF      /**< No own router ID (child) or no parent (router) */
+
+/**
+ * @brief Link metrics of one health report.
+ */
+typedef struct {
+    uint8_t role;           /**< otDeviceRole: 0 disabled, 1 detached, 2 child, 3 router, 4 leader */
+    uint8_t router_id;      /**< Own router ID (router/leader), LINK_NO_ROUTER_ID otherwise */
+    uint8_t parent_id;      /**< Parent's router ID (child), LINK_NO_ROUTER_ID otherwise */
+    int8_t parent_rssi;     /**< Average RSSI of the parent's frames (dBm), 0 = unknown */
+    uint8_t parent_lqi;     /**< Link quality in from the parent (0-3) */
+    uint32_t tx;            /**< MAC frames sent since the previous report */
+    uint32_t tx_retry;      /**< Retransmissions since the previous report */
+    uint32_t tx_err;        /**< Sends that failed (retries exhausted, CCA, abort) */
+    uint32_t rx;            /**< MAC frames received since the previous report */
+    uint32_t rx_err;        /**< Frames dropped on reception (FCS, security, no frame, other) */
+} link_metrics_t;
+
+/**
+ * @brief Reads the current link metrics and restarts the counter deltas.
+ * * Call from the Messaging Service only (OpenThread API, counter baseline).
+ * @param[out] metrics Metrics since the previous call.
+ * @return false without OpenThread (loopback): nothing to report.
+ */
+bool link_metrics_collect(link_metrics_t *metrics);
+
+#endif
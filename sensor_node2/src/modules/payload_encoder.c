@@ -0,0 +1,137 @@
+/**
+ * @file payload_encoder.c
+ * @brief Implementation of the JSON Payload Encoders
+ */
+#include "payload_encoder.h"
+#include <stdio.h>
+
+// Note: We cast floats to (double) because standard snprintf implementation 
+// in some embedded C libraries (like Newlib) expects doubles for %f.
+// "ts" is printed as seconds + milliseconds: newlib-nano has no %lld.
+#define TS_SECONDS(ms) ((unsigned long)((ms) / 1000))
+#define TS_MILLIS(ms) ((unsigned int)((ms) % 1000))
+
+/**
+ * @brief Closes a payload written up to `len`: appends the "link" object (if any) and the final brace.
+ * Keeps the snprintf() contract, so a truncated payload still returns its full length.
+ */
+static int close_with_link(char *buf, size_t size, int len, const link_metrics_t *link) {
+    if (len < 0) {
+        return len;
+    }
+    size_t off = ((size_t)len < size) ? (size_t)len : size;
+    int extra;
+
+    if (link == NULL) {
+        extra = snprintf(buf + off, size - off, "}");
+    } else {
+        extra = snprintf(buf + off, size - off,
+                 ",\"link\":{\"role\":%u,\"rid\":%u,\"parent\":%u,\"rssi\":%d,\"lqi\":%u,\"tx\":%u,\"retry\":%u,\"tx_err\":%u,\"rx\":%u,\"rx_err\":%u}}",
+                 link->role,
+                 link->router_id,
+                 link->parent_id,
+                 link->parent_rssi,
+                 link->parent_lqi,
+                 (unsigned int)link->tx,
+                 (unsigned int)link->tx_retry,
+                 (unsigned int)link->tx_err,
+                 (unsigned int)link->rx,
+                 (unsigned int)link->rx_err);
+    }
+    return (extra < 0) ? extra : len + extra;
+}
+
+int payload_encode_mold_status(char *buf, size_t size, const char *message_type, const char *room_name,
+                               float temp_c, float rh_percent, float mold_index, int mold_risk_status,
+                               bool growth_status, bool is_simulation_node, int64_t fleet_ms) {
+    return snprintf(buf, size, 
+             "{\"message_type\":\"%s\",\"room_name\":\"%s\",\"temparature\":%.2f,\"humidity\":%.2f,\"mold_index\":%.2f,\"mold_risk_status\":%d,\"growth_status\":%d, \"is_simulated\":%d,\"ts\":%lu.%03u}", 
+             message_type, 
+             room_name, 
+             (double)temp_c, 
+             (double)rh_percent, 
+             (double)mold_index, 
+             mold_risk_status, 
+             (int)growth_status,
+             (int)is_simulation_node,
+             TS_SECONDS(fleet_ms),
+             TS_MILLIS(fleet_ms));
+}
+
+int payload_encode_health_status(char *buf, size_t size, const char *message_type, const char *room_name,
+                                 int sensor_1, int sensor_2, const link_metrics_t *link) {
+    int len = snprintf(buf, size, 
+             "{\"message_type\":\"%s\",\"room_name\":\"%s\",\"sensor_1_status\":%d,\"sensor_2_status\":%d", 
+             message_type, 
+             room_name, 
+             sensor_1, 
+             sensor_2);
+    return close_with_link(buf, size, len, link);
+}
+
+int payload_encode_health_heartbeat(char *buf, size_t size, const char *room_name, int sensor_1, int sensor_2,
+                                    const link_metrics_t *link) {
+    int len = snprintf(buf, size, 
+             "{\"message_type\":\"HB\",\"room_name\":\"%s\",\"s\":[%d,%d]", 
+             room_name, 
+             sensor_1, 
+             sensor_2);
+    return close_with_link(buf, size, len, link);
+}
+
+int payload_encode_condensation_alert(char *buf, size_t size, const char *message_type, const char *room_name,
+                                      int level, float temp_c, float rh_percent, float dew_point, float rh_slope,
+                                      int64_t fleet_ms) {
+    return snprintf(buf, size, 
+             "{\"message_type\":\"%s\",\"event\":\"condensation\",\"room_name\":\"%s\",\"level\":%d,\"temparature\":%.2f,\"humidity\":%.2f,\"dew_point\":%.2f,\"rh_slope\":%.2f,\"ts\":%lu.%03u}", 
+             message_type, 
+             room_name, 
+             level, 
+             (double)temp_c, 
+             (double)rh_percent, 
+             (double)dew_point, 
+             (double)rh_slope,
+             TS_SECONDS(fleet_ms),
+             TS_MILLIS(fleet_ms));
+}
+
+int payload_encode_simple_data(char *buf, size_t size, const char *message_type, const char *room_name,
+                               float temp_c, float rh_percent, bool is_simulation_node, int64_t fleet_ms) {
+    return snprintf(buf, size, 
+             "{\"message_type\":\"%s\",\"room_name\":\"%s\",\"temparature\":%.2f,\"humidity\":%.2f, \"is_simulated\":%d,\"ts\":%lu.%03u}", 
+             message_type, 
+             room_name, 
+             (double)temp_c, 
+             (double)rh_percent,
+             (int)is_simulation_node,
+             TS_SECONDS(fleet_ms),
+             TS_MILLIS(fleet_ms));
+}
+
+int payload_encode_latest(char *buf, size_t size, const char *room_name, float temp_c, float rh_percent,
+                          float mold_index, int mold_risk_status, bool growth_status, int sensor_1, int sensor_2,
+                          bool is_simulation_node, int64_t fleet_ms) {
+    return snprintf(buf, size, 
+             "{\"message_type\":\"LATEST\",\"room_name\":\"%s\",\"temparature\":%.2f,\"humidity\":%.2f,\"mold_index\":%.2f,\"mold_risk_status\":%d,\"growth_status\":%d,\"s\":[%d,%d], \"is_simulated\":%d,\"ts\":%lu.%03u}", 
+             room_name, 
+             (double)temp_c, 
+             (double)rh_percent, 
+             (double)mold_index, 
+             mold_risk_status, 
+             (int)growth_status,
+             sensor_1,
+             sensor_2,
+             (int)is_simulation_node,
+             TS_SECONDS(fleet_ms),
+             TS_MILLIS(fleet_ms));
+}
+
+int payload_encode_system_alert(char *buf, size_t size, const char *event, const char *room_name,
+                                int sensor_1, int sensor_2) {
+    return snprintf(buf, size, 
+             "{\"event\":\"%s\",\"room_name\":\"%s\",\"s1\":%d, \"s2\":%d}", 
+             event, 
+             room_name, 
+             sensor_1,
+             sensor_2);
+}
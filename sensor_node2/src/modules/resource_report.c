@@ -0,0 +1,77 @@
+/**
+ * @file resource_report.c
+ * @brief Implementation of the RAM and Scheduling Report
+ */
+#include "resource_report.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(resource_report, LOG_LEVEL_INF);
+
+#if defined(CONFIG_APP_RESOURCE_REPORT)
+
+/**
+ * @brief Running totals for one report.
+ */
+typedef struct {
+    size_t stack_reserved;
+    size_t stack_unused;
+    uint64_t switches;
+    int threads;
+} report_totals_t;
+
+static void report_thread(const struct k_thread *cthread, void *user_data)
+{
+    struct k_thread *thread = (struct k_thread *)cthread;
+    report_totals_t *totals = user_data;
+    k_thread_runtime_stats_t stats;
+    size_t unused = 0;
+    uint64_t switches = 0;
+    const char *name = k_thread_name_get(thread);
+
+    k_thread_stack_space_get(thread, &unused);
+
+    // average_cycles is execution time per scheduling window, so the
+    // number of windows (= times the thread was switched in) falls out.
+    if (k_thread_runtime_stats_get(thread, &stats) == 0 && stats.average_cycles > 0) {
+        switches = stats.total_cycles / stats.average_cycles;
+    }
+
+    LOG_INF("[RES] %-14s stack %5u B, unused %5u B, switched in %llu",
+            (name && name[0]) ? name : "?",
+            (unsigned int)thread->stack_info.size, (unsigned int)unused, switches);
+
+    totals->stack_reserved += thread->stack_info.size;
+    totals->stack_unused += unused;
+    totals->switches += switches;
+    totals->threads++;
+}
+
+static void resource_report_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(resource_report_work, resource_report_handler);
+
+static void resource_report_handler(struct k_work *work)
+{
+    report_totals_t totals = {0};
+
+    LOG_INF("[RES] --- Resource Report (%s model, uptime %lld s) ---",
+            IS_ENABLED(CONFIG_APP_WORKQUEUE_MODEL) ? "work queue" : "thread",
+            k_uptime_get() / 1000);
+    k_thread_foreach_unlocked(report_thread, &totals);
+    LOG_INF("[RES] %d threads, stacks %u B reserved / %u B unused, %llu switches",
+            totals.threads, (unsigned int)totals.stack_reserved,
+            (unsigned int)totals.stack_unused, totals.switches);
+
+    k_work_reschedule(&resource_report_work, K_SECONDS(CONFIG_APP_RESOURCE_REPORT_INTERVAL_S));
+}
+
+void resource_report_start(void)
+{
+    k_work_reschedule(&resource_report_work, K_SECONDS(CONFIG_APP_RESOURCE_REPORT_INTERVAL_S));
+}
+
+#else
+
+void resource_report_start(void) {}
+
+#endif
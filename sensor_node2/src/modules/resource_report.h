@@ -0,0 +1,19 @@
+/**
+ * @file resource_report.h
+ * @brief RAM and Scheduling Report (CONFIG_APP_RESOURCE_REPORT)
+ * * Periodically logs, for every thread:
+ * - Reserved and unused stack (bytes)
+ * - Number of times it was scheduled in (context switches into the thread)
+ * * Build once with and once without CONFIG_APP_WORKQUEUE_MODEL to compare
+ * the two execution models on the same workload.
+ */
+#ifndef RESOURCE_REPORT_H
+#define RESOURCE_REPORT_H
+
+/**
+ * @brief Starts the periodic report on the system work queue.
+ * No-op unless CONFIG_APP_RESOURCE_REPORT is enabled.
+ */
+void resource_report_start(void);
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * @file sensor_reliability.c
+ * @brief Implementation of the Sliding-Window Sensor Reliability
+ */
+#include "sensor_reliability.h"
+#include <string.h>
+
+void reliability_init(reliability_window_t *w) {
+    memset(w, 0, sizeof(*w));
+}
+
+void reliability_record(reliability_window_t *w, acq_outcome_t outcome) {
+    if (w->len == RELIABILITY_WINDOW) {
+        w->count[w->history[w->head]]--;
+    } else {
+        w->len++;
+    }
+    w->history[w->head] = (uint8_t)outcome;
+    w->count[outcome]++;
+    w->head = (w->head + 1) % RELIABILITY_WINDOW;
+}
+
+float reliability_rate(const reliability_window_t *w, acq_outcome_t outcome) {
+    if (w->len == 0) {
+        return 0.0f;
+    }
+    return (float)w->count[outcome] / w->len;
+}
+
+float reliability_score(const reliability_window_t *w) {
+    if (w->len == 0) {
+        return 1.0f;
+    }
+    return (w->count[ACQ_OK] + 0.5f * w->count[ACQ_BUSY]) / w->len;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file vtt_ensemble.c
+ * @brief Implementation of the VTT Model Ensemble
+ */
+#include "vtt_ensemble.h"
+#include <math.h>
+
+/**
+ * @brief Offsets {-1, 0, +1} x sigma for a grid axis of n points.
+ */
+static void fill_offsets(float *offset, int n, float sigma) {
+    for (int i = 0; i < n; i++) {
+        offset[i] = sigma * (2.0f * i / (n - 1) - 1.0f);
+    }
+}
+
+void vtt_ensemble_init(vtt_ensemble_t *ens, vtt_material_t mat, float temp_sigma, float humi_sigma) {
+    for (int m = 0; m < VTT_ENSEMBLE_SIZE; m++) {
+        vtt_init(&ens->member[m], mat);
+    }
+    fill_offsets(ens->temp_offset, VTT_ENSEMBLE_T_POINTS, temp_sigma);
+    fill_offsets(ens->humi_offset, VTT_ENSEMBLE_RH_POINTS, humi_sigma);
+}
+
+void vtt_ensemble_update(vtt_ensemble_t *ens, float temp_c, float rh_percent, float time_step_hours) {
+    vtt_temp_terms_t t[VTT_ENSEMBLE_T_POINTS];
+    vtt_rh_terms_t rh[VTT_ENSEMBLE_RH_POINTS];
+
+    // Transcendental terms once per row and column, not per member
+    for (int i = 0; i < VTT_ENSEMBLE_T_POINTS; i++) {
+        vtt_temp_terms(temp_c + ens->temp_offset[i], &t[i]);
+    }
+    for (int j = 0; j < VTT_ENSEMBLE_RH_POINTS; j++) {
+        vtt_rh_terms(rh_percent + ens->humi_offset[j], &rh[j]);
+    }
+
+    vtt_state_t *member = ens->member;
+    for (int i = 0; i < VTT_ENSEMBLE_T_POINTS; i++) {
+        for (int j = 0; j < VTT_ENSEMBLE_RH_POINTS; j++) {
+            vtt_step(member++, &t[i], &rh[j], time_step_hours);
+        }
+    }
+}
+
+/**
+ * @brief Maps a Mold Index to its risk level (same thresholds as vtt_get_risk_level()).
+ */
+static vtt_risk_level_t risk_of(float mold_index) {
+    vtt_state_t s = {.mold_index = mold_index};
+    return vtt_get_risk_level(&s);
+}
+
+void vtt_ensemble_report(const vtt_ensemble_t *ens, float confidence, vtt_ensemble_report_t *report) {
+    float sorted[VTT_ENSEMBLE_SIZE];
+    int growing = 0;
+
+    // Insertion sort, the ensemble is tiny
+    for (int m = 0; m < VTT_ENSEMBLE_SIZE; m++) {
+        float v = ens->member[m].mold_index;
+        int k = m;
+        while (k > 0 && sorted[k - 1] > v) {
+            sorted[k] = sorted[k - 1];
+            k--;
+        }
+        sorted[k] = v;
+        growing += ens->member[m].growing_condition ? 1 : 0;
+    }
+
+    report->index_median = sorted[VTT_ENSEMBLE_SIZE / 2];
+    report->index_low = sorted[0];
+    report->index_high = sorted[VTT_ENSEMBLE_SIZE - 1];
+    report->rh_crit = ens->member[VTT_ENSEMBLE_CENTER].rh_crit;
+    report->risk_median = risk_of(report->index_median);
+    report->risk_low = risk_of(report->index_low);
+    report->risk_high = risk_of(report->index_high);
+    report->growing_share = (float)growing / VTT_ENSEMBLE_SIZE;
+
+    // The level reached by ceil(confidence x N) members is that of the member at rank N - that count
+    int needed = (int)ceilf(confidence * VTT_ENSEMBLE_SIZE);
+    if (needed < 1) {
+        needed = 1;
+    } else if (needed > VTT_ENSEMBLE_SIZE) {
+        needed = VTT_ENSEMBLE_SIZE;
+    }
+    report->risk_confident = risk_of(sorted[VTT_ENSEMBLE_SIZE - needed]);
+
+    int at_or_above = 0;
+    for (int m = 0; m < VTT_ENSEMBLE_SIZE; m++) {
+        if (risk_of(sorted[m]) >= report->risk_median) {
+            at_or_above++;
+        }
+    }
+    report->risk_confidence = (float)at_or_above / VTT_ENSEMBLE_SIZE;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file vtt_ensemble.h
+ * @brief VTT Model Ensemble for Sensor Uncertainty
+ * * A single vtt_state_t turns every reading into one Mold Index, as if the
+ * sensor were exact. The DHT20 is only accurate to about +-0.3 C and +-3 %RH,
+ * and the model is very sensitive to RH around RH_crit.
+ * * The ensemble runs VTT_ENSEMBLE_SIZE states from the same sample stream, each
+ * one with a fixed input offset on a 3 x 3 grid over {-1, 0, +1} x the sensor
+ * error (the calibration error of a sensor is a bias, so a member keeps its
+ * offset). The step is batched: the logarithms and exponentials are computed
+ * once per Temperature row and once per RH column (6 instead of 9), and
+ * only the integration runs per member: about half the cost of 9 separate
+ * vtt_update() calls.
+ * * The report gives the median and the band (lowest/highest member) of the
+ * index and the risk level, and the risk level that a given share of the
+ * members agrees on, so alerts can be gated on confidence.
+ */
+#ifndef VTT_ENSEMBLE_H
+#define VTT_ENSEMBLE_H
+
+#include "vtt_model.h"
+#include <stdint.h>
+
+#define VTT_ENSEMBLE_T_POINTS   3   /**< Temperature offsets per member grid row */
+#define VTT_ENSEMBLE_RH_POINTS  3   /**< RH offsets per member grid column */
+#define VTT_ENSEMBLE_SIZE       (VTT_ENSEMBLE_T_POINTS * VTT_ENSEMBLE_RH_POINTS)
+
+/** @brief Index of the member without offsets (the measured input). */
+#define VTT_ENSEMBLE_CENTER     ((VTT_ENSEMBLE_T_POINTS / 2) * VTT_ENSEMBLE_RH_POINTS + VTT_ENSEMBLE_RH_POINTS / 2)
+
+/**
+ * @brief Typical DHT20 accuracy, used as the member offset step.
+ */
+#define VTT_ENSEMBLE_SIGMA_TEMP 0.3f
+#define VTT_ENSEMBLE_SIGMA_HUMI 3.0f
+
+/**
+ * @brief Ensemble context. Member m uses T offset m / RH_POINTS and RH offset m % RH_POINTS.
+ */
+typedef struct {
+    vtt_state_t member[VTT_ENSEMBLE_SIZE];
+    float temp_offset[VTT_ENSEMBLE_T_POINTS];   /**< Temperature offset per grid row (C) */
+    float humi_offset[VTT_ENSEMBLE_RH_POINTS];  /**< RH offset per grid column (%) */
+} vtt_ensemble_t;
+
+/**
+ * @brief Summary of the members after a step.
+ */
+typedef struct {
+    float index_median;             /**< Median Mold Index */
+    float index_low;                /**< Lowest member Mold Index */
+    float index_high;               /**< Highest member Mold Index */
+    float rh_crit;                  /**< RH_crit of the unperturbed member */
+    vtt_risk_level_t risk_median;   /**< Risk level of the median index */
+    vtt_risk_level_t risk_low;      /**< Risk level of the lowest index */
+    vtt_risk_level_t risk_high;     /**< Risk level of the highest index */
+    vtt_risk_level_t risk_confident;/**< Highest risk level reached by the requested share of members */
+    float risk_confidence;          /**< Share of members at or above risk_median */
+    float growing_share;            /**< Share of members in the Growth Phase */
+} vtt_ensemble_report_t;
+
+/**
+ * @brief Initialize all members for one material.
+ * @param ens Ensemble to initialize.
+ * @param mat Material class.
+ * @param temp_sigma Temperature offset step (C), e.g. VTT_ENSEMBLE_SIGMA_TEMP.
+ * @param humi_sigma RH offset step (%), e.g. VTT_ENSEMBLE_SIGMA_HUMI.
+ */
+void vtt_ensemble_init(vtt_ensemble_t *ens, vtt_material_t mat, float temp_sigma, float humi_sigma);
+
+/**
+ * @brief Step every member with the same reading plus its offset (batched).
+ * @param ens Ensemble.
+ * @param temp_c Measured Temperature (Celsius).
+ * @param rh_percent Measured Relative Humidity (%).
+ * @param time_step_hours Time elapsed since last call.
+ */
+void vtt_ensemble_update(vtt_ensemble_t *ens, float temp_c, float rh_percent, float time_step_hours);
+
+/**
+ * @brief Summarize the members.
+ * @param ens Ensemble.
+ * @param confidence Share of members (0.0 to 1.0) that must reach a level for risk_confident.
+ * @param[out] report Median, band and confident risk.
+ */
+void vtt_ensemble_report(const vtt_ensemble_t *ens, float confidence, vtt_ensemble_report_t *report);
+
+#endif
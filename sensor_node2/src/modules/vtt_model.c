@@ -27,6 +27,9 @@
 // Baseline constant for Critical RH at warm temperatures (>20C)
 #define RH_CRIT_MIN_WARM    80.0f
 
+// M - M_max below which the saturation factor k2 is 1.0 (exp(2.3 * -5) < 1e-5)
+#define K2_SATURATION_SKIP  -5.0f
+
 // --- Helper Functions (Private) ---
 
 /**
@@ -56,33 +59,34 @@ static float get_material_k1(vtt_material_t mat){
 }
 
 /**
- * @brief Calculates the Critical Humidity (RH_crit) required for mold to start growing.
- * Formula depends on current temperature.
- * * @param ctx Context (stores result in ctx->rh_crit)
- * @param T Temperature in Celsius
+ * @brief Calculates the Critical Humidity (RH_crit) required for mold to start growing,
+ * before the material offset. Formula depends on current temperature.
+ * * @param T Temperature in Celsius
  */
-static void calculate_rh_critical(vtt_state_t *ctx, float T){
+static float calculate_rh_critical_base(float T){
     if (T > 20){
         // For warm temps, the baseline is constant
-        ctx->rh_crit = RH_CRIT_MIN_WARM + ctx->rh_mat;
-    } else {
-        // Polynomial approximation for cooler temps (VTT equation)
-        // RH_crit rises as temperature drops (harder for mold to grow in cold)
-        float t2 = T * T;
-        float t3 = t2 * T;
-        float rh_base = (-0.00267f * t3) + (0.160f * t2) - (3.13f * T) + 100.0f;
-        ctx->rh_crit = rh_base + ctx->rh_mat;
+        return RH_CRIT_MIN_WARM;
     }
+    // Polynomial approximation for cooler temps (VTT equation)
+    // RH_crit rises as temperature drops (harder for mold to grow in cold)
+    float t2 = T * T;
+    float t3 = t2 * T;
+    return (-0.00267f * t3) + (0.160f * t2) - (3.13f * T) + 100.0f;
 }
 
 // --- Public API Implementation ---
 
+float vtt_rh_critical(const vtt_state_t *ctx, float temp_c){
+    return calculate_rh_critical_base(clampf(temp_c, 0.1f, 60.0f)) + ctx->rh_mat;
+}
+
 void vtt_init(vtt_state_t *ctx, vtt_material_t mat){
     memset(ctx, 0, sizeof(vtt_state_t));
     ctx -> material = mat;
     ctx -> mold_index = 0.0f;
 
-    // TODO: Decide SQ, W, rh_mat Values - rh_mat values are dummy, will confirm the correct values afterwards
+    // TODO: Decide SQ, W Values. rh_mat values come from VTT_RH_MAT_* (fit them with tools/vtt_calibrate)
     // Set material specific coefficients (SQ, W, rh_mat)
     // These tune the sensitivity of the differential equations
     switch (mat)
@@ -90,19 +94,19 @@ void vtt_init(vtt_state_t *ctx, vtt_material_t mat){
     case VTT_MAT_SENSITIVE:
         ctx->surface_quality = 0.0f; // Rough (easier for spores)
         ctx->wood_species = 0.0f;    // Pine (nutrient rich)
-        ctx->rh_mat = 0.0f;          // No extra resistance
+        ctx->rh_mat = VTT_RH_MAT_SENSITIVE;
         break;
 
     case VTT_MAT_MEDIUM_RESISTANT:
         ctx->surface_quality = 0.0f; // Smoother
         ctx->wood_species = 1.0f;
-        ctx->rh_mat = 0.0f;          // No extra resistance
+        ctx->rh_mat = VTT_RH_MAT_MEDIUM_RESISTANT;
         break;
 
     case VTT_MAT_RESISTANT:
         ctx-> surface_quality = 1.0f;
         ctx-> wood_species = 1.0f;
-        ctx-> rh_mat = 5.0f;
+        ctx-> rh_mat = VTT_RH_MAT_RESISTANT;
         break;
 
     default: // Fail-safe defaults (Worst Case)
@@ -111,16 +115,41 @@ void vtt_init(vtt_state_t *ctx, vtt_material_t mat){
         ctx-> rh_mat = 0.0f;
         break;
     }
+
+    ctx->decline_rate_short = VTT_DECLINE_RATE_SHORT;
+    ctx->decline_rate_long = VTT_DECLINE_RATE_LONG;
+
+    // Material part of the growth exponent: exp(-(0.14 W - 0.33 SQ))
+    ctx->growth_scale = expf((0.33f * ctx->surface_quality) - (0.14f * ctx->wood_species));
+}
+
+void vtt_temp_terms(float temp_c, vtt_temp_terms_t *out){
+    float safe_t = clampf(temp_c, 0.1f, 60.0f);
+    out->rh_crit_base = calculate_rh_critical_base(safe_t);
+    out->growth_t = expf(0.68f * logf(safe_t));
+}
+
+void vtt_rh_terms(float rh_percent, vtt_rh_terms_t *out){
+    out->rh = clampf(rh_percent, 1.0f, 100.0f);
+    out->growth_rh = expf((13.9f * logf(out->rh)) - 66.02f) / 7.0f;
 }
 
 void vtt_update(vtt_state_t *ctx, float temp_c, float rh_percent, float time_step_hours){
+    vtt_temp_terms_t t;
+    vtt_rh_terms_t rh;
 
-    // 1. Sanitize Inputs (Prevent math errors)
-    float safe_t = clampf(temp_c, 0.1f, 60.0f); 
-    float safe_rh = clampf(rh_percent, 1.0f, 100.0f);
+    // 1. Sanitize Inputs and precompute the input terms
+    vtt_temp_terms(temp_c, &t);
+    vtt_rh_terms(rh_percent, &rh);
+
+    vtt_step(ctx, &t, &rh, time_step_hours);
+}
+
+void vtt_step(vtt_state_t *ctx, const vtt_temp_terms_t *t, const vtt_rh_terms_t *rh, float time_step_hours){
+    float safe_rh = rh->rh;
 
     // 2. Determine if conditions allow growth
-    calculate_rh_critical(ctx,safe_t);
+    ctx->rh_crit = t->rh_crit_base + ctx->rh_mat;
 
     if (safe_rh > ctx->rh_crit){
         // --- GROWTH PHASE (Wet) ---
@@ -134,9 +163,9 @@ void vtt_update(vtt_state_t *ctx, float temp_c, float rh_percent, float time_ste
         ctx -> max_possible_index = clampf(m_max_calc, 0.0f, 6.0f);
 
         // Step B: Calculate Base Growth Speed (Polynomial Regression)
-
-        float exponent = (-0.68f * logf(safe_t)) - (13.9f * logf(safe_rh)) + (0.14f * ctx->wood_species) - (0.33f * ctx->surface_quality) + 66.02f;
-        float base_growth_rate = 1.0f / (7.0f * expf(exponent));
+        // 1 / (7 exp(-0.68 ln T - 13.9 ln RH + 0.14 W - 0.33 SQ + 66.02)), factored
+        // into the Temperature, RH and material terms
+        float base_growth_rate = t->growth_t * rh->growth_rh * ctx->growth_scale;
 
         // Step C: Apply Intensity Scaling (k1) and Saturation (k2)
         // Growth slows down as it approaches the max possible index (k2 factor)
@@ -144,12 +173,13 @@ void vtt_update(vtt_state_t *ctx, float temp_c, float rh_percent, float time_ste
         float dist_to_max = ctx->mold_index - ctx->max_possible_index;
 
         // k2 = max(1 - exp(2.3 * (M - M_max)), 0)
-        float k2 = fmaxf(1.0f - expf(2.3f * dist_to_max), 0.0f); 
+        // Far below M_max the exponential is < 1e-5, skip it
+        float k2 = (dist_to_max < K2_SATURATION_SKIP) ? 1.0f : fmaxf(1.0f - expf(2.3f * dist_to_max), 0.0f);
 
         // Step D: Integrate (Euler Method)
         float dM = k1 * k2 * base_growth_rate * time_step_hours;
         ctx->mold_index += dM;
-        ctx->last_growth_rate = dM / time_step_hours;
+        ctx->last_growth_rate = (time_step_hours > 0.0f) ? dM / time_step_hours : 0.0f;
     } else {
         // --- DECLINE PHASE (Dry) ---
         ctx -> time_dry_hours += time_step_hours;
@@ -161,17 +191,17 @@ void vtt_update(vtt_state_t *ctx, float temp_c, float rh_percent, float time_ste
         // Step A: Determine Decline Rate based on Dry Duration
         // Short dry spells cause slow decline; long spells kill spores faster.
         if (ctx->time_dry_hours <= 6.0f){
-            decline_rate = -0.00133f; //Initial resistance (Latency)
+            decline_rate = ctx->decline_rate_short; //Initial resistance (Latency)
         } else if (ctx->time_dry_hours <= 24.0f) { 
             decline_rate = 0.0f; // Stability period
         } else {
-            decline_rate = -0.000667f; // Long-term die-off
+            decline_rate = ctx->decline_rate_long; // Long-term die-off
         }
 
         // Step B: Integrate
         float dM = decline_rate * time_step_hours;
         ctx -> mold_index += dM;
-        ctx -> last_growth_rate = dM / time_step_hours; 
+        ctx -> last_growth_rate = (time_step_hours > 0.0f) ? dM / time_step_hours : 0.0f;
     }
     // 3. Final Clamp (Index cannot be negative or exceed 6.0)
     ctx -> mold_index = clampf(ctx->mold_index, MIN_INDEX_CAP, MAX_INDEX_CAP);
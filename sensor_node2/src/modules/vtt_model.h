@@ -56,6 +56,29 @@ typedef enum {
 } vtt_risk_level_t;
 
 
+// --- Calibration Constants ---
+
+/**
+ * @brief Parameters fitted by tools/vtt_calibrate (paste its output here).
+ * Decline rates are dM/dt (1/h) in the first 6 dry hours and after 24 dry
+ * hours, rh_mat is the offset of RH_crit (%) per material class.
+ */
+#ifndef VTT_DECLINE_RATE_SHORT
+#define VTT_DECLINE_RATE_SHORT          -0.00133f
+#endif
+#ifndef VTT_DECLINE_RATE_LONG
+#define VTT_DECLINE_RATE_LONG           -0.000667f
+#endif
+#ifndef VTT_RH_MAT_SENSITIVE
+#define VTT_RH_MAT_SENSITIVE            0.0f
+#endif
+#ifndef VTT_RH_MAT_MEDIUM_RESISTANT
+#define VTT_RH_MAT_MEDIUM_RESISTANT     0.0f
+#endif
+#ifndef VTT_RH_MAT_RESISTANT
+#define VTT_RH_MAT_RESISTANT            5.0f
+#endif
+
 // --- State Object ---
 
 /**
@@ -69,6 +92,9 @@ typedef struct {
     float surface_quality;      /**< SQ Factor: 0 (rough) to 1 (smooth) */
     float wood_species;         /**< W Factor: 0 (pine) to 1 (spruce) */
     float rh_mat;               /**< Material specific offset for RH_crit */
+    float growth_scale;         /**< Material factor of the growth rate, exp(0.33 SQ - 0.14 W) */
+    float decline_rate_short;   /**< dM/dt in the first 6 dry hours (VTT_DECLINE_RATE_SHORT) */
+    float decline_rate_long;    /**< dM/dt after 24 dry hours (VTT_DECLINE_RATE_LONG) */
 
     // --- Dynamic State (Updated every Step) ---
     bool growing_condition;     /**< True if currently in Growth Phase, False if Decline */
@@ -84,6 +110,24 @@ typedef struct {
 
 } vtt_state_t;
 
+/**
+ * @brief Temperature dependent terms of one step.
+ * Shared by every state fed the same Temperature (see vtt_ensemble.h).
+ */
+typedef struct {
+    float rh_crit_base;         /**< RH_crit before the material offset (%) */
+    float growth_t;             /**< Temperature factor of the growth rate, T^0.68 */
+} vtt_temp_terms_t;
+
+/**
+ * @brief Humidity dependent terms of one step.
+ * Shared by every state fed the same Relative Humidity.
+ */
+typedef struct {
+    float rh;                   /**< Sanitized Relative Humidity (%) */
+    float growth_rh;            /**< Humidity factor of the growth rate, RH^13.9 / (7 e^66.02) */
+} vtt_rh_terms_t;
+
 // --- Public API ---
 
 /**
@@ -100,10 +144,44 @@ void vtt_init (vtt_state_t *ctx, vtt_material_t mat);
  * * @param ctx Pointer to the state object.
  * @param temp_c Current Temperature (Celsius).
  * @param rh_percent Current Relative Humidity (%).
- * @param time_step_hours Time elapsed since last call (e.g., 0.25 for 15 mins).
+ * @param time_step_hours Time elapsed since last call (e.g., 0.25 for 15 mins), 0 only updates the phase.
  */
 void vtt_update(vtt_state_t *ctx, float temp_c, float rh_percent, float time_step_hours);
 
+/**
+ * @brief Critical Humidity of a state at a Temperature, without stepping.
+ * Lets a sample watcher tell growth from decline conditions cheaply.
+ * @param ctx Pointer to the state object (material offset).
+ * @param temp_c Temperature (Celsius).
+ * @return RH_crit (%).
+ */
+float vtt_rh_critical(const vtt_state_t *ctx, float temp_c);
+
+/**
+ * @brief Precompute the Temperature terms of a step (sanitizes the input).
+ * @param temp_c Temperature (Celsius).
+ * @param[out] out Terms for vtt_step().
+ */
+void vtt_temp_terms(float temp_c, vtt_temp_terms_t *out);
+
+/**
+ * @brief Precompute the Humidity terms of a step (sanitizes the input).
+ * @param rh_percent Relative Humidity (%).
+ * @param[out] out Terms for vtt_step().
+ */
+void vtt_rh_terms(float rh_percent, vtt_rh_terms_t *out);
+
+/**
+ * @brief Solve one time step from precomputed input terms.
+ * vtt_update() is vtt_temp_terms() + vtt_rh_terms() + vtt_step(); the split
+ * lets several states share the logarithms and exponentials of one input.
+ * * @param ctx Pointer to the state object.
+ * @param t Temperature terms.
+ * @param rh Humidity terms.
+ * @param time_step_hours Time elapsed since last call.
+ */
+void vtt_step(vtt_state_t *ctx, const vtt_temp_terms_t *t, const vtt_rh_terms_t *rh, float time_step_hours);
+
 /**
  * @brief Get the simplified user-facing risk level.
  * * @param ctx Pointer to the state object.
@@ -0,0 +1,40 @@
+/**
+ * @file weather_replay.h
+ * @brief Trace-Driven Weather Source for the Simulation Node
+ * * Replays a recorded climate trace (.wtr, see tools/weather_replay) as if it
+ * came from the sensors. The trace is embedded at build time from
+ * CONFIG_APP_WEATHER_TRACE_FILE (CSV files are converted on the fly). On
+ * native_sim a trace on the host can be given with `-weather-trace=<file>`.
+ * * Trace time runs CONFIG_APP_WEATHER_REPLAY_SPEEDUP times faster than the
+ * uptime and loops at the end of the trace. Values between two trace samples
+ * are interpolated linearly.
+ * * weather_replay_read() only reads constant data and the uptime, so any
+ * thread may call it without a lock.
+ */
+#ifndef WEATHER_REPLAY_H
+#define WEATHER_REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Selects and validates the trace (host file on native_sim, else the embedded one).
+ * @return 0 on success, -EINVAL if the trace is malformed.
+ */
+int weather_replay_init(void);
+
+/**
+ * @brief Reads the trace at the current (compressed) trace time.
+ * * Same contract as get_sensor_data(): fills both values and returns true,
+ * or returns false if no valid trace is loaded.
+ * @param[out] temperature Temperature (Celsius)
+ * @param[out] humidity    Relative Humidity (%)
+ */
+bool weather_replay_read(float *temperature, float *humidity);
+
+/**
+ * @brief Current trace time in hours (for logs and the VTT time step).
+ */
+float weather_replay_hours(void);
+
+#endif
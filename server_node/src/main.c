@@ -3,9 +3,11 @@
  * @brief Server Node Entry Point (Orchestrator).
  *
  * This file sets up the RTOS environment. It:
- * 1. Defines the shared Message Queue used for inter-thread communication.
+ * 1. Defines the Message Bus that carries data from the producers to the sinks.
  * 2. Spawns the High-Priority Network Thread (Listener).
  * 3. Spawns the Low-Priority Node Manager Thread (Watchdog).
+ * With CONFIG_APP_WORKQUEUE_MODEL the Node Manager and the Serial Bridge run
+ * as work items on one shared work queue instead (see overlay-workqueue.conf).
  * @authors: muzamil.py, Google Gemini 3 Pro
  * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
  */
@@ -19,10 +21,15 @@
 #include "serial_bridge.h"
 #include "node_manager.h"
 #include "shared_types.h"
+#include "app_workqueue.h"
+#include "resource_report.h"
+#include "time_beacon.h"
+#include "message_bus.h"
 
 // --- Configuration ---
 #define NETWORK_STACKSIZE 2048  
 #define MANAGER_STACKSIZE 1024  
+#define MANAGER_PERIOD_MS 5000
 
 // --- Thread Priorities ---
 // Lower number = Higher priority
@@ -33,15 +40,44 @@ LOG_MODULE_REGISTER(server_main, LOG_LEVEL_INF);
 
 // --- Shared Resources ---
 /**
- * @brief The Central Message Queue.
- * Acts as a buffer between the Network Listener (Producer) and the 
- * Serial Bridge (Consumer).
- * - Item Size: sizeof(server_message_t)
- * - Capacity: 10 messages
- * - Alignment: 4 bytes
+ * @brief The Central Message Bus.
+ * Fans the messages of the producers (Network Listener, Node Manager, Time
+ * Beacon) out to every sink (Serial Bridge, ...), each message stored once.
+ * - Slot Size: sizeof(message_bus_slot_t)
+ * - Capacity: CONFIG_APP_MESSAGE_BUS_SLOTS messages, shared by all sinks
  */
-K_MSGQ_DEFINE(server_queue, sizeof(server_message_t), 10, 4);
+MESSAGE_BUS_DEFINE(server_bus, CONFIG_APP_MESSAGE_BUS_SLOTS);
 
+/**
+ * @brief One Node Manager iteration: run the Attendance Check and the topology report.
+ */
+static void node_manager_run(void){
+    node_manager_check_timeout(&server_bus);
+    node_manager_report_topology(&server_bus);
+}
+
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+static periodic_service_t node_manager_svc = {.run = node_manager_run, .period_ms = MANAGER_PERIOD_MS};
+
+int main(void) {
+    app_workqueue_start();
+
+    // 1. Sinks first, then the producers: the bus does not lock its sink list.
+    //    CoAP handlers run in the OpenThread context, so no dedicated
+    //    Network thread is needed here.
+    serial_bridge_init(&server_bus);
+    LOG_INF("Starting Network Listener...");
+    network_listener_init(&server_bus);
+    time_beacon_start(&server_bus);
+
+    // 2. Node Manager (first check after 15s: 5s start delay + 10s settle time)
+    app_workqueue_schedule(&node_manager_svc, K_SECONDS(15));
+
+    resource_report_start();
+    return 0;
+}
+
+#else
 // --- Thread Definitions ---
 struct k_thread network_thread_data;
 struct k_thread node_manager_data;
@@ -56,12 +92,15 @@ K_THREAD_STACK_DEFINE(node_manager_thread_stack, MANAGER_STACKSIZE);
 void network_thread_entrypoint(void *p1, void *p2, void *p3){
 	LOG_INF("Starting Network Listener...");
 
-	// 1. Initialize the Network (Producer)
-    network_listener_init(&server_queue);
-
-    // 2. Initialize the Serial Bridge (Consumer)
+	// 1. Initialize the Serial Bridge (Sink) before any producer publishes
     // This spawns its own internal thread to handle UART output.
-    serial_bridge_init(&server_queue);
+    serial_bridge_init(&server_bus);
+
+    // 2. Initialize the Network (Producer)
+    network_listener_init(&server_bus);
+
+    // 3. Fleet clock for the sensor nodes (system work queue)
+    time_beacon_start(&server_bus);
 
 	// Thread yields forever (logic is handled by callbacks/interrupts)
     while (1) {
@@ -82,10 +121,10 @@ void node_manager_thread_entrypoint(void *p1, void *p2, void *p3){
 	while (1)
 	{   
         // Run the Attendance Check
-        node_manager_check_timeout(&server_queue);
+        node_manager_run();
         
         // Sleep until next check interval (e.g., 5 seconds)
-        k_msleep(5000); 
+        k_msleep(MANAGER_PERIOD_MS); 
 	}
 	
 }
@@ -93,9 +132,14 @@ void node_manager_thread_entrypoint(void *p1, void *p2, void *p3){
 int main(void) {
 	// 1. Spawn Network Thread (High Priority)
 	k_thread_create(&network_thread_data, network_thread_stack, K_THREAD_STACK_SIZEOF(network_thread_stack), network_thread_entrypoint, NULL,NULL,NULL, 1, 0, K_NO_WAIT);
+	k_thread_name_set(&network_thread_data, "network");
 
 	// 2. Spawn Node Manager Thread (Low Priority)
     // Delayed start (5s) to let the network initialize first
 	k_thread_create(&node_manager_data, node_manager_thread_stack, K_THREAD_STACK_SIZEOF(node_manager_thread_stack), node_manager_thread_entrypoint, NULL,NULL,NULL, 7, 0, K_SECONDS(5));
+	k_thread_name_set(&node_manager_data, "node_manager");
+
+	resource_report_start();
 	return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
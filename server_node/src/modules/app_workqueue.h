@@ -0,0 +1,40 @@
+/**
+ * @file app_workqueue.h
+ * @brief Shared Application Work Queue (CONFIG_APP_WORKQUEUE_MODEL)
+ * * In the work queue execution model the Node Manager is a periodic_service_t
+ * scheduled on app_work_q and the Serial Bridge is a triggered work item on
+ * the same queue.
+ */
+#ifndef APP_WORKQUEUE_H
+#define APP_WORKQUEUE_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+
+/**
+ * @brief A service that runs one iteration every period_ms.
+ */
+typedef struct {
+    struct k_work_delayable work;   /**< Used only in the work queue model */
+    void (*run)(void);              /**< One iteration of the service */
+    int32_t period_ms;              /**< Delay between two iterations */
+} periodic_service_t;
+
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+/** @brief The single application work queue. */
+extern struct k_work_q app_work_q;
+
+/**
+ * @brief Starts app_work_q. Must be called before scheduling any service.
+ */
+void app_workqueue_start(void);
+
+/**
+ * @brief Schedules a periodic service on app_work_q.
+ * @param svc   Service descriptor (must stay valid forever).
+ * @param delay Delay before the first iteration.
+ */
+void app_workqueue_schedule(periodic_service_t *svc, k_timeout_t delay);
+#endif
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file message_bus.c
+ * @brief Implementation of the Reference-Counted Message Fan-Out
+ */
+#include "message_bus.h"
+#include <zephyr/logging/log.h>
+#include <errno.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(message_bus, LOG_LEVEL_INF);
+
+int message_bus_subscribe(message_bus_t *bus, message_sink_t *sink) {
+    if (bus->sink_count >= MESSAGE_BUS_MAX_SINKS) {
+        LOG_ERR("[BUS] No room for sink %s", sink->name);
+        return -ENOMEM;
+    }
+    bus->sinks[bus->sink_count++] = sink;
+    bus->sink_slots += sink->queue->max_msgs + 1;
+
+    if (bus->sink_slots >= bus->slots) {
+        // The producers need a free slot even when every sink is backed up
+        LOG_WRN("[BUS] Sinks can hold %u slots, pool has %u: a stalled sink can starve the others",
+                bus->sink_slots, bus->slots);
+    }
+    LOG_INF("[BUS] Sink %s subscribed (depth %u, drop %s)", sink->name, sink->queue->max_msgs,
+            sink->policy == MESSAGE_SINK_DROP_OLDEST ? "oldest" : "newest");
+    return 0;
+}
+
+/**
+ * @brief Queues one reference for a sink, applying its overflow policy.
+ * @return true if the sink holds the message.
+ */
+static bool sink_offer(message_sink_t *sink, message_bus_slot_t *slot) {
+    const server_message_t *msg = &slot->msg;
+    const server_message_t *oldest;
+
+    // Count the reference first: the sink may release it before put returns
+    atomic_inc(&slot->refs);
+    if (k_msgq_put(sink->queue, &msg, K_NO_WAIT) == 0) {
+        atomic_inc(&sink->delivered);
+        return true;
+    }
+
+    if (sink->policy == MESSAGE_SINK_DROP_OLDEST && k_msgq_get(sink->queue, &oldest, K_NO_WAIT) == 0) {
+        message_bus_release(oldest);
+        atomic_inc(&sink->dropped);
+        LOG_WRN("[BUS] Sink %s full! Dropping its oldest message", sink->name);
+        if (k_msgq_put(sink->queue, &msg, K_NO_WAIT) == 0) {
+            atomic_inc(&sink->delivered);
+            return true;
+        }
+    }
+
+    atomic_dec(&slot->refs);
+    atomic_inc(&sink->dropped);
+    LOG_WRN("[BUS] Sink %s full! Dropping message from %s", sink->name, msg->source_ip);
+    return false;
+}
+
+int message_bus_publish(message_bus_t *bus, const server_message_t *msg) {
+    message_bus_slot_t *slot;
+    k_spinlock_key_t key;
+    bool taken = false;
+
+    if (k_mem_slab_alloc(bus->pool, (void **)&slot, K_NO_WAIT) != 0) {
+        atomic_inc(&bus->no_slot);
+        return -ENOMEM;
+    }
+    // The publisher holds one reference while it fans out
+    atomic_set(&slot->refs, 1);
+    slot->pool = bus->pool;
+    memcpy(&slot->msg, msg, sizeof(slot->msg));
+
+    // Numbering and queueing under one lock: concurrent producers cannot
+    // interleave, so every sink sees the messages in sequence order
+    key = k_spin_lock(&bus->lock);
+    slot->seq = (uint32_t)atomic_inc(&bus->published) + 1;
+    for (uint8_t i = 0; i < bus->sink_count; i++) {
+        taken |= sink_offer(bus->sinks[i], slot);
+    }
+    k_spin_unlock(&bus->lock, key);
+    message_bus_release(&slot->msg);
+    return taken ? 0 : -ENOSPC;
+}
+
+const server_message_t *message_bus_get(message_sink_t *sink, k_timeout_t timeout) {
+    const server_message_t *msg;
+
+    if (k_msgq_get(sink->queue, &msg, timeout) != 0) {
+        return NULL;
+    }
+    return msg;
+}
+
+void message_bus_release(const server_message_t *msg) {
+    message_bus_slot_t *slot = CONTAINER_OF(msg, message_bus_slot_t, msg);
+
+    // atomic_dec returns the previous value
+    if (atomic_dec(&slot->refs) == 1) {
+        k_mem_slab_free(slot->pool, slot);
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * @file message_bus.h
+ * @brief Reference-Counted Message Fan-Out (replaces the single-consumer server_queue)
+ * * Producers (CoAP handlers, Node Manager, Time Beacon) publish a
+ * server_message_t once. It is copied into a slot of the bus pool, and each
+ * subscribed sink receives a pointer to that slot in its own queue (its
+ * cursor). The slot goes back to the pool when the last sink releases it,
+ * so a message is stored once however many sinks read it.
+ * * Publishing never waits: when a sink's queue is full, the sink's overflow
+ * policy decides what it loses, and the other sinks are not affected.
+ * - MESSAGE_SINK_DROP_NEWEST: keep the backlog, the new message is not
+ *   queued for this sink (e.g. a spool that must keep the oldest data).
+ * - MESSAGE_SINK_DROP_OLDEST: release the oldest queued message to make
+ *   room (e.g. the UART bridge, where the newest data matters most).
+ * * Pool sizing: every sink can hold (depth + 1) slots (its queue and the
+ * message it is processing), so CONFIG_APP_MESSAGE_BUS_SLOTS must cover the
+ * sum over the sinks plus one per concurrent producer; otherwise a stalled
+ * sink could starve the pool. message_bus_subscribe() warns when it does not.
+ * * Consumer pattern:
+ *   const server_message_t *msg = message_bus_get(&sink, K_FOREVER);
+ *   ...use msg...
+ *   message_bus_release(msg);
+ * * Every message gets a sequence number when it is published, and the
+ * sinks receive the messages in that order, so consumers that share the
+ * messages between them (the UART bridge and its flash spool) can agree on
+ * who owns which one (message_bus_seq()).
+ * * The sink queue is a plain k_msgq of pointers, so a work item can
+ * k_poll() it (K_POLL_TYPE_MSGQ_DATA_AVAILABLE) like the old server_queue.
+ */
+#ifndef MESSAGE_BUS_H
+#define MESSAGE_BUS_H
+
+#include <zephyr/kernel.h>
+#include <stdint.h>
+#include "shared_types.h"
+
+#define MESSAGE_BUS_MAX_SINKS 4     /**< UART bridge, spool, aggregator, forwarder */
+
+/**
+ * @brief What a sink loses when its queue is full.
+ */
+typedef enum {
+    MESSAGE_SINK_DROP_NEWEST,
+    MESSAGE_SINK_DROP_OLDEST,
+} message_sink_policy_t;
+
+/**
+ * @brief One consumer of the bus.
+ */
+typedef struct {
+    const char *name;               /**< For logs */
+    struct k_msgq *queue;           /**< Pending messages (server_message_t *) */
+    message_sink_policy_t policy;
+    atomic_t delivered;             /**< Messages queued for this sink */
+    atomic_t dropped;               /**< Messages this sink lost to its policy */
+} message_sink_t;
+
+/**
+ * @brief The bus: a pool of reference-counted slots and its sinks.
+ */
+typedef struct {
+    struct k_mem_slab *pool;        /**< Slots (message_bus_slot_t) */
+    uint32_t slots;                 /**< Pool size */
+    message_sink_t *sinks[MESSAGE_BUS_MAX_SINKS];
+    uint8_t sink_count;
+    uint32_t sink_slots;            /**< Slots the sinks can hold at most (sum of depth + 1) */
+    struct k_spinlock lock;         /**< Keeps the sink queues in sequence order */
+    atomic_t published;             /**< Also the sequence number of the last message */
+    atomic_t no_slot;               /**< Messages dropped for want of a free slot */
+} message_bus_t;
+
+/**
+ * @brief Pool entry: a message and the number of holders.
+ */
+typedef struct {
+    atomic_t refs;
+    struct k_mem_slab *pool;        /**< Where the slot goes back */
+    uint32_t seq;                   /**< Publish order, from 1 */
+    server_message_t msg;
+} message_bus_slot_t;
+
+/**
+ * @brief Defines a bus with `slots` pool entries.
+ */
+#define MESSAGE_BUS_DEFINE(_name, _slots)                                              \
+    K_MEM_SLAB_DEFINE_STATIC(_name##_pool, sizeof(message_bus_slot_t), _slots, 4);     \
+    message_bus_t _name = {.pool = &_name##_pool, .slots = _slots}
+
+/**
+ * @brief Defines a sink holding up to `depth` pending messages.
+ */
+#define MESSAGE_SINK_DEFINE(_name, _depth, _policy)                                    \
+    K_MSGQ_DEFINE(_name##_queue, sizeof(server_message_t *), _depth, sizeof(void *)); \
+    message_sink_t _name = {.name = #_name, .queue = &_name##_queue, .policy = _policy}
+
+/**
+ * @brief Adds a sink. Call before the producers start: publishing does not lock the sink list.
+ * @return 0, or -ENOMEM if MESSAGE_BUS_MAX_SINKS sinks are already subscribed.
+ */
+int message_bus_subscribe(message_bus_t *bus, message_sink_t *sink);
+
+/**
+ * @brief Copies a message into the pool and queues it for every sink. Never blocks.
+ * @param bus Bus.
+ * @param msg Message (copied, the caller keeps it).
+ * @return 0 if at least one sink took the message, -ENOMEM if no slot was
+ *         free, -ENOSPC if every sink refused it.
+ */
+int message_bus_publish(message_bus_t *bus, const server_message_t *msg);
+
+/**
+ * @brief Takes the next message of a sink.
+ * @return The message (call message_bus_release() when done), NULL on timeout.
+ */
+const server_message_t *message_bus_get(message_sink_t *sink, k_timeout_t timeout);
+
+/**
+ * @brief Sequence number of a message taken from a sink (1 for the first one published).
+ * Compare with a signed difference, it wraps after 2^32 messages.
+ */
+static inline uint32_t message_bus_seq(const server_message_t *msg) {
+    return CONTAINER_OF(msg, message_bus_slot_t, msg)->seq;
+}
+
+/**
+ * @brief Drops the caller's reference, the slot is freed with the last one.
+ */
+void message_bus_release(const server_message_t *msg);
+
+#endif
@@ -10,22 +10,29 @@
 #include <openthread/thread.h>
 #include <openthread/coap.h>
 #include <string.h>             
+#include <errno.h>
 #include <zephyr/sys/printk.h>  
 #include "network_listener.h"
 #include "node_manager.h"
 #include "shared_types.h"
+#include "trace_spans.h"
+#include "payload_parser.h"
+#include "ts_codec.h"
 
 LOG_MODULE_REGISTER(network_lst, LOG_LEVEL_INF);
 
 // --- Configuration ---
 #define COAP_PORT 5683         
 #define URI_PATH "storedata"   
+#define COAP_CODE_TOO_MANY_REQUESTS ((otCoapCode)OT_COAP_CODE(4, 29))  /**< RFC 8516, not in otCoapCode */
+#define BUS_FULL_RETRY_S 5     /**< Max-Age of a 5.03 when the bus has no free slot */
 
 // --- Globals ---
-static struct k_msgq *outgoing_queue; 
+static message_bus_t *outgoing_bus; 
 
 // --- Forward Declarations ---
 static void storedata_request_handler(void *context, otMessage *message, const otMessageInfo *message_info);
+static void batch_request_handler(void *context, otMessage *message, const otMessageInfo *message_info);
 
 // --- CoAP Resource Definition ---
 static otCoapResource m_storedata_resource = {
@@ -35,47 +42,13 @@ static otCoapResource m_storedata_resource = {
     .mNext = NULL
 };
 
-/**
- * @brief Helper function to parse "room_name" from a flat JSON string.
- * It searches for the key "room_name" and extracts the string value.
- * * @param json_input The raw JSON string (e.g., {"room_name":"Kitchen", "temp":24})
- * @param out_buffer The buffer to store the result.
- * @param buffer_size The size of the output buffer.
- */
-static void parse_room_name(const char *json_input, char *out_buffer, size_t buffer_size) {
-    const char *key = "\"room_name\"";
-    const char *found = strstr(json_input, key);
-    
-    // Default fallback
-    strncpy(out_buffer, "Unknown", buffer_size - 1);
-    out_buffer[buffer_size - 1] = '\0';
-
-    if (found) {
-        // Move past the key
-        found += strlen(key);
-
-        // Find the start of the value (first quote after the colon)
-        const char *start_quote = strchr(found, '\"');
-        if (start_quote) {
-            start_quote++; // Move past the opening quote
-            
-            // Find the end of the value
-            const char *end_quote = strchr(start_quote, '\"');
-            if (end_quote) {
-                size_t len = end_quote - start_quote;
-                
-                // Safety clamp
-                if (len >= buffer_size) {
-                    len = buffer_size - 1;
-                }
-                
-                memcpy(out_buffer, start_quote, len);
-                out_buffer[len] = '\0'; // Null-terminate
-            }
-        }
-    }
-}
-
+// Compressed sample series from batching nodes (see ts_codec.h)
+static otCoapResource m_batch_resource = {
+    .mUriPath = TS_BATCH_URI_PATH,
+    .mHandler = batch_request_handler,
+    .mContext = NULL,
+    .mNext = NULL
+};
 
 /**
  * @brief Assigns a static IPv6 address (Mesh-Local Prefix + ::1).
@@ -112,10 +85,12 @@ static void setup_static_ipv6(void) {
 }
 
 /**
- * @brief Sends a CoAP ACK (2.04 Changed) back to the sensor.
- * This confirms we received the data so the sensor stops retrying.
+ * @brief Sends a piggybacked response (ACK) to a Confirmable request.
+ * @param code    CoAP response code.
+ * @param max_age Max-Age option (seconds), 0 = none.
  */
-static void send_ack_response(otMessage *request_message, const otMessageInfo *message_info) {    
+static void send_coap_response(otMessage *request_message, const otMessageInfo *message_info, otCoapCode code,
+                               uint32_t max_age) {
     otError error = OT_ERROR_NONE;
     otMessage *response;
     otInstance *instance = openthread_get_default_instance();
@@ -127,8 +102,11 @@ static void send_ack_response(otMessage *request_message, const otMessageInfo *m
         return;
     }
 
-    // Initialize as ACK with Code "Changed" (2.04)
-    otCoapMessageInitResponse(response, request_message, OT_COAP_TYPE_ACKNOWLEDGMENT, OT_COAP_CODE_CHANGED);
+    // Initialize as ACK with the response code (e.g. 2.04 Changed)
+    otCoapMessageInitResponse(response, request_message, OT_COAP_TYPE_ACKNOWLEDGMENT, code);
+    if (max_age > 0) {
+        otCoapMessageAppendMaxAgeOption(response, max_age);
+    }
 
     // Send it
     error = otCoapSendResponse(instance, response, message_info);
@@ -138,39 +116,178 @@ static void send_ack_response(otMessage *request_message, const otMessageInfo *m
     }
 }
 
+/**
+ * @brief Sends a CoAP ACK (2.04 Changed) back to the sensor.
+ * This confirms we received the data so the sensor stops retrying.
+ */
+static void send_ack_response(otMessage *request_message, const otMessageInfo *message_info) {    
+    send_coap_response(request_message, message_info, OT_COAP_CODE_CHANGED, 0);
+}
+
+/**
+ * @brief Answers a Confirmable request once it is handled: 2.04, 4.00 for a
+ * malformed payload, or 5.03 Service Unavailable when the message was not
+ * taken (bus full), so the sensor knows its data did not get through.
+ */
+static void send_request_result(otMessage *request_message, const otMessageInfo *message_info, int rc) {
+    if (otCoapMessageGetType(request_message) == OT_COAP_TYPE_CONFIRMABLE) {
+        trace_span_begin(SPAN_COAP_ACK);
+        if (rc == 0) {
+            send_ack_response(request_message, message_info);
+        } else if (rc == -EINVAL) {
+            send_coap_response(request_message, message_info, OT_COAP_CODE_BAD_REQUEST, 0);
+        } else {
+            send_coap_response(request_message, message_info, OT_COAP_CODE_SERVICE_UNAVAILABLE, BUS_FULL_RETRY_S);
+        }
+        trace_span_end(SPAN_COAP_ACK, rc);
+    }
+}
+
+/**
+ * @brief Handles a request over the sender's admission rate.
+ * A Confirmable request gets 4.29 Too Many Requests (RFC 8516) with
+ * Max-Age = seconds until the sender's next token, so the sensor stops
+ * retrying it. A Non-confirmable one is dropped silently.
+ */
+static void send_throttled_response(otMessage *request_message, const otMessageInfo *message_info, uint32_t retry_s) {
+    if (otCoapMessageGetType(request_message) == OT_COAP_TYPE_CONFIRMABLE) {
+        trace_span_begin(SPAN_COAP_ACK);
+        send_coap_response(request_message, message_info, COAP_CODE_TOO_MANY_REQUESTS, retry_s);
+        trace_span_end(SPAN_COAP_ACK, COAP_CODE_TOO_MANY_REQUESTS);
+    }
+}
+
 /**
  * @brief Main Handler: Called when a sensor sends data to "/storedata".
  */
 static void storedata_request_handler(void *context, otMessage *message, const otMessageInfo *message_info) {
     server_message_t msg;
     char room_name_buffer[20];
+    link_report_t link;
+    uint32_t retry_s = 0;
+
+    trace_span_begin(SPAN_SVC_STOREDATA);
 
     // 1. Extract Sender IP
     otIp6AddressToString(&message_info->mPeerAddr, msg.source_ip, sizeof(msg.source_ip));
 
-    // 2. Read Payload (JSON)
+    // 2. Admission Control (per-node token bucket): a flooding node cannot take the others' slots
+    trace_span_begin(SPAN_ADMIT);
+    bool admitted = node_manager_admit(msg.source_ip, outgoing_bus, &retry_s);
+    trace_span_end(SPAN_ADMIT, admitted);
+    if (!admitted) {
+        send_throttled_response(message, message_info, retry_s);
+        trace_span_end(SPAN_SVC_STOREDATA, -EBUSY);
+        return;
+    }
+
+    // 3. Read Payload (JSON)
+    trace_span_begin(SPAN_PAYLOAD_READ);
     uint16_t payload_offset = otMessageGetOffset(message);
     uint16_t length = otMessageRead(message, payload_offset, msg.json_payload, sizeof(msg.json_payload) - 1);
     msg.json_payload[length] = '\0';
+    msg.batch_len = 0;
+    trace_span_end(SPAN_PAYLOAD_READ, length);
     
-    // 3. Push to Main Queue (for Serial Bridge to print)
-    if (k_msgq_put(outgoing_queue, &msg, K_NO_WAIT) != 0) {
-        LOG_WRN("Queue full! Dropping packet from %s", msg.source_ip);
+    // 4. Publish to the sinks (Serial Bridge, ...)
+    trace_span_begin(SPAN_QUEUE_PUT);
+    int rc = message_bus_publish(outgoing_bus, &msg);
+    trace_span_end(SPAN_QUEUE_PUT, rc);
+    if (rc != 0) {
+        LOG_WRN("Bus full! Dropping packet from %s", msg.source_ip);
     } else {
-        // 4. Update Node Registry (Heartbeat)
+        // 5. Update Node Registry (Heartbeat)
+        trace_span_begin(SPAN_REGISTRY_UPD);
         parse_room_name(msg.json_payload, room_name_buffer, sizeof(room_name_buffer));
-        node_manager_update(msg.source_ip, room_name_buffer, outgoing_queue);
+        node_manager_update(msg.source_ip, room_name_buffer, outgoing_bus);
+        // Health reports and heartbeats carry the node's mesh link metrics
+        if (parse_link_report(msg.json_payload, &link)) {
+            node_manager_update_link(msg.source_ip, &link, outgoing_bus);
+        }
+        trace_span_end(SPAN_REGISTRY_UPD, 0);
+    }
+
+    // 6. Send ACK (or 5.03) if the sensor asked for confirmation
+    send_request_result(message, message_info, rc);
+    trace_span_end(SPAN_SVC_STOREDATA, rc);
+}
+
+/**
+ * @brief Span of a series: time between its first and last sample (seconds).
+ * Fleet time or node uptime alike, 0 if it has fewer than two samples.
+ */
+static uint32_t series_span_s(const uint8_t *series, size_t len) {
+    ts_decoder_t dec;
+    ts_point_t point;
+    int64_t first_ms = 0;
+    int64_t last_ms = 0;
+
+    if (!ts_decoder_init(&dec, series, len)) {
+        return 0;
+    }
+    for (int i = 0; ts_decoder_next(&dec, &point); i++) {
+        if (i == 0) {
+            first_ms = point.timestamp_ms;
+        }
+        last_ms = point.timestamp_ms;
     }
+    return (last_ms > first_ms) ? (uint32_t)((last_ms - first_ms) / 1000) : 0;
+}
+
+/**
+ * @brief Handler of "/batch": a compressed sample series from a batching node.
+ * * The frame is published as is (one bus slot per batch), the Serial Bridge
+ * expands it into one [DATA] line per sample.
+ */
+static void batch_request_handler(void *context, otMessage *message, const otMessageInfo *message_info) {
+    server_message_t msg;
+    batch_frame_t frame;
+    int rc = -EINVAL;
+    uint32_t retry_s = 0;
+
+    trace_span_begin(SPAN_SVC_BATCH);
+    otIp6AddressToString(&message_info->mPeerAddr, msg.source_ip, sizeof(msg.source_ip));
 
-    // 5. Send ACK if the sensor asked for confirmation
-    if (otCoapMessageGetType(message) == OT_COAP_TYPE_CONFIRMABLE) {
-        send_ack_response(message, message_info);
+    // A batch costs one token like a single reading: it is one request on the radio
+    trace_span_begin(SPAN_ADMIT);
+    bool admitted = node_manager_admit(msg.source_ip, outgoing_bus, &retry_s);
+    trace_span_end(SPAN_ADMIT, admitted);
+    if (!admitted) {
+        send_throttled_response(message, message_info, retry_s);
+        trace_span_end(SPAN_SVC_BATCH, -EBUSY);
+        return;
     }
+
+    trace_span_begin(SPAN_PAYLOAD_READ);
+    uint16_t length = otMessageRead(message, otMessageGetOffset(message), msg.json_payload, sizeof(msg.json_payload));
+    msg.batch_len = length;
+    trace_span_end(SPAN_PAYLOAD_READ, length);
+
+    if (!parse_batch_frame((const uint8_t *)msg.json_payload, length, &frame)) {
+        LOG_WRN("Malformed batch (%u bytes) from %s", length, msg.source_ip);
+    } else {
+        trace_span_begin(SPAN_QUEUE_PUT);
+        rc = message_bus_publish(outgoing_bus, &msg);
+        trace_span_end(SPAN_QUEUE_PUT, rc);
+        if (rc != 0) {
+            LOG_WRN("Bus full! Dropping batch from %s", msg.source_ip);
+        } else {
+            // The node is silent between batches: extend its liveness timeout
+            trace_span_begin(SPAN_REGISTRY_UPD);
+            node_manager_update(msg.source_ip, frame.room_name, outgoing_bus);
+            node_manager_set_report_interval(msg.source_ip, series_span_s(frame.series, frame.series_len));
+            trace_span_end(SPAN_REGISTRY_UPD, 0);
+        }
+    }
+
+    // Send ACK (or 5.03) if the sensor asked for confirmation
+    send_request_result(message, message_info, rc);
+    trace_span_end(SPAN_SVC_BATCH, rc);
 }
 
 
-void network_listener_init(struct k_msgq *queue_ptr){
-    outgoing_queue = queue_ptr;
+void network_listener_init(message_bus_t *bus){
+    outgoing_bus = bus;
 
     // 1. Setup IP
     setup_static_ipv6();
@@ -178,6 +295,7 @@ void network_listener_init(struct k_msgq *queue_ptr){
     // 2. Start CoAP Service
     otInstance *instance = openthread_get_default_instance();
     m_storedata_resource.mContext = instance;
+    m_batch_resource.mContext = instance;
 
     otError error = otCoapStart(instance, COAP_PORT);
    if (error != OT_ERROR_NONE) {
@@ -186,5 +304,6 @@ void network_listener_init(struct k_msgq *queue_ptr){
     }
     // 3. Register Resource
     otCoapAddResource(instance, &m_storedata_resource);
-    LOG_INF("CoAP Server listening on: %s", URI_PATH);
+    otCoapAddResource(instance, &m_batch_resource);
+    LOG_INF("CoAP Server listening on: %s, %s", URI_PATH, TS_BATCH_URI_PATH);
 }
\ No newline at end of file
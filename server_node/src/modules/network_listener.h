@@ -17,15 +17,16 @@
 #include <zephyr/net/openthread.h>
 #include <openthread/thread.h>
 #include <openthread/coap.h>
+#include "message_bus.h"
 
 /**
  * @brief Initializes the Network Listener.
  * * 1. Sets a Static IPv6 address (Mesh-Local + ::1).
  * 2. Starts the OpenThread CoAP Service.
  * 3. Registers the "storedata" resource handler.
- * 4. Connects the module to the central message queue.
- * * @param queue_ptr Pointer to the global server_queue for passing data to other threads.
+ * 4. Connects the module to the message bus.
+ * * @param bus The server_bus, for passing data to the sinks.
  */
-void network_listener_init(struct k_msgq *queue_ptr);
+void network_listener_init(message_bus_t *bus);
 
 #endif
\ No newline at end of file
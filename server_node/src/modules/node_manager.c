@@ -14,8 +14,18 @@
 #include "node_manager.h"
 
 // --- Configuration ---
-#define MAX_NODES 10          /**< Maximum number of sensors to track */
-#define TIMEOUT_SECONDS 15    /**< Time (in sec) before a node is considered dead */
+#define MAX_NODES CONFIG_APP_MAX_NODES /**< Maximum number of sensors to track */
+#define TIMEOUT_SECONDS 150   /**< Time (in sec) before a node is considered dead (2.5 telemetry periods) */
+#define BUCKET_CAPACITY_MT (CONFIG_APP_INGEST_BURST * 1000U)    /**< Full bucket (milli-tokens) */
+#define THROTTLE_QUIET_MS 10000 /**< Time without rejections before a throttled node is back to normal */
+#define LINK_WEAK_RSSI_DBM -85  /**< Parent RSSI below this is a weak link */
+#define LINK_WEAK_LQI 1         /**< Link quality in at or below this is a weak link */
+#define LINK_MIN_TX 20          /**< Fewer frames sent are too few to judge the loss rates */
+#define LINK_RETRY_PCT 25       /**< Retries per frame sent above this is a lossy link */
+#define LINK_ERR_PCT 5          /**< Failed sends per frame sent above this is a lossy link */
+#define TOPOLOGY_ROUTERS 63     /**< Thread router IDs 0-62 */
+#define TOPOLOGY_HOTSPOT_MIN 2  /**< Degraded children that make a router a hotspot */
+#define TOPOLOGY_LINES_PER_RUN 4 /**< Topology lines published per call (bus and UART headroom) */
 
 
 // --- Logging & Globals ---
@@ -23,7 +33,76 @@ LOG_MODULE_REGISTER(node_mng, LOG_LEVEL_INF);
 K_MUTEX_DEFINE(registry_lock); 
 static node_info_t registry[MAX_NODES];
 
-void node_manager_update(const char *ip_addr, const char *room_name, struct k_msgq *queue_ptr) {
+// Senders that are not in the registry (yet, or because it is full) share one bucket
+static token_bucket_t unregistered_bucket;
+static uint32_t unregistered_throttled;
+static int64_t unregistered_throttle_ms;
+
+/**
+ * @brief One router of the topology snapshot.
+ */
+typedef struct {
+    char room_name[20];     /**< Room of a sensor node acting as this router, "" otherwise */
+    uint8_t children;       /**< Online sensor nodes attached to it */
+    uint8_t weak;           /**< Children with LINK_FLAG_WEAK */
+    uint8_t lossy;          /**< Children with LINK_FLAG_LOSSY */
+    uint8_t degraded;       /**< Children with any flag */
+    uint8_t rssi_count;     /**< Children with a known parent RSSI */
+    int16_t rssi_sum;
+    bool present;
+} topology_router_t;
+
+// OWNED BY: node_manager_report_topology() (Node Manager thread / work)
+static topology_router_t topology[TOPOLOGY_ROUTERS];
+static uint8_t topology_alarm[TOPOLOGY_ROUTERS];   /**< Overloaded/hotspot state last logged */
+static int topology_cursor = TOPOLOGY_ROUTERS;      /**< Next router to publish, TOPOLOGY_ROUTERS = idle */
+static int64_t topology_next_ms;
+
+/**
+ * @brief Registry entry of a sender, NULL if unknown. Call with registry_lock held.
+ */
+static node_info_t *find_node(const char *ip_addr) {
+    for (int node = 0; node < MAX_NODES; node++){
+        if (registry[node].source_ip[0] != '\0' && strcmp(registry[node].source_ip, ip_addr) == 0){
+            return &registry[node];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Refills a bucket up to `now` at CONFIG_APP_INGEST_RATE_PER_MIN.
+ * Only the milliseconds turned into whole milli-tokens are consumed, so no
+ * refill is lost to rounding at high packet rates.
+ */
+static void bucket_refill(token_bucket_t *bucket, int64_t now) {
+    int64_t elapsed = now - bucket->refill_ms;
+    uint64_t add = (elapsed > 0) ? (uint64_t)elapsed * CONFIG_APP_INGEST_RATE_PER_MIN / 60 : 0;
+
+    if (bucket->tokens_mt + add >= BUCKET_CAPACITY_MT) {
+        bucket->tokens_mt = BUCKET_CAPACITY_MT;
+        bucket->refill_ms = now;
+    } else if (add > 0) {
+        bucket->tokens_mt += (uint32_t)add;
+        bucket->refill_ms += (int64_t)(add * 60 / CONFIG_APP_INGEST_RATE_PER_MIN);
+    }
+}
+
+/**
+ * @brief Takes one token.
+ * @param[out] retry_s Seconds until the next token, set when the bucket is empty.
+ */
+static bool bucket_take(token_bucket_t *bucket, int64_t now, uint32_t *retry_s) {
+    bucket_refill(bucket, now);
+    if (bucket->tokens_mt >= 1000) {
+        bucket->tokens_mt -= 1000;
+        return true;
+    }
+    *retry_s = DIV_ROUND_UP((1000 - bucket->tokens_mt) * 60, CONFIG_APP_INGEST_RATE_PER_MIN * 1000);
+    return false;
+}
+
+void node_manager_update(const char *ip_addr, const char *room_name, message_bus_t *bus) {
     
     bool found = false;
     int64_t now = k_uptime_get();
@@ -48,12 +127,13 @@ void node_manager_update(const char *ip_addr, const char *room_name, struct k_ms
                 LOG_INF("Node Reconnected: %s (%s)", ip_addr, room_name);
                 strncpy(msg.source_ip, ip_addr, sizeof(msg.source_ip) - 1);
                 msg.source_ip[sizeof(msg.source_ip) - 1] = '\0';
+                msg.batch_len = 0;
                 snprintf(msg.json_payload, sizeof(msg.json_payload), 
                      "{\"event\":\"node_reconnected\", \"room\":\"%s\", \"ip\":\"%s\"}", 
                      registry[node].room_name, registry[node].source_ip);
                 
-                if (k_msgq_put(queue_ptr, &msg, K_NO_WAIT) != 0) {
-                LOG_WRN("Queue full! Dropping Reconnection Alert for %s", registry[node].room_name);
+                if (message_bus_publish(bus, &msg) != 0) {
+                LOG_WRN("Bus full! Dropping Reconnection Alert for %s", registry[node].room_name);
                 } else {
                     LOG_INF("RECONNECTION ALERT SENT: %s", registry[node].room_name);
                 }
@@ -76,16 +156,23 @@ void node_manager_update(const char *ip_addr, const char *room_name, struct k_ms
 
                 registry[node].last_seen = now;
                 registry[node].is_online = true;
+                registry[node].timeout_s = 0;
+                registry[node].bucket.tokens_mt = BUCKET_CAPACITY_MT;
+                registry[node].bucket.refill_ms = now;
+                registry[node].throttled = 0;
+                registry[node].has_link = false;
+                registry[node].link_flags = 0;
                 LOG_INF("New Node Registered: %s (%s)", ip_addr, room_name);
                 strncpy(msg.source_ip, ip_addr, sizeof(msg.source_ip) - 1);
                 msg.source_ip[sizeof(msg.source_ip) - 1] = '\0';
+                msg.batch_len = 0;
                 snprintf(msg.json_payload, sizeof(msg.json_payload), 
                      "{\"event\":\"node_joined\", \"room\":\"%s\", \"ip\":\"%s\"}", 
                      registry[node].room_name, registry[node].source_ip);
                 found = true;
 
-                if (k_msgq_put(queue_ptr, &msg, K_NO_WAIT) != 0) {
-                    LOG_WRN("Queue full! Dropping New Join Alert for %s", registry[node].room_name);
+                if (message_bus_publish(bus, &msg) != 0) {
+                    LOG_WRN("Bus full! Dropping New Join Alert for %s", registry[node].room_name);
                     } else {
                         LOG_INF("NEW NODE JOIN ALERT SENT: %s", registry[node].room_name);
                     }
@@ -101,7 +188,232 @@ void node_manager_update(const char *ip_addr, const char *room_name, struct k_ms
     k_mutex_unlock(&registry_lock);
 }
 
-void node_manager_check_timeout(struct k_msgq *queue_ptr){
+bool node_manager_admit(const char *ip_addr, message_bus_t *bus, uint32_t *retry_s) {
+    int64_t now = k_uptime_get();
+    server_message_t msg;
+    bool admitted;
+
+    k_mutex_lock(&registry_lock, K_FOREVER);
+    node_info_t *node = find_node(ip_addr);
+
+    if (node == NULL) {
+        admitted = bucket_take(&unregistered_bucket, now, retry_s);
+        if (!admitted) {
+            unregistered_throttle_ms = now;
+            if (unregistered_throttled++ == 0) {
+                LOG_WRN("Throttling unregistered senders (first: %s)", ip_addr);
+            }
+        }
+    } else {
+        admitted = bucket_take(&node->bucket, now, retry_s);
+        if (!admitted) {
+            // A rejected request still proves the node is alive
+            node->last_seen = now;
+            node->throttle_ms = now;
+            if (node->throttled++ == 0) {
+                LOG_WRN("Throttling %s (%s): over %d requests/min", node->room_name, ip_addr,
+                        CONFIG_APP_INGEST_RATE_PER_MIN);
+                strncpy(msg.source_ip, ip_addr, sizeof(msg.source_ip) - 1);
+                msg.source_ip[sizeof(msg.source_ip) - 1] = '\0';
+                msg.batch_len = 0;
+                snprintf(msg.json_payload, sizeof(msg.json_payload),
+                     "{\"event\":\"node_throttled\", \"room\":\"%s\", \"ip\":\"%s\", \"rate_per_min\":%d, \"burst\":%d}",
+                     node->room_name, node->source_ip, CONFIG_APP_INGEST_RATE_PER_MIN, CONFIG_APP_INGEST_BURST);
+                if (message_bus_publish(bus, &msg) != 0) {
+                    LOG_WRN("Bus full! Dropping Throttle Alert for %s", node->room_name);
+                }
+            }
+        }
+    }
+    k_mutex_unlock(&registry_lock);
+    return admitted;
+}
+
+/**
+ * @brief LINK_FLAG_* of one report.
+ */
+static uint8_t link_flags(const link_report_t *link) {
+    uint8_t flags = 0;
+
+    if (link->parent_id != LINK_NO_ROUTER_ID &&
+        ((link->parent_rssi != 0 && link->parent_rssi < LINK_WEAK_RSSI_DBM) || link->parent_lqi <= LINK_WEAK_LQI)) {
+        flags |= LINK_FLAG_WEAK;
+    }
+    if (link->tx >= LINK_MIN_TX &&
+        (link->tx_retry * 100 > link->tx * LINK_RETRY_PCT || link->tx_err * 100 > link->tx * LINK_ERR_PCT)) {
+        flags |= LINK_FLAG_LOSSY;
+    }
+    return flags;
+}
+
+void node_manager_update_link(const char *ip_addr, const link_report_t *link, message_bus_t *bus) {
+    server_message_t msg;
+
+    k_mutex_lock(&registry_lock, K_FOREVER);
+    node_info_t *node = find_node(ip_addr);
+    if (node == NULL) {
+        k_mutex_unlock(&registry_lock);
+        return;
+    }
+    uint8_t flags = link_flags(link);
+    bool changed = node->has_link ? (flags != node->link_flags) : (flags != 0);
+
+    node->link = *link;
+    node->has_link = true;
+    node->link_flags = flags;
+
+    if (changed) {
+        unsigned int tx = MAX(link->tx, 1);
+        LOG_INF("Link of %s (%s) %s: parent %u, RSSI %d dBm, LQI %u, %u tx, %u retries, %u errors", node->room_name,
+                ip_addr, flags ? "degraded" : "recovered", link->parent_id, link->parent_rssi, link->parent_lqi,
+                link->tx, link->tx_retry, link->tx_err);
+        strncpy(msg.source_ip, ip_addr, sizeof(msg.source_ip) - 1);
+        msg.source_ip[sizeof(msg.source_ip) - 1] = '\0';
+        msg.batch_len = 0;
+        snprintf(msg.json_payload, sizeof(msg.json_payload),
+                 "{\"event\":\"%s\", \"room\":\"%s\", \"ip\":\"%s\", \"weak\":%d, \"lossy\":%d, \"parent\":%u, \"rssi\":%d, \"lqi\":%u, \"retry_pct\":%u, \"err_pct\":%u}",
+                 flags ? "link_degraded" : "link_recovered", node->room_name, node->source_ip,
+                 (flags & LINK_FLAG_WEAK) != 0, (flags & LINK_FLAG_LOSSY) != 0, link->parent_id, link->parent_rssi,
+                 link->parent_lqi, link->tx_retry * 100 / tx, link->tx_err * 100 / tx);
+        if (message_bus_publish(bus, &msg) != 0) {
+            LOG_WRN("Bus full! Dropping Link Alert for %s", node->room_name);
+        }
+    }
+    k_mutex_unlock(&registry_lock);
+}
+
+/**
+ * @brief Groups the online nodes by router. Call with registry_lock held.
+ */
+static void topology_snapshot(void) {
+    memset(topology, 0, sizeof(topology));
+
+    for (int node = 0; node < MAX_NODES; node++) {
+        const node_info_t *info = &registry[node];
+        if (info->source_ip[0] == '\0' || !info->is_online || !info->has_link) {
+            continue;
+        }
+        if (info->link.router_id < TOPOLOGY_ROUTERS) {
+            // A sensor node that became a router: a parent in its own right
+            topology_router_t *router = &topology[info->link.router_id];
+            router->present = true;
+            strncpy(router->room_name, info->room_name, sizeof(router->room_name) - 1);
+        }
+        if (info->link.parent_id < TOPOLOGY_ROUTERS) {
+            topology_router_t *parent = &topology[info->link.parent_id];
+            parent->present = true;
+            parent->children++;
+            parent->weak += (info->link_flags & LINK_FLAG_WEAK) != 0;
+            parent->lossy += (info->link_flags & LINK_FLAG_LOSSY) != 0;
+            parent->degraded += (info->link_flags != 0);
+            if (info->link.parent_rssi != 0) {
+                parent->rssi_count++;
+                parent->rssi_sum += info->link.parent_rssi;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Publishes the table line of one router.
+ * @return false if the bus is full (the line is retried on the next call).
+ */
+static bool topology_publish(int rid, message_bus_t *bus) {
+    const topology_router_t *router = &topology[rid];
+    bool overloaded = router->children > CONFIG_APP_TOPOLOGY_MAX_CHILDREN;
+    bool hotspot = router->degraded >= TOPOLOGY_HOTSPOT_MIN;
+    uint8_t alarm = (overloaded ? BIT(0) : 0) | (hotspot ? BIT(1) : 0);
+    server_message_t msg;
+
+    strncpy(msg.source_ip, "server", sizeof(msg.source_ip));
+    msg.batch_len = 0;
+    snprintf(msg.json_payload, sizeof(msg.json_payload),
+             "{\"event\":\"topology\", \"rid\":%d, \"room\":\"%s\", \"children\":%u, \"weak\":%u, \"lossy\":%u, \"rssi\":%d, \"overloaded\":%d, \"hotspot\":%d}",
+             rid, router->room_name, router->children, router->weak, router->lossy,
+             router->rssi_count ? router->rssi_sum / router->rssi_count : 0, overloaded, hotspot);
+    if (message_bus_publish(bus, &msg) != 0) {
+        return false;
+    }
+
+    if (alarm != topology_alarm[rid]) {
+        if (alarm != 0) {
+            LOG_WRN("Router %d%s%s: %u children, %u weak, %u lossy", rid, overloaded ? " overloaded" : "",
+                    hotspot ? " hotspot" : "", router->children, router->weak, router->lossy);
+        } else {
+            LOG_INF("Router %d back to normal (%u children)", rid, router->children);
+        }
+        topology_alarm[rid] = alarm;
+    }
+    return true;
+}
+
+void node_manager_report_topology(message_bus_t *bus) {
+    int64_t now = k_uptime_get();
+    int sent = 0;
+
+    if (CONFIG_APP_TOPOLOGY_REPORT_S == 0) {
+        return;
+    }
+    if (topology_cursor >= TOPOLOGY_ROUTERS) {
+        if (now < topology_next_ms) {
+            return;
+        }
+        topology_next_ms = now + CONFIG_APP_TOPOLOGY_REPORT_S * 1000LL;
+        k_mutex_lock(&registry_lock, K_FOREVER);
+        topology_snapshot();
+        k_mutex_unlock(&registry_lock);
+        topology_cursor = 0;
+    }
+
+    for (; topology_cursor < TOPOLOGY_ROUTERS && sent < TOPOLOGY_LINES_PER_RUN; topology_cursor++) {
+        if (!topology[topology_cursor].present) {
+            if (topology_alarm[topology_cursor] != 0) {
+                LOG_INF("Router %d has no sensor node left", topology_cursor);
+                topology_alarm[topology_cursor] = 0;
+            }
+            continue;
+        }
+        if (!topology_publish(topology_cursor, bus)) {
+            LOG_WRN("Bus full! Topology line of router %d delayed", topology_cursor);
+            break;
+        }
+        sent++;
+    }
+}
+
+void node_manager_set_report_interval(const char *ip_addr, uint32_t interval_s) {
+    k_mutex_lock(&registry_lock, K_FOREVER);
+    node_info_t *node = find_node(ip_addr);
+    if (node != NULL) {
+        // Same rule as TIMEOUT_SECONDS: 2.5 report periods
+        node->timeout_s = interval_s * 5 / 2;
+    }
+    k_mutex_unlock(&registry_lock);
+}
+
+/**
+ * @brief Reports the end of a throttling period once the node has been quiet. Call with registry_lock held.
+ */
+static void check_throttle_end(node_info_t *node, int64_t now, message_bus_t *bus) {
+    server_message_t msg;
+
+    if (node->throttled == 0 || now - node->throttle_ms < THROTTLE_QUIET_MS) {
+        return;
+    }
+    LOG_INF("Throttling of %s ended, %u requests rejected", node->room_name, node->throttled);
+    strncpy(msg.source_ip, node->source_ip, sizeof(msg.source_ip) - 1);
+    msg.source_ip[sizeof(msg.source_ip) - 1] = '\0';
+    msg.batch_len = 0;
+    snprintf(msg.json_payload, sizeof(msg.json_payload),
+             "{\"event\":\"node_throttle_end\", \"room\":\"%s\", \"ip\":\"%s\", \"rejected\":%u}",
+             node->room_name, node->source_ip, node->throttled);
+    if (message_bus_publish(bus, &msg) != 0) {
+        LOG_WRN("Bus full! Dropping Throttle End Alert for %s", node->room_name);
+    }
+    node->throttled = 0;
+}
+
+void node_manager_check_timeout(message_bus_t *bus){
     server_message_t msg;
     int64_t now = k_uptime_get();
 
@@ -112,20 +424,23 @@ void node_manager_check_timeout(struct k_msgq *queue_ptr){
         if (registry[node].source_ip[0] == '\0') {
             continue;
         }
+        check_throttle_end(&registry[node], now, bus);
 
         if (!registry[node].is_online) {
             continue;
         }
         int64_t diff = now - registry[node].last_seen;
+        int64_t timeout_ms = MAX(TIMEOUT_SECONDS, registry[node].timeout_s) * 1000LL;
         
         // --- TIMEOUT CONDITION ---
-        if((diff > (TIMEOUT_SECONDS * 1000)) && registry[node].is_online){
+        if((diff > timeout_ms) && registry[node].is_online){
             // 1. Mark as Offline locally
             registry[node].is_online = false;
             
             // 2. Prepare Alert Message structure
             strncpy(msg.source_ip, registry[node].source_ip, sizeof(msg.source_ip) - 1);
             msg.source_ip[sizeof(msg.source_ip) - 1] = '\0';
+            msg.batch_len = 0;
 
             // 3. Format JSON Payload
             snprintf(msg.json_payload, sizeof(msg.json_payload), 
@@ -133,12 +448,16 @@ void node_manager_check_timeout(struct k_msgq *queue_ptr){
                      registry[node].room_name, registry[node].source_ip);
 
             // 4. Push to Queue (Non-blocking)
-            if (k_msgq_put(queue_ptr, &msg, K_NO_WAIT) != 0) {
-                LOG_WRN("Queue full! Dropping Timeout Alert for %s", registry[node].room_name);
+            if (message_bus_publish(bus, &msg) != 0) {
+                LOG_WRN("Bus full! Dropping Timeout Alert for %s", registry[node].room_name);
                 } else {
                     LOG_INF("TIMEOUT ALERT SENT: %s", registry[node].room_name);
                 }
         }
     }
+    if (unregistered_throttled > 0 && now - unregistered_throttle_ms >= THROTTLE_QUIET_MS) {
+        LOG_INF("Throttling of unregistered senders ended, %u requests rejected", unregistered_throttled);
+        unregistered_throttled = 0;
+    }
     k_mutex_unlock(&registry_lock);
 }
\ No newline at end of file
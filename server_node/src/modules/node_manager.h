@@ -17,6 +17,19 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <zephyr/kernel.h>
+#include "message_bus.h"
+#include "payload_parser.h"
+
+#define LINK_FLAG_WEAK  BIT(0)      /**< Parent heard badly (low RSSI or link quality) */
+#define LINK_FLAG_LOSSY BIT(1)      /**< Many MAC retries or failed sends */
+
+/**
+ * @brief Admission token bucket (milli-tokens, so slow rates refill smoothly).
+ */
+typedef struct {
+    uint32_t tokens_mt;    /**< Available tokens x 1000 (max CONFIG_APP_INGEST_BURST x 1000) */
+    int64_t refill_ms;     /**< Uptime the tokens were last refilled up to */
+} token_bucket_t;
 
 /**
  * @brief Structure representing a single Sensor Node in the registry.
@@ -26,6 +39,13 @@ typedef struct {
     char room_name[20];    /**< Friendly Name (e.g., "Living Room") */
     int64_t last_seen;     /**< System uptime (ms) when last packet arrived */
     bool is_online;        /**< Current connection status flag */
+    uint32_t timeout_s;    /**< Silence before node_lost if longer than the default (batching nodes), 0 = default */
+    token_bucket_t bucket; /**< Admission control of the node's requests */
+    uint32_t throttled;    /**< Requests rejected since the node_throttled alert, 0 = not throttled */
+    int64_t throttle_ms;   /**< Uptime of the last rejected request */
+    link_report_t link;    /**< Mesh link metrics of the last health report */
+    bool has_link;         /**< link holds a report */
+    uint8_t link_flags;    /**< LINK_FLAG_* of the last report */
 } node_info_t;
 
 /**
@@ -36,8 +56,63 @@ typedef struct {
  *
  * @param ip_addr   The IPv6 string of the sender.
  * @param room_name The friendly room name extracted from the JSON payload.
+ * @param bus       Bus for the join/reconnection alerts.
+ */
+void node_manager_update(const char *ip_addr, const char *room_name, message_bus_t *bus);
+
+/**
+ * @brief Admission control: takes one token from the sender's bucket.
+ * * Call before accepting a request. Every registered node has its own
+ * bucket (CONFIG_APP_INGEST_RATE_PER_MIN, CONFIG_APP_INGEST_BURST), so a
+ * flooding node only exhausts its own share. Senders not in the registry
+ * share one bucket. The first rejection publishes a node_throttled alert,
+ * node_manager_check_timeout() publishes node_throttle_end once the node
+ * has been quiet for a while.
+ *
+ * @param ip_addr      The IPv6 string of the sender.
+ * @param bus          Bus for the throttle alert.
+ * @param[out] retry_s Seconds until the next token (for the CoAP Max-Age), set when rejected.
+ * @return true if the request is admitted.
+ */
+bool node_manager_admit(const char *ip_addr, message_bus_t *bus, uint32_t *retry_s);
+
+/**
+ * @brief Records the mesh link metrics of a health report (topology table).
+ * * Call after node_manager_update(). Flags the node's link as weak (parent
+ * RSSI or link quality too low) or lossy (MAC retries or failed sends over
+ * their threshold) and publishes link_degraded / link_recovered when the
+ * flags change.
+ *
+ * @param ip_addr The IPv6 string of the sender.
+ * @param link    Metrics from parse_link_report().
+ * @param bus     Bus for the link alerts.
+ */
+void node_manager_update_link(const char *ip_addr, const link_report_t *link, message_bus_t *bus);
+
+/**
+ * @brief Publishes the topology table: one "topology" line per router.
+ * * Call periodically with node_manager_check_timeout(). Every
+ * CONFIG_APP_TOPOLOGY_REPORT_S a snapshot of the online nodes is grouped by
+ * router (their parent, or themselves for sensor routers): children, weak
+ * and lossy links, mean parent RSSI. A router with more than
+ * CONFIG_APP_TOPOLOGY_MAX_CHILDREN children is flagged overloaded, one with
+ * several degraded children a hotspot. The lines are spread over several
+ * calls so the table never floods the bus.
+ *
+ * @param bus Bus for the topology lines.
+ */
+void node_manager_report_topology(message_bus_t *bus);
+
+/**
+ * @brief Declares how long a node stays silent between reports.
+ * * Call after node_manager_update() for nodes that batch their samples: the
+ * node is only reported lost after 2.5 intervals (never less than the
+ * default timeout).
+ *
+ * @param ip_addr     The IPv6 string of the sender.
+ * @param interval_s  Expected time between two reports (seconds).
  */
-void node_manager_update(const char *ip_addr, const char *room_name, struct k_msgq *queue_ptr);
+void node_manager_set_report_interval(const char *ip_addr, uint32_t interval_s);
 
 /**
  * @brief Periodically checks for dead nodes.
@@ -45,10 +120,11 @@ void node_manager_update(const char *ip_addr, const char *room_name, struct k_ms
  * from a low-priority background thread. It iterates through the registry 
  * and checks if the time since 'last_seen' exceeds the threshold.
  *
- * If a timeout is detected, a JSON alert is pushed to the server_queue.
+ * If a timeout is detected, a JSON alert is published on the server_bus.
+ * It also ends the throttling of nodes that went quiet (node_throttle_end).
  *
- * @param queue_ptr Pointer to the main outgoing message queue.
+ * @param bus Bus for the node_lost alerts.
  */
-void node_manager_check_timeout(struct k_msgq *queue_ptr);
+void node_manager_check_timeout(message_bus_t *bus);
 
 #endif
\ No newline at end of file
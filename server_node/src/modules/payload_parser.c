@@ -0,0 +1,115 @@
+/**
+ * @file payload_parser.c
+ * @brief Implementation of the Sensor Payload Parser
+ * @authors: muzamil.py, Google Gemini 3 Pro
+ * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include "payload_parser.h"
+#include "ts_codec.h"
+
+void parse_room_name(const char *json_input, char *out_buffer, size_t buffer_size) {
+    const char *key = "\"room_name\"";
+    const char *found = strstr(json_input, key);
+    
+    // Default fallback
+    strncpy(out_buffer, "Unknown", buffer_size - 1);
+    out_buffer[buffer_size - 1] = '\0';
+
+    if (found) {
+        // Move past the key
+        found += strlen(key);
+
+        // Find the start of the value (first quote after the colon)
+        const char *start_quote = strchr(found, '\"');
+        if (start_quote) {
+            start_quote++; // Move past the opening quote
+            
+            // Find the end of the value
+            const char *end_quote = strchr(start_quote, '\"');
+            if (end_quote) {
+                size_t len = end_quote - start_quote;
+                
+                // Safety clamp
+                if (len >= buffer_size) {
+                    len = buffer_size - 1;
+                }
+                
+                memcpy(out_buffer, start_quote, len);
+                out_buffer[len] = '\0'; // Null-terminate
+            }
+        }
+    }
+}
+
+bool parse_batch_frame(const uint8_t *payload, size_t len, batch_frame_t *frame) {
+    const uint8_t *nul = memchr(payload, '\0', len);
+
+    // The flags byte follows the NUL
+    if (nul == NULL || (size_t)(nul - payload) + 2 > len) {
+        return false;
+    }
+    size_t room_len = nul - payload;
+    if (room_len >= sizeof(frame->room_name)) {
+        room_len = sizeof(frame->room_name) - 1;
+    }
+    memcpy(frame->room_name, payload, room_len);
+    frame->room_name[room_len] = '\0';
+
+    frame->is_simulated = (nul[1] & TS_BATCH_FLAG_SIMULATED) != 0;
+    frame->uptime_ts = (nul[1] & TS_BATCH_FLAG_UPTIME) != 0;
+    frame->series = nul + 2;
+    frame->series_len = len - (size_t)(frame->series - payload);
+    return true;
+}
+
+/**
+ * @brief Reads the integer value of `"key":` between `obj` and `end`.
+ * The colon is part of the match, so "tx" does not match "tx_err".
+ */
+static bool json_int(const char *obj, const char *end, const char *key, long *value) {
+    char pattern[12];
+    size_t len = strlen(key);
+
+    if (len + 4 > sizeof(pattern)) {
+        return false;
+    }
+    pattern[0] = '\"';
+    memcpy(pattern + 1, key, len);
+    memcpy(pattern + 1 + len, "\":", 3);   // Closing quote, colon, NUL
+
+    const char *found = strstr(obj, pattern);
+    if (found == NULL || found >= end) {
+        return false;
+    }
+    char *stop;
+    *value = strtol(found + len + 3, &stop, 10);
+    return stop != found + len + 3;
+}
+
+bool parse_link_report(const char *json_input, link_report_t *link) {
+    const char *obj = strstr(json_input, "\"link\":{");
+    long role, rid, parent, value;
+
+    if (obj == NULL) {
+        return false;
+    }
+    const char *end = strchr(obj, '}');
+    if (end == NULL || !json_int(obj, end, "role", &role) || !json_int(obj, end, "rid", &rid) ||
+        !json_int(obj, end, "parent", &parent)) {
+        return false;
+    }
+    memset(link, 0, sizeof(*link));
+    link->role = (uint8_t)role;
+    link->router_id = (uint8_t)rid;
+    link->parent_id = (uint8_t)parent;
+    if (json_int(obj, end, "rssi", &value)) link->parent_rssi = (int8_t)value;
+    if (json_int(obj, end, "lqi", &value)) link->parent_lqi = (uint8_t)value;
+    if (json_int(obj, end, "tx", &value)) link->tx = (uint32_t)value;
+    if (json_int(obj, end, "retry", &value)) link->tx_retry = (uint32_t)value;
+    if (json_int(obj, end, "tx_err", &value)) link->tx_err = (uint32_t)value;
+    if (json_int(obj, end, "rx", &value)) link->rx = (uint32_t)value;
+    if (json_int(obj, end, "rx_err", &value)) link->rx_err = (uint32_t)value;
+    return true;
+}
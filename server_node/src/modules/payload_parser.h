@@ -0,0 +1,74 @@
+/**
+ * @file payload_parser.h
+ * @brief Sensor Payload Parser.
+ *
+ * Extracts fields from the flat JSON payloads sent by the sensor nodes
+ * without a JSON library. Kept apart from the CoAP handler so it can be
+ * benchmarked on its own (see benchmarks/).
+ * @authors: muzamil.py, Google Gemini 3 Pro
+ * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
+ */
+#ifndef PAYLOAD_PARSER_H
+#define PAYLOAD_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Helper function to parse "room_name" from a flat JSON string.
+ * It searches for the key "room_name" and extracts the string value.
+ * * @param json_input The raw JSON string (e.g., {"room_name":"Kitchen", "temp":24})
+ * @param out_buffer The buffer to store the result.
+ * @param buffer_size The size of the output buffer.
+ */
+void parse_room_name(const char *json_input, char *out_buffer, size_t buffer_size);
+
+/**
+ * @brief A /batch frame split into its parts (see ts_codec.h).
+ */
+typedef struct {
+    char room_name[20];         /**< Room name (truncated like parse_room_name()) */
+    bool is_simulated;          /**< TS_BATCH_FLAG_SIMULATED */
+    bool uptime_ts;             /**< TS_BATCH_FLAG_UPTIME: timestamps are the node's uptime */
+    const uint8_t *series;      /**< ts_codec stream, points into the frame */
+    size_t series_len;
+} batch_frame_t;
+
+/**
+ * @brief Splits a /batch frame: room name, NUL, flags, series.
+ * @param payload The raw frame.
+ * @param len Frame length.
+ * @param[out] frame Room name, flags and series.
+ * @return false if the frame has no NUL-terminated room name and flags byte.
+ */
+bool parse_batch_frame(const uint8_t *payload, size_t len, batch_frame_t *frame);
+
+#define LINK_NO_ROUTER_ID 0xFF      /**< No own router ID (child) or no parent (router) */
+
+/**
+ * @brief Mesh link metrics of a health report or heartbeat (the "link"
+ * object, see the sensor node's link_metrics.h).
+ */
+typedef struct {
+    uint8_t role;           /**< otDeviceRole: 2 child, 3 router, 4 leader */
+    uint8_t router_id;      /**< Own router ID (router/leader), LINK_NO_ROUTER_ID otherwise */
+    uint8_t parent_id;      /**< Parent's router ID (child), LINK_NO_ROUTER_ID otherwise */
+    int8_t parent_rssi;     /**< Average RSSI of the parent's frames (dBm), 0 = unknown */
+    uint8_t parent_lqi;     /**< Link quality in from the parent (0-3) */
+    uint32_t tx;            /**< MAC frames sent since the node's previous report */
+    uint32_t tx_retry;      /**< Retransmissions */
+    uint32_t tx_err;        /**< Failed sends */
+    uint32_t rx;            /**< MAC frames received */
+    uint32_t rx_err;        /**< Receive errors */
+} link_report_t;
+
+/**
+ * @brief Extracts the "link" object of a health payload.
+ * @param json_input The raw JSON string.
+ * @param[out] link The metrics (missing counters are 0).
+ * @return false if the payload has no "link" object with role, rid and parent.
+ */
+bool parse_link_report(const char *json_input, link_report_t *link);
+
+#endif
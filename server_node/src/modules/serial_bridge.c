@@ -1,26 +1,411 @@
 /**
  * @file serial_bridge.c
  * @brief Implementation of the Serial Bridge logic.
+ * * [DATA] lines are written raw to the `aeris,data-uart` device. Logs never
+ * touch that UART (they go to RTT), so the dashboard link only carries data.
+ * * /batch messages are expanded here into one [DATA] line per sample, in the
+ * same shape as a single sample, so the host does not need the codec. A
+ * series stamped before the node's first time beacon carries "uptime"
+ * (node uptime) instead of "ts" (fleet time).
+ * * Spool (CONFIG_APP_SERIAL_SPOOL): the flash spool is a second bus sink
+ * (spool_sink, drop newest) next to the UART one (serial_sink, drop oldest).
+ * Both get every message, and the bus sequence number decides which one
+ * writes it: the UART until the host drops DTR or the UART falls behind
+ * (its sink backed up or a message dropped), then the flash
+ * (serial_spool.h) from the first message the UART did not write. Once DTR is back, the backlog is
+ * written first, in bursts, and messages that arrive meanwhile queue behind
+ * it in flash, so the host reads everything in order. The UART takes over
+ * again after the last spooled message.
  * @authors: muzamil.py, Google Gemini 3 Pro
  * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
  */
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
 #include <string.h>             
-#include <zephyr/sys/printk.h>  
-#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include "serial_bridge.h"
 #include "shared_types.h"
+#include "trace_spans.h"
+#include "app_workqueue.h"
+#include "payload_parser.h"
+#include "ts_codec.h"
+#include "message_bus.h"
+#include "serial_spool.h"
 
 LOG_MODULE_REGISTER(serial_brg, LOG_LEVEL_INF);
 
 // --- Configuration ---
 #define SERIAL_PRIORITY 5
 #define STACKSIZE 2048
+#define SERIAL_SINK_DEPTH 10    /**< Messages waiting for the UART */
+#define SERIAL_LAG_DEPTH 8      /**< UART sink backlog at which the bridge spools (below the depth, before drops) */
+#define SPOOL_SINK_DEPTH 16     /**< Messages waiting for the flash (more than the UART sink) */
+#define SPOOL_POLL_MS 500       /**< DTR check period while messages wait in flash */
+#define SPOOL_DRAIN_BURST 32    /**< Spooled messages written per pass (app_work_q is shared) */
+#define SPOOL_LOG_EVERY 100     /**< Depth log period while spooling (messages) */
+
+// Boards without a dedicated data UART (e.g. native_sim) fall back to the console
+#if DT_HAS_CHOSEN(aeris_data_uart)
+#define DATA_UART_NODE DT_CHOSEN(aeris_data_uart)
+#else
+#define DATA_UART_NODE DT_CHOSEN(zephyr_console)
+#endif
 
 // --- Globals ---
-static struct k_msgq *outgoing_queue;
+// The UART never stalls for long, so when it falls behind the newest data wins
+MESSAGE_SINK_DEFINE(serial_sink, SERIAL_SINK_DEPTH, MESSAGE_SINK_DROP_OLDEST);
+static const struct device *const data_uart = DEVICE_DT_GET(DATA_UART_NODE);
+
+/**
+ * @brief Writes a string to the data UART, byte by byte.
+ * @return Number of bytes written.
+ */
+static size_t data_uart_write(const char *str){
+    size_t len = 0;
+
+    while (str[len] != '\0') {
+        uart_poll_out(data_uart, str[len++]);
+    }
+    return len;
+}
+
+/**
+ * @brief Writes one [DATA] line: "[DATA]: <ip> | <json>\n".
+ * @return Number of bytes written.
+ */
+static size_t data_line_write(const char *source_ip, const char *json){
+    size_t len = data_uart_write("[DATA]: ");
+    len += data_uart_write(source_ip);
+    len += data_uart_write(" | ");
+    len += data_uart_write(json);
+    len += data_uart_write("\n");
+    return len;
+}
+
+/**
+ * @brief Formats a quantized value with `decimals` digits (no float printf on this node).
+ */
+static void format_fixed(char *buf, size_t size, int32_t q, int32_t scale, int decimals){
+    int32_t mag = abs(q);
+    snprintf(buf, size, "%s%d.%0*d", (q < 0) ? "-" : "", (int)(mag / scale), decimals, (int)(mag % scale));
+}
+
+/**
+ * @brief Expands a /batch message into one [DATA] line per sample.
+ * @return Number of bytes written.
+ */
+static size_t batch_output(const server_message_t *msg){
+    batch_frame_t frame;
+    ts_decoder_t dec;
+    ts_point_t point;
+    char temp[12], humi[12], mold[12];
+    char line[192];
+    size_t len = 0;
+
+    if (!parse_batch_frame((const uint8_t *)msg->json_payload, msg->batch_len, &frame) ||
+        !ts_decoder_init(&dec, frame.series, frame.series_len)) {
+        LOG_WRN("Undecodable batch from %s", msg->source_ip);
+        return 0;
+    }
+    while (ts_decoder_next(&dec, &point)) {
+        format_fixed(temp, sizeof(temp), point.temp_q, TS_CODEC_TEMP_SCALE, 1);
+        format_fixed(humi, sizeof(humi), point.humi_q, TS_CODEC_HUMI_SCALE, 1);
+        format_fixed(mold, sizeof(mold), point.mold_q, TS_CODEC_MOLD_SCALE, 2);
+        snprintf(line, sizeof(line),
+                 "{\"message_type\":\"DATA\",\"room_name\":\"%s\",\"temparature\":%s,\"humidity\":%s,\"mold_index\":%s, \"is_simulated\":%d,\"%s\":%lu.%03u,\"batch\":1}",
+                 frame.room_name, temp, humi, mold, (int)frame.is_simulated, frame.uptime_ts ? "uptime" : "ts",
+                 (unsigned long)(point.timestamp_ms / 1000), (unsigned int)(point.timestamp_ms % 1000));
+        len += data_line_write(msg->source_ip, line);
+    }
+    if (dec.index != dec.count) {
+        LOG_WRN("Batch from %s truncated after %u of %u samples", msg->source_ip, dec.index, dec.count);
+    }
+    return len;
+}
+
+/**
+ * @brief Writes one message to the data UART with a [DATA] tag.
+ * The tag lets the dashboard resync on every line.
+ */
+static void serial_output(const server_message_t *msg){
+    // Output: "[DATA]: <ip> | <json>\n" for Python/Dashboard
+    // Pieces are written directly, no formatting pass.
+    trace_span_begin(SPAN_SVC_SERIAL);
+    trace_span_begin(SPAN_SERIAL_OUT);
+    size_t len = (msg->batch_len > 0) ? batch_output(msg) : data_line_write(msg->source_ip, msg->json_payload);
+    trace_span_end(SPAN_SERIAL_OUT, (int32_t)len);
+    trace_span_end(SPAN_SVC_SERIAL, 0);
+}
+
+#if defined(CONFIG_APP_SERIAL_SPOOL)
+// The spool's own copy of every message: it keeps its backlog, so the flash
+// gets the messages the UART did not write
+MESSAGE_SINK_DEFINE(spool_sink, SPOOL_SINK_DEPTH, MESSAGE_SINK_DROP_NEWEST);
+
+// --- Spool State ---
+// OWNED BY: the Serial Bridge thread / work item
+static bool spool_ok;
+static bool spooling;               /**< The flash owns the messages from handoff_seq on */
+static bool draining;
+static uint32_t uart_seq;           /**< Last message the UART path took (written or skipped) */
+static uint32_t handoff_seq;
+static uint32_t last_spooled_seq;
+static int64_t drain_start_ms;
+static uint32_t drain_start_count;
+static server_message_t spool_msg;
+
+/**
+ * @brief Whether the host has the data UART open (DTR).
+ * Drivers without line control report the host as always present.
+ */
+static bool host_present(void){
+    uint32_t dtr = 1;
+
+    if (uart_line_ctrl_get(data_uart, UART_LINE_CTRL_DTR, &dtr) != 0) {
+        return true;
+    }
+    return dtr != 0;
+}
+
+/**
+ * @brief Hands the messages from `seq` on to the flash.
+ * The UART takes them back once the spool is drained.
+ */
+static void spool_engage(uint32_t seq){
+    spooling = true;
+    draining = false;
+    handoff_seq = seq;
+    last_spooled_seq = seq - 1;
+}
+
+/**
+ * @brief Writes a message to the UART, unless the flash owns it.
+ * While spooling, the spool sink's copy goes to flash and this one is dropped.
+ */
+static void serial_route(const server_message_t *msg){
+    uint32_t seq = message_bus_seq(msg);
+
+    if (!spool_ok) {
+        serial_output(msg);
+        return;
+    }
+    if (spooling || (int32_t)(seq - uart_seq) <= 0) {
+        // Spooled, or already drained from flash
+        return;
+    }
+    if (!host_present()) {
+        LOG_WRN("[SPOOL] Host gone (DTR low), spooling to flash");
+        spool_engage(seq);
+        return;
+    }
+    // A host that keeps DTR up but reads slowly backs the UART sink up; the
+    // spool sink still holds every message after uart_seq
+    uint32_t queued = k_msgq_num_used_get(serial_sink.queue);
+    if (queued >= SERIAL_LAG_DEPTH || seq - uart_seq > 1) {
+        LOG_WRN("[SPOOL] UART behind (%u queued, %u dropped), spooling to flash", queued, seq - uart_seq - 1);
+        spool_engage(uart_seq + 1);
+        return;
+    }
+    serial_output(msg);
+    uart_seq = seq;
+}
+
+/**
+ * @brief Appends one message behind the backlog.
+ */
+static void spool_append(const server_message_t *msg){
+    if (serial_spool_append(msg) == 0) {
+        uint32_t depth = serial_spool_depth();
+        if (depth % SPOOL_LOG_EVERY == 0) {
+            LOG_WRN("[SPOOL] %u messages waiting for the host", depth);
+        }
+    } else if (host_present()) {
+        // Out of order, but not lost
+        serial_output(msg);
+    } else {
+        LOG_WRN("[SPOOL] Dropping message from %s", msg->source_ip);
+    }
+}
+
+/**
+ * @brief Empties the spool sink: appends the messages the flash owns and
+ * releases the ones the UART path has taken.
+ * * Stops at a message the UART path has not seen yet: it may still spool it.
+ */
+static void spool_take(void){
+    const server_message_t *msg;
+
+    while (k_msgq_peek(spool_sink.queue, &msg) == 0) {
+        uint32_t seq = message_bus_seq(msg);
 
+        if (!spooling && (int32_t)(seq - uart_seq) > 0) {
+            break;
+        }
+        msg = message_bus_get(&spool_sink, K_NO_WAIT);
+        if (spooling && (int32_t)(seq - handoff_seq) >= 0) {
+            spool_append(msg);
+            last_spooled_seq = seq;
+        }
+        message_bus_release(msg);
+    }
+}
+
+/**
+ * @brief Writes the catch-up report as a [DATA] line.
+ */
+static void spool_report_drained(void){
+    serial_spool_stats_t stats;
+    char json[128];
+    uint32_t elapsed_ms = (uint32_t)(k_uptime_get() - drain_start_ms);
+
+    serial_spool_get_stats(&stats);
+    uint32_t count = stats.drained - drain_start_count;
+    uint32_t rate = (elapsed_ms > 0) ? (uint32_t)(count * 1000ULL / elapsed_ms) : count;
+    uint32_t lost = stats.lost + (uint32_t)atomic_get(&spool_sink.dropped);
+    LOG_INF("[SPOOL] Drained %u messages in %u ms (%u msg/s), %u lost", count, elapsed_ms, rate, lost);
+    snprintf(json, sizeof(json), "{\"event\":\"spool_drained\",\"messages\":%u,\"ms\":%u,\"rate\":%u,\"lost\":%u}",
+             count, elapsed_ms, rate, lost);
+    data_line_write("server", json);
+}
+
+/**
+ * @brief Moves the spool sink to flash and drains the spool while the host reads.
+ * * Messages that arrive during the drain are appended behind the backlog.
+ * Once the flash is empty the UART takes over after the last spooled message.
+ * @return How long the caller may wait for new messages before calling again.
+ */
+static k_timeout_t spool_service(void){
+    if (!spool_ok) {
+        return K_FOREVER;
+    }
+    spool_take();
+    if (!spooling) {
+        return K_FOREVER;
+    }
+    if (!host_present()) {
+        if (draining) {
+            LOG_WRN("[SPOOL] Host gone (DTR low) during the drain");
+            draining = false;
+        }
+        return K_MSEC(SPOOL_POLL_MS);
+    }
+
+    if (!draining) {
+        serial_spool_stats_t stats;
+        serial_spool_get_stats(&stats);
+        LOG_INF("[SPOOL] Host reading, %u messages to drain", stats.depth);
+        draining = true;
+        drain_start_ms = k_uptime_get();
+        drain_start_count = stats.drained;
+    }
+    for (int i = 0; i < SPOOL_DRAIN_BURST && serial_spool_pop(&spool_msg); i++) {
+        serial_output(&spool_msg);
+    }
+    spool_take();
+    if (serial_spool_depth() > 0) {
+        return K_NO_WAIT;
+    }
+    spooling = false;
+    draining = false;
+    uart_seq = last_spooled_seq;
+    spool_report_drained();
+    return K_FOREVER;
+}
+
+/**
+ * @brief Mounts the spool and subscribes its sink (at init, before the first message).
+ * * Without DTR the host is always present: only the lag signal can engage the spool.
+ * A backlog left from before a reset keeps the flash in charge until it is drained.
+ */
+static void spool_start(message_bus_t *bus){
+    uint32_t dtr;
+
+    if (uart_line_ctrl_get(data_uart, UART_LINE_CTRL_DTR, &dtr) != 0) {
+        LOG_ERR("[SPOOL] Data UART has no line control (DTR): a closed host port is not detected, "
+                "only a lagging UART is spooled. Use the CDC ACM data UART of the board overlay");
+    }
+    spool_ok = (serial_spool_init() == 0) && (message_bus_subscribe(bus, &spool_sink) == 0);
+    if (spool_ok && serial_spool_depth() > 0) {
+        spool_engage(1);
+    }
+}
+
+#define SERIAL_EVENT_COUNT 2
+#else
+static void serial_route(const server_message_t *msg){
+    serial_output(msg);
+}
+
+static k_timeout_t spool_service(void){
+    return K_FOREVER;
+}
+
+static void spool_start(message_bus_t *bus){
+}
+
+#define SERIAL_EVENT_COUNT 1
+#endif
+
+// --- Poll Data ---
+// OWNED BY: the Serial Bridge thread / work item
+static struct k_poll_event serial_events[SERIAL_EVENT_COUNT];
+
+/**
+ * @brief Writes (or spools) what the sinks hold.
+ * @return How long the caller may wait for new messages before calling again.
+ */
+static k_timeout_t serial_service(void){
+    const server_message_t *msg;
+
+    while ((msg = message_bus_get(&serial_sink, K_NO_WAIT)) != NULL) {
+        serial_route(msg);
+        message_bus_release(msg);
+    }
+    return spool_service();
+}
+
+/**
+ * @brief Mounts the spool, subscribes the sinks and sets up the "data available" events.
+ */
+static void serial_sinks_init(message_bus_t *bus){
+    message_bus_subscribe(bus, &serial_sink);
+    k_poll_event_init(&serial_events[0], K_POLL_TYPE_MSGQ_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, serial_sink.queue);
+    spool_start(bus);
+#if defined(CONFIG_APP_SERIAL_SPOOL)
+    k_poll_event_init(&serial_events[1], K_POLL_TYPE_MSGQ_DATA_AVAILABLE, K_POLL_MODE_NOTIFY_ONLY, spool_sink.queue);
+#endif
+}
+
+#if defined(CONFIG_APP_WORKQUEUE_MODEL)
+// --- Work Data ---
+// Triggered work: app_work_q runs the handler once a sink has data.
+static struct k_work_poll serial_work;
+
+/**
+ * @brief Drains the sinks, then re-arms itself on "data available"
+ * (or on a timeout while the spool has a backlog).
+ */
+static void serial_work_handler(struct k_work *work){
+    k_work_poll_submit_to_queue(&app_work_q, &serial_work, serial_events, ARRAY_SIZE(serial_events), serial_service());
+}
+
+void serial_bridge_init(message_bus_t *bus){
+    if (!device_is_ready(data_uart)) {
+        LOG_ERR("Data UART not ready, [DATA] output disabled");
+        return;
+    }
+    serial_sinks_init(bus);
+
+    LOG_INF("--- Serial Bridge Started (app_wq) ---");
+    k_work_poll_init(&serial_work, serial_work_handler);
+    // A backlog left from before a reset is drained right away
+    k_work_poll_submit_to_queue(&app_work_q, &serial_work, serial_events, ARRAY_SIZE(serial_events), spool_service());
+}
+
+#else
 // --- Thread Data ---
 struct k_thread serial_thread_data;
 K_THREAD_STACK_DEFINE(serial_thread_stack, STACKSIZE);
@@ -29,29 +414,33 @@ K_THREAD_STACK_DEFINE(serial_thread_stack, STACKSIZE);
 /**
  * @brief The worker thread loop.
  *
- * Waits for data and prints it to the console with a [DATA] tag.
- * The tag helps external scripts filter out system logs.
+ * Waits for data and hands it to serial_service().
  */
 void serial_thread_entry(void *p1, void *p2, void *p3){
-    server_message_t msg;
+    k_timeout_t timeout;
 
-    // Use printk for raw output (bypasses log formatting timestamps)
-    LOG_INF("--- Serial Bridge Started ---\n");
+    LOG_INF("--- Serial Bridge Started ---");
+    timeout = spool_service();
 
     while (1) {
-        // 1. Wait Block: Sleeps until data arrives (Efficient)
-        // K_FOREVER ensures this thread consumes 0 cycles when idle.
-        if (k_msgq_get(outgoing_queue, &msg, K_FOREVER) == 0) {
-            
-            // 2. Output: Print the payload for Python/Dashboard
-            // We use the "[DATA]:" prefix to make parsing robust against log noise.
-            printk("[DATA]: %s | %s\n", msg.source_ip, msg.json_payload);
+        // 1. Wait Block: Sleeps until a sink has data (Efficient)
+        // K_FOREVER ensures this thread consumes 0 cycles when idle; a spool
+        // backlog shortens the wait to poll DTR or keep draining.
+        k_poll(serial_events, ARRAY_SIZE(serial_events), timeout);
+        for (size_t i = 0; i < ARRAY_SIZE(serial_events); i++) {
+            serial_events[i].state = K_POLL_STATE_NOT_READY;
         }
+        // 2. Output (or spool), the slots go back to the bus
+        timeout = serial_service();
     }
 }
 
-void serial_bridge_init(struct k_msgq *queue_ptr){
-    outgoing_queue = queue_ptr;
+void serial_bridge_init(message_bus_t *bus){
+    if (!device_is_ready(data_uart)) {
+        LOG_ERR("Data UART not ready, [DATA] output disabled");
+        return;
+    }
+    serial_sinks_init(bus);
     // Spawn the thread immediately
     k_thread_create(&serial_thread_data, 
         serial_thread_stack,
@@ -61,4 +450,6 @@ void serial_bridge_init(struct k_msgq *queue_ptr){
         SERIAL_PRIORITY, 
         0, 
         K_NO_WAIT);
-}
\ No newline at end of file
+    k_thread_name_set(&serial_thread_data, "serial_bridge");
+}
+#endif
\ No newline at end of file
@@ -2,10 +2,11 @@
  * @file serial_bridge.h
  * @brief Serial Output Bridge.
  *
- * This module acts as the "Consumer" of the data pipeline.
- * It runs in a dedicated thread that waits for messages to appear in the 
- * global queue. When a message arrives, it formats and prints it to the 
- * USB Serial Console (UART) for external processing (e.g., by a Python script).
+ * This module is one sink of the server_bus (see message_bus.h).
+ * It runs in a dedicated thread that waits for messages to appear in its
+ * sink queue. When a message arrives, it writes it to the data UART
+ * (devicetree `chosen { aeris,data-uart }`, the USB VCOM on the DK) for
+ * external processing (e.g., by a Python script). Logs and the shell use RTT.
  * @authors: muzamil.py, Google Gemini 3 Pro
  * NOTE: Main Architecture designed by muzamil.py. Optimization, Code Reviews and Code Documentation by Google Gemini 3 Pro.
  */
@@ -13,14 +14,17 @@
 #define SERIAL_BRIDGE_H
 
 #include <zephyr/kernel.h>
+#include "message_bus.h"
 
 /**
  * @brief Initializes and starts the Serial Bridge Thread.
  *
- * This spawns a background thread that blocks (sleeps) until data 
- * is available in the provided queue. It uses 0% CPU while waiting.
+ * Subscribes the bridge's sink to the bus, then spawns a background thread
+ * that blocks (sleeps) until the sink has data. It uses 0% CPU while waiting.
+ * With CONFIG_APP_WORKQUEUE_MODEL no thread is spawned: a triggered work
+ * item on app_work_q drains the sink whenever it has data.
  *
- * @param queue_ptr Pointer to the global server_queue containing incoming data.
+ * @param bus The server_bus. Call before the producers start publishing.
  */
-void serial_bridge_init(struct k_msgq *queue_ptr);
+void serial_bridge_init(message_bus_t *bus);
 #endif
\ No newline at end of file
@@ -0,0 +1,234 @@
+/**
+ * @file serial_spool.c
+ * @brief Implementation of the Serial Bridge Flash Spool
+ */
+#include "serial_spool.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(serial_spool, LOG_LEVEL_INF);
+
+// * --- CONFIGURATION --- *
+#define SPOOL_PARTITION_ID  FIXED_PARTITION_ID(spool_partition)
+#define SPOOL_MAX_SECTORS   16
+#define SPOOL_MAGIC         0xAE5B0071
+#define SPOOL_VERSION       1
+
+/**
+ * @brief Entry header, followed by the source IP and the payload.
+ */
+typedef struct {
+    uint16_t payload_len;   /**< JSON text length or /batch frame length */
+    uint16_t batch_len;     /**< server_message_t.batch_len */
+    uint8_t ip_len;
+    uint8_t reserved[3];
+} spool_record_hdr_t;
+
+#define SPOOL_RECORD_MAX (sizeof(spool_record_hdr_t) + sizeof(((server_message_t *)0)->source_ip) + \
+                          sizeof(((server_message_t *)0)->json_payload))
+
+// --- Globals ---
+static struct flash_sector spool_sectors[SPOOL_MAX_SECTORS];
+static struct fcb spool_fcb;
+static struct fcb_entry drain_loc;      /**< Last entry read, fe_sector NULL = none yet */
+static uint32_t read_in_sector;         /**< Entries read in drain_loc's sector */
+static serial_spool_stats_t stats;
+static bool spool_ready;
+static uint8_t record[ROUND_UP(SPOOL_RECORD_MAX, 8)] __aligned(4);
+
+static int count_cb(struct fcb_entry_ctx *loc_ctx, void *arg) {
+    (*(uint32_t *)arg)++;
+    return 0;
+}
+
+int serial_spool_init(void) {
+    uint32_t sector_cnt = ARRAY_SIZE(spool_sectors);
+    int rc = flash_area_get_sectors(SPOOL_PARTITION_ID, &sector_cnt, spool_sectors);
+
+    if (rc != 0) {
+        LOG_ERR("[SPOOL] No sectors in spool_partition: %d", rc);
+        return rc;
+    }
+    spool_fcb.f_magic = SPOOL_MAGIC;
+    spool_fcb.f_version = SPOOL_VERSION;
+    spool_fcb.f_sector_cnt = (uint8_t)sector_cnt;
+    spool_fcb.f_scratch_cnt = 0;
+    spool_fcb.f_sectors = spool_sectors;
+
+    rc = fcb_init(SPOOL_PARTITION_ID, &spool_fcb);
+    if (rc != 0) {
+        // Another layout (or garbage) on the partition: start clean
+        LOG_WRN("[SPOOL] Formatting spool_partition (%d)", rc);
+        const struct flash_area *fa;
+        if (flash_area_open(SPOOL_PARTITION_ID, &fa) == 0) {
+            rc = flash_area_erase(fa, 0, fa->fa_size);
+            flash_area_close(fa);
+        }
+        rc = (rc == 0) ? fcb_init(SPOOL_PARTITION_ID, &spool_fcb) : rc;
+        if (rc != 0) {
+            LOG_ERR("[SPOOL] FCB init failed: %d", rc);
+            return rc;
+        }
+    }
+
+    // Left over from before a reset: drained again from the oldest sector
+    fcb_walk(&spool_fcb, NULL, count_cb, &stats.depth);
+    spool_ready = true;
+    LOG_INF("[SPOOL] %u sectors, %u messages waiting", sector_cnt, stats.depth);
+    return 0;
+}
+
+/**
+ * @brief Erases the oldest sector to make room, counting its unread messages as lost.
+ */
+static int drop_oldest_sector(void) {
+    uint32_t entries = 0;
+
+    fcb_walk(&spool_fcb, spool_fcb.f_oldest, count_cb, &entries);
+    if (drain_loc.fe_sector == spool_fcb.f_oldest) {
+        // The cursor restarts at the new oldest sector
+        entries -= MIN(entries, read_in_sector);
+        drain_loc.fe_sector = NULL;
+        read_in_sector = 0;
+    }
+    int rc = fcb_rotate(&spool_fcb);
+    if (rc == 0) {
+        entries = MIN(entries, stats.depth);
+        stats.depth -= entries;
+        stats.lost += entries;
+        LOG_WRN("[SPOOL] Full! %u messages lost (%u in total)", entries, stats.lost);
+    }
+    return rc;
+}
+
+int serial_spool_append(const server_message_t *msg) {
+    spool_record_hdr_t hdr = {0};
+    struct fcb_entry loc;
+    int rc;
+
+    if (!spool_ready) {
+        return -ENODEV;
+    }
+    hdr.ip_len = (uint8_t)strnlen(msg->source_ip, sizeof(msg->source_ip));
+    hdr.batch_len = msg->batch_len;
+    hdr.payload_len = (msg->batch_len > 0) ? MIN(msg->batch_len, sizeof(msg->json_payload))
+                                           : strnlen(msg->json_payload, sizeof(msg->json_payload));
+    memcpy(record, &hdr, sizeof(hdr));
+    memcpy(record + sizeof(hdr), msg->source_ip, hdr.ip_len);
+    memcpy(record + sizeof(hdr) + hdr.ip_len, msg->json_payload, hdr.payload_len);
+
+    // Flash writes go by whole write blocks
+    size_t len = ROUND_UP(sizeof(hdr) + hdr.ip_len + hdr.payload_len, MAX(spool_fcb.f_align, 1));
+    memset(record + sizeof(hdr) + hdr.ip_len + hdr.payload_len, spool_fcb.f_erase_value,
+           len - (sizeof(hdr) + hdr.ip_len + hdr.payload_len));
+
+    rc = fcb_append(&spool_fcb, (uint16_t)len, &loc);
+    for (int i = 0; rc == -ENOSPC && i < spool_fcb.f_sector_cnt; i++) {
+        if (drop_oldest_sector() != 0) {
+            break;
+        }
+        rc = fcb_append(&spool_fcb, (uint16_t)len, &loc);
+    }
+    if (rc != 0) {
+        LOG_ERR("[SPOOL] No room for %u bytes: %d", (unsigned int)len, rc);
+        return rc;
+    }
+
+    rc = flash_area_write(spool_fcb.fap, FCB_ENTRY_FA_DATA_OFF(loc), record, len);
+    if (rc == 0) {
+        rc = fcb_append_finish(&spool_fcb, &loc);
+    }
+    if (rc != 0) {
+        LOG_ERR("[SPOOL] Write failed: %d", rc);
+        return rc;
+    }
+    stats.depth++;
+    stats.spooled++;
+    return 0;
+}
+
+/**
+ * @brief Moves the cursor to the next unread entry and reads it into `record`.
+ * @return Entry length, 0 if the spool is empty, -EIO if the entry is unreadable.
+ */
+static int read_next(void) {
+    struct fcb_entry next = drain_loc;
+
+    if (stats.depth == 0) {
+        return 0;
+    }
+    if (fcb_getnext(&spool_fcb, &next) != 0) {
+        // Counter out of step with the flash (e.g. a torn write): trust the flash
+        stats.depth = 0;
+        return 0;
+    }
+    if (drain_loc.fe_sector != NULL && next.fe_sector != drain_loc.fe_sector) {
+        // Every entry of the previous (oldest) sector was read: release it
+        fcb_rotate(&spool_fcb);
+        read_in_sector = 0;
+    }
+    drain_loc = next;
+    read_in_sector++;
+    stats.depth--;
+    stats.drained++;
+
+    if (next.fe_data_len < sizeof(spool_record_hdr_t) || next.fe_data_len > sizeof(record) ||
+        flash_area_read(spool_fcb.fap, FCB_ENTRY_FA_DATA_OFF(next), record, next.fe_data_len) != 0) {
+        return -EIO;
+    }
+    return next.fe_data_len;
+}
+
+bool serial_spool_pop(server_message_t *msg) {
+    spool_record_hdr_t hdr;
+    int len;
+
+    if (!spool_ready) {
+        return false;
+    }
+    // Damaged entries are skipped, the next one is tried
+    while ((len = read_next()) != 0) {
+        if (len < 0) {
+            LOG_WRN("[SPOOL] Unreadable entry skipped");
+            continue;
+        }
+        memcpy(&hdr, record, sizeof(hdr));
+        if (hdr.ip_len >= sizeof(msg->source_ip) || hdr.payload_len > sizeof(msg->json_payload) ||
+            sizeof(hdr) + hdr.ip_len + hdr.payload_len > (size_t)len) {
+            LOG_WRN("[SPOOL] Corrupt entry skipped");
+            continue;
+        }
+        memcpy(msg->source_ip, record + sizeof(hdr), hdr.ip_len);
+        msg->source_ip[hdr.ip_len] = '\0';
+        memcpy(msg->json_payload, record + sizeof(hdr) + hdr.ip_len, hdr.payload_len);
+        if (hdr.payload_len < sizeof(msg->json_payload)) {
+            msg->json_payload[hdr.payload_len] = '\0';
+        }
+        msg->batch_len = hdr.batch_len;
+        break;
+    }
+
+    if (stats.depth == 0 && drain_loc.fe_sector != NULL) {
+        // Caught up: read_next() already released the older sectors, release
+        // the cursor's one too (one sector erase), so a reset does not replay it
+        if (drain_loc.fe_sector == spool_fcb.f_oldest) {
+            fcb_rotate(&spool_fcb);
+        }
+        drain_loc.fe_sector = NULL;
+        read_in_sector = 0;
+    }
+    return len > 0;
+}
+
+uint32_t serial_spool_depth(void) {
+    return stats.depth;
+}
+
+void serial_spool_get_stats(serial_spool_stats_t *out) {
+    *out = stats;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file serial_spool.h
+ * @brief Flash Spool of the Serial Bridge (CONFIG_APP_SERIAL_SPOOL)
+ * * While the host is not reading the data UART (DTR low), the Serial Bridge
+ * appends its messages here instead of writing them to the UART, and drains
+ * the spool in order once the host is back.
+ * * Storage: a Flash Circular Buffer (FCB) on `spool_partition`. A message
+ * is one FCB entry: a header, the source IP, then the JSON text or the raw
+ * /batch frame. When the partition is full the oldest sector is erased, so
+ * the spool keeps the newest messages and counts the lost ones.
+ * * Entries are released a sector at a time once drained. After a reset the
+ * spool resumes from its oldest sector: messages of a partly drained sector
+ * can be written to the UART twice, none is lost.
+ * * Not thread-safe: only the Serial Bridge (thread or work item) calls it.
+ */
+#ifndef SERIAL_SPOOL_H
+#define SERIAL_SPOOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "shared_types.h"
+
+/**
+ * @brief Spool counters, for the depth and catch-up reports.
+ */
+typedef struct {
+    uint32_t depth;         /**< Messages waiting in flash */
+    uint32_t spooled;       /**< Messages appended since boot */
+    uint32_t drained;       /**< Messages read back since boot */
+    uint32_t lost;          /**< Messages erased unread (spool full) */
+} serial_spool_stats_t;
+
+/**
+ * @brief Mounts the FCB and counts the messages left from before a reset.
+ * @return 0 on success, a negative errno if the spool is unusable.
+ */
+int serial_spool_init(void);
+
+/**
+ * @brief Appends one message. Erases the oldest sector if the spool is full.
+ * @return 0 on success, a negative errno on a flash error.
+ */
+int serial_spool_append(const server_message_t *msg);
+
+/**
+ * @brief Reads the oldest unread message.
+ * @param[out] msg The message (json_payload NUL-terminated for JSON text).
+ * @return true if a message was read, false if the spool is empty.
+ */
+bool serial_spool_pop(server_message_t *msg);
+
+/**
+ * @brief Messages waiting in flash.
+ */
+uint32_t serial_spool_depth(void);
+
+/**
+ * @brief Current counters.
+ */
+void serial_spool_get_stats(serial_spool_stats_t *stats);
+
+#endif
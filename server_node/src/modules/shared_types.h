@@ -11,9 +11,11 @@
 #ifndef SHARED_TYPES_H
 #define SHARED_TYPES_H
 
+#include <stdint.h>
+
 /**
  * @brief The Standard Message Envelope.
- * * This structure is used in the main 'server_queue'.
+ * * This structure is published on the 'server_bus' (message_bus.h).
  * It acts as a container for data moving from the radio (CoAP) 
  * to the output (Serial Console).
  */
@@ -30,6 +32,13 @@ typedef struct {
      * Used for identifying which sensor sent the data.
      */
     char source_ip[64];     
+
+    /** * @brief Length of a /batch frame stored in json_payload.
+     * 0 for JSON text. Otherwise json_payload holds the raw batch frame
+     * (room name, flags, ts_codec series) and the Serial Bridge expands it
+     * into one [DATA] line per sample.
+     */
+    uint16_t batch_len;
 } server_message_t;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+/**
+ * @file time_beacon.c
+ * @brief Implementation of the Fleet Time Beacon
+ */
+#include "time_beacon.h"
+#include "shared_types.h"
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <stdio.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(time_beacon, LOG_LEVEL_INF);
+
+#if defined(CONFIG_APP_TIME_BEACON)
+#include <zephyr/net/openthread.h>
+#include <openthread/coap.h>
+
+// --- Configuration ---
+#define COAP_PORT 5683
+#define BEACON_GROUP "ff03::1"      /**< Realm-Local All Nodes (the whole Thread mesh) */
+#define BEACON_FIRST_DELAY_S 2      /**< First beacon shortly after boot */
+
+// --- Globals ---
+static message_bus_t *outgoing_bus;
+static uint32_t beacon_seq;
+
+/**
+ * @brief Writes "t" (fleet seconds, millisecond resolution) without 64-bit printf support.
+ */
+static int format_beacon(char *buf, size_t size, const char *prefix, int64_t fleet_ms, uint32_t seq) {
+    return snprintf(buf, size, "%s\"t\":%lu.%03u,\"seq\":%u}", prefix,
+                    (unsigned long)(fleet_ms / 1000), (unsigned int)(fleet_ms % 1000), seq);
+}
+
+/**
+ * @brief Multicasts one beacon. Runs on the system work queue, so the
+ * OpenThread API is locked around the send.
+ */
+static otError send_beacon(int64_t *sent_ms) {
+    struct openthread_context *ot_context = openthread_get_default_context();
+    otInstance *instance = openthread_get_default_instance();
+    otMessageInfo message_info;
+    otMessage *message;
+    otError error;
+    char payload[40];
+
+    openthread_api_mutex_lock(ot_context);
+    do {
+        message = otCoapNewMessage(instance, NULL);
+        if (message == NULL) {
+            error = OT_ERROR_NO_BUFS;
+            break;
+        }
+        otCoapMessageInit(message, OT_COAP_TYPE_NON_CONFIRMABLE, OT_COAP_CODE_PUT);
+        otCoapMessageAppendUriPathOptions(message, TIME_BEACON_URI_PATH);
+        otCoapMessageAppendContentFormatOption(message, OT_COAP_OPTION_CONTENT_FORMAT_JSON);
+        otCoapMessageSetPayloadMarker(message);
+
+        // Stamped as late as possible, right before the message leaves
+        *sent_ms = k_uptime_get();
+        int len = format_beacon(payload, sizeof(payload), "{", *sent_ms, beacon_seq);
+        error = otMessageAppend(message, payload, (uint16_t)len);
+        if (error != OT_ERROR_NONE) {
+            break;
+        }
+
+        memset(&message_info, 0, sizeof(message_info));
+        otIp6AddressFromString(BEACON_GROUP, &message_info.mPeerAddr);
+        message_info.mPeerPort = COAP_PORT;
+        error = otCoapSendRequest(instance, message, &message_info, NULL, NULL);
+    } while (false);
+
+    if (error != OT_ERROR_NONE && message != NULL) {
+        otMessageFree(message);
+    }
+    openthread_api_mutex_unlock(ot_context);
+    return error;
+}
+
+static void time_beacon_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(time_beacon_work, time_beacon_handler);
+
+static void time_beacon_handler(struct k_work *work) {
+    int64_t sent_ms = 0;
+    otError error = send_beacon(&sent_ms);
+
+    if (error != OT_ERROR_NONE) {
+        LOG_WRN("[TIME] Beacon %u not sent: %d", beacon_seq, error);
+    } else {
+        // Host side of the mapping: same fleet time, on the data UART
+        server_message_t msg = {.batch_len = 0};
+        strncpy(msg.source_ip, BEACON_GROUP, sizeof(msg.source_ip));
+        format_beacon(msg.json_payload, sizeof(msg.json_payload), "{\"event\":\"time_beacon\",", sent_ms, beacon_seq);
+        if (message_bus_publish(outgoing_bus, &msg) != 0) {
+            LOG_WRN("[TIME] Bus full! Dropping time_beacon event %u", beacon_seq);
+        }
+        LOG_DBG("[TIME] Beacon %u at %lld ms", beacon_seq, sent_ms);
+        beacon_seq++;
+    }
+    k_work_reschedule(&time_beacon_work, K_SECONDS(CONFIG_APP_TIME_BEACON_INTERVAL_S));
+}
+
+void time_beacon_start(message_bus_t *bus) {
+    outgoing_bus = bus;
+    k_work_reschedule(&time_beacon_work, K_SECONDS(BEACON_FIRST_DELAY_S));
+    LOG_INF("[TIME] Beacon every %d s to [%s]/%s", CONFIG_APP_TIME_BEACON_INTERVAL_S, BEACON_GROUP,
+            TIME_BEACON_URI_PATH);
+}
+
+#else
+
+void time_beacon_start(message_bus_t *bus) {}
+
+#endif
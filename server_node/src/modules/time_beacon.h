@@ -0,0 +1,33 @@
+/**
+ * @file time_beacon.h
+ * @brief Fleet Time Beacon (CONFIG_APP_TIME_BEACON)
+ * * The server is the fleet clock: every CONFIG_APP_TIME_BEACON_INTERVAL_S it
+ * multicasts a Non-confirmable CoAP PUT to coap://[ff03::1]/time (every
+ * Thread node, sleepy children through their parent) carrying its uptime:
+ *   {"t":1234.567,"seq":42}   (fleet seconds, millisecond resolution)
+ * * Sensor nodes keep their offset to this clock and stamp samples with it
+ * ("ts" in the payloads), so mesh, queue and batching delay no longer move
+ * a sample in time.
+ * * Each beacon is also written to the data UART as a time_beacon event, so
+ * the host maps fleet time to wall-clock time from the line it just read.
+ */
+#ifndef TIME_BEACON_H
+#define TIME_BEACON_H
+
+#include <zephyr/kernel.h>
+#include "message_bus.h"
+
+/**
+ * @brief CoAP resource of the beacon on the sensor nodes.
+ */
+#define TIME_BEACON_URI_PATH "time"
+
+/**
+ * @brief Starts the periodic beacon on the system work queue.
+ * No-op unless CONFIG_APP_TIME_BEACON is enabled. Call after network_listener_init()
+ * (the CoAP service must be running).
+ * @param bus server_bus, for the time_beacon events on the data UART.
+ */
+void time_beacon_start(message_bus_t *bus);
+
+#endif
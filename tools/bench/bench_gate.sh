@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+# @file bench_gate.sh
+# @brief CI gate of the benchmark suite: fails when a result exceeds its budget.
+#
+# native_sim does not enforce the budgets inside the test (host timings,
+# CONFIG_BENCH_ENFORCE_BUDGETS=n), so the gate is bench_report.py on the
+# twister log: it exits with 1 when a result is over its budget in
+# benchmarks/budgets.json by more than the tolerance.
+#
+# Usage: bench_gate.sh [PLATFORM] [TOLERANCE_PCT]
+#   PLATFORM       twister platform (default native_sim)
+#   TOLERANCE_PCT  allowed excess over the budget (default 20)
+# Run from the repository root.
+set -euo pipefail
+
+PLATFORM=${1:-native_sim}
+TOLERANCE=${2:-20}
+OUT=twister-out-bench
+
+west twister -T benchmarks -p "$PLATFORM" -O "$OUT"
+
+LOG=$(find "$OUT" -path '*aeris.benchmarks*' -name handler.log | head -n 1)
+if [ -z "$LOG" ]; then
+    echo "No handler.log of aeris.benchmarks in $OUT" >&2
+    exit 1
+fi
+python3 tools/bench/bench_report.py "$LOG" --tolerance "$TOLERANCE" --json "$OUT/bench_results.json"
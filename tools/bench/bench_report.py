@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""
+@file bench_report.py
+@brief Collects the BENCH lines of a benchmark run into JSON and compares them with the budgets.
+
+Input is the console output of benchmarks/ (zephyr.exe output, a serial
+capture, or twister's handler.log), each result being one line:
+  BENCH {"name":"vtt_update","unit":"ns","per_op":27.4,"iterations":1000,"rounds":7}
+
+Usage:
+  bench_report.py handler.log --board native_sim [--json results.json]
+  bench_report.py handler.log --board nrf52840dk/nrf52840 --update [--headroom 1.5]
+
+Exit status is 1 if a result exceeds its budget by more than --tolerance
+percent (same check as the on-target assertion). --update writes
+result x headroom as the new budgets of the board instead.
+"""
+import argparse
+import json
+import re
+import sys
+
+BENCH_LINE = re.compile(r'BENCH (\{.*\})')
+BOARD_LINE = re.compile(r'Benchmarks on (\S+), unit')
+
+
+def read_results(paths):
+    """Returns (board or None, {name: result})."""
+    board = None
+    results = {}
+    for path in paths:
+        with (sys.stdin if path == '-' else open(path, errors='replace')) as handle:
+            for line in handle:
+                match = BOARD_LINE.search(line)
+                if match:
+                    board = match.group(1)
+                match = BENCH_LINE.search(line)
+                if match:
+                    result = json.loads(match.group(1))
+                    results[result['name']] = result
+    return board, results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('logs', nargs='+', help="console logs ('-' for stdin)")
+    parser.add_argument('--budgets', default='benchmarks/budgets.json')
+    parser.add_argument('--board', help='budget entry (default: the board named in the log)')
+    parser.add_argument('--json', help='write the results to this file')
+    parser.add_argument('--tolerance', type=float, default=20.0, help='allowed excess in percent')
+    parser.add_argument('--update', action='store_true', help='rewrite the budgets of the board')
+    parser.add_argument('--headroom', type=float, default=1.5, help='budget = result x headroom with --update')
+    args = parser.parse_args()
+
+    log_board, results = read_results(args.logs)
+    board = args.board or log_board
+    if not results:
+        sys.exit('No BENCH lines found')
+    if not board:
+        sys.exit('Board not found in the log, pass --board')
+
+    if args.json:
+        with open(args.json, 'w') as handle:
+            json.dump({'board': board, 'results': results}, handle, indent=2)
+
+    with open(args.budgets) as handle:
+        budgets = json.load(handle)
+
+    if args.update:
+        unit = next(iter(results.values()))['unit']
+        entry = budgets.setdefault(board, {'unit': unit})
+        entry['unit'] = unit
+        entry['budgets'] = {name: round(r['per_op'] * args.headroom) for name, r in sorted(results.items())}
+        with open(args.budgets, 'w') as handle:
+            json.dump(budgets, handle, indent=2)
+            handle.write('\n')
+        print(f'Updated {len(results)} budgets of {board} in {args.budgets}')
+        return
+
+    entry = budgets.get(board, {})
+    limits = entry.get('budgets', {})
+    failed = 0
+    print(f'{"benchmark":<26} {"per op":>10} {"budget":>10} {"ratio":>7}  [{board}]')
+    for name, result in sorted(results.items()):
+        budget = limits.get(name)
+        if budget is None:
+            print(f'{name:<26} {result["per_op"]:>10.1f} {"-":>10} {"-":>7}  no budget')
+            continue
+        ratio = result['per_op'] / budget
+        over = ratio > 1.0 + args.tolerance / 100.0
+        failed += over
+        print(f'{name:<26} {result["per_op"]:>10.1f} {budget:>10} {ratio:>7.2f}  {"OVER BUDGET" if over else ""}')
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+    main()
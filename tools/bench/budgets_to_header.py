@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""
+@file budgets_to_header.py
+@brief Turns the budgets of one board in benchmarks/budgets.json into a C header.
+
+The board is looked up by its full name (nrf52840dk/nrf52840), then by its
+name without qualifiers (nrf52840dk). A board without budgets gets an empty
+table: the benchmarks still run and report, nothing is checked.
+
+Usage:
+  budgets_to_header.py budgets.json <board> bench_budgets.h
+"""
+import argparse
+import json
+import os
+
+
+def find_board(budgets, board):
+    """Returns (key, entry) for the board, or (board, None)."""
+    for key in (board, board.split('/')[0]):
+        if key in budgets:
+            return key, budgets[key]
+    for key, entry in budgets.items():
+        if key.split('/')[0] == board.split('/')[0]:
+            return key, entry
+    return board, None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('budgets')
+    parser.add_argument('board')
+    parser.add_argument('output')
+    args = parser.parse_args()
+
+    with open(args.budgets) as handle:
+        budgets = json.load(handle)
+    key, entry = find_board(budgets, args.board)
+
+    lines = [
+        '/* Generated by tools/bench/budgets_to_header.py from budgets.json, do not edit */',
+        '#ifndef BENCH_BUDGETS_H',
+        '#define BENCH_BUDGETS_H',
+        '',
+        '#include <stddef.h>',
+        '#include <stdint.h>',
+        '',
+        f'#define BENCH_BUDGET_BOARD "{key}"',
+        f'#define BENCH_BUDGET_UNIT "{entry["unit"] if entry else ""}"',
+        '',
+        'struct bench_budget {',
+        '    const char *name;',
+        '    uint32_t per_op;',
+        '};',
+        '',
+        'static const struct bench_budget bench_budgets[] = {',
+    ]
+    for name, per_op in sorted((entry or {}).get('budgets', {}).items()):
+        lines.append(f'    {{"{name}", {int(per_op)}}},')
+    lines.append('    {NULL, 0}, /* Sentinel: keeps the table non-empty */')
+    lines += ['};', '', '#endif', '']
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, 'w') as handle:
+        handle.write('\n'.join(lines))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,28 @@
+#!/usr/bin/env bash
+# @file decode_rtt.sh
+# @brief Captures AERIS dictionary logs over J-Link RTT and decodes them.
+#
+# The firmware (built with overlay-dictlog.conf) only sends format string ids
+# and raw arguments. This script records the binary RTT stream until Ctrl-C,
+# then formats it with Zephyr's dictionary log parser and the
+# log_dictionary.json of the same build.
+#
+# Usage: decode_rtt.sh BUILD_DIR [RTT_CHANNEL] [DEVICE]
+#   BUILD_DIR    west build directory of the flashed image
+#   RTT_CHANNEL  0 for the sensor nodes, 1 for the server node (default 0)
+#   DEVICE       J-Link device name (default NRF52840_XXAA)
+set -euo pipefail
+
+BUILD_DIR=${1:?usage: decode_rtt.sh BUILD_DIR [RTT_CHANNEL] [DEVICE]}
+CHANNEL=${2:-0}
+DEVICE=${3:-NRF52840_XXAA}
+DATABASE="$BUILD_DIR/zephyr/log_dictionary.json"
+CAPTURE=$(mktemp --suffix=.bin)
+
+: "${ZEPHYR_BASE:?ZEPHYR_BASE must point to the Zephyr tree used for the build}"
+[ -f "$DATABASE" ] || { echo "No $DATABASE, was the image built with overlay-dictlog.conf?" >&2; exit 1; }
+
+echo "Capturing RTT channel $CHANNEL to $CAPTURE, Ctrl-C to stop and decode..."
+JLinkRTTLogger -Device "$DEVICE" -If SWD -Speed 4000 -RTTChannel "$CHANNEL" "$CAPTURE" || true
+
+python3 "$ZEPHYR_BASE/scripts/logging/dictionary/log_parser.py" "$DATABASE" "$CAPTURE"
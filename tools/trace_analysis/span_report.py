@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""
+@file span_report.py
+@brief Per-stage latency report for AERIS CTF traces.
+
+Reads a Zephyr CTF trace (captured with overlay-tracing.conf, usually on
+native_sim), pairs the BEGIN/END markers emitted by trace_spans.h per thread
+and prints:
+  1. A log2 latency histogram for every span name.
+  2. A critical-path breakdown for every root span (one service iteration),
+     splitting its time into child stages, preemption/blocking and self time.
+
+Usage:
+  span_report.py TRACE_DIR                       # runs babeltrace2 on TRACE_DIR
+  babeltrace2 --clock-seconds TRACE_DIR | span_report.py -
+  span_report.py TRACE_DIR --json stats.json     # save stats for later runs
+  span_report.py TRACE_DIR --baseline stats.json --tolerance 20
+
+With --baseline the script exits with code 1 if any stage's p95 latency grew
+by more than --tolerance percent, so it can gate CI before flashing.
+
+@note TRACE_DIR must contain the Zephyr CTF metadata file
+      ($ZEPHYR_BASE/subsys/tracing/ctf/tsdl/metadata) next to channel0_0.
+"""
+import argparse
+import json
+import re
+import subprocess
+import sys
+from collections import defaultdict
+
+PHASE_BEGIN = 0
+PHASE_END = 1
+
+# [12.345678901] or [00:00:12.345678901], optionally followed by (+delta)
+LINE_RE = re.compile(r'^\[(?P<ts>[^\]]+)\]\s+(?:\([^)]*\)\s+)?(?P<event>\w+):\s*(?P<body>.*)$')
+FIELD_RE = re.compile(r'(\w+)\s*=\s*("(?:[^"\\]|\\.)*"|[^,}\s]+)')
+
+
+def parse_timestamp_us(text):
+    """Converts a babeltrace2 timestamp to microseconds."""
+    seconds = 0.0
+    for part in text.split(':'):
+        seconds = seconds * 60.0 + float(part)
+    return seconds * 1e6
+
+
+def parse_fields(body):
+    fields = {}
+    for key, value in FIELD_RE.findall(body):
+        if value.startswith('"'):
+            fields[key] = value[1:-1]
+        else:
+            try:
+                fields[key] = int(value, 0)
+            except ValueError:
+                fields[key] = value
+    return fields
+
+
+def read_events(source):
+    """Yields (timestamp_us, event_name, fields) from babeltrace2 text output."""
+    if source == '-':
+        stream = sys.stdin
+    else:
+        proc = subprocess.Popen(['babeltrace2', '--clock-seconds', source],
+                                stdout=subprocess.PIPE, text=True)
+        stream = proc.stdout
+    for line in stream:
+        match = LINE_RE.match(line.strip())
+        if not match:
+            continue
+        yield (parse_timestamp_us(match.group('ts')), match.group('event'),
+               parse_fields(match.group('body')))
+
+
+class Span:
+    __slots__ = ('name', 'thread', 'start', 'end', 'parent', 'children',
+                 'off_cpu_start', 'off_cpu', 'result')
+
+    def __init__(self, name, thread, start, parent, off_cpu_start):
+        self.name = name
+        self.thread = thread
+        self.start = start
+        self.end = None
+        self.parent = parent
+        self.children = []
+        self.off_cpu_start = off_cpu_start
+        self.off_cpu = 0.0
+        self.result = 0
+
+    @property
+    def duration(self):
+        return self.end - self.start
+
+
+def collect_spans(events):
+    """Pairs span markers per thread and tracks time spent switched out."""
+    current = 'unknown'
+    switched_out_at = {}
+    off_cpu_total = defaultdict(float)
+    stacks = defaultdict(list)
+    spans = []
+    unmatched = 0
+
+    for ts, event, fields in events:
+        if event == 'thread_switched_out':
+            thread = fields.get('name') or str(fields.get('thread_id', current))
+            switched_out_at[thread] = ts
+        elif event == 'thread_switched_in':
+            current = fields.get('name') or str(fields.get('thread_id', 'unknown'))
+            if current in switched_out_at:
+                off_cpu_total[current] += ts - switched_out_at.pop(current)
+        elif event == 'named_event':
+            name = fields.get('name', '?')
+            stack = stacks[current]
+            if fields.get('arg0') == PHASE_BEGIN:
+                parent = stack[-1] if stack else None
+                stack.append(Span(name, current, ts, parent, off_cpu_total[current]))
+            elif fields.get('arg0') == PHASE_END:
+                # Pop up to the matching BEGIN, dropping markers lost in the trace
+                for depth in range(len(stack) - 1, -1, -1):
+                    if stack[depth].name == name:
+                        span = stack[depth]
+                        unmatched += len(stack) - depth - 1
+                        del stack[depth:]
+                        span.end = ts
+                        span.off_cpu = off_cpu_total[current] - span.off_cpu_start
+                        span.result = fields.get('arg1', 0)
+                        if span.parent is not None:
+                            span.parent.children.append(span)
+                        spans.append(span)
+                        break
+                else:
+                    unmatched += 1
+    return spans, unmatched
+
+
+def percentile(sorted_values, pct):
+    if not sorted_values:
+        return 0.0
+    index = min(len(sorted_values) - 1, int(round(pct / 100.0 * (len(sorted_values) - 1))))
+    return sorted_values[index]
+
+
+def stage_stats(spans):
+    by_name = defaultdict(list)
+    for span in spans:
+        by_name[span.name].append(span.duration)
+    stats = {}
+    for name, values in by_name.items():
+        values.sort()
+        stats[name] = {
+            'count': len(values),
+            'mean_us': sum(values) / len(values),
+            'p50_us': percentile(values, 50),
+            'p95_us': percentile(values, 95),
+            'max_us': values[-1],
+        }
+    return stats, by_name
+
+
+def print_histograms(by_name):
+    print('=== Per-Stage Latency Histograms (us) ===')
+    for name in sorted(by_name):
+        values = by_name[name]
+        buckets = defaultdict(int)
+        for value in values:
+            bucket = 0
+            while (1 << (bucket + 1)) <= max(value, 1):
+                bucket += 1
+            buckets[bucket] += 1
+        print(f'\n{name} (n={len(values)})')
+        peak = max(buckets.values())
+        for bucket in range(min(buckets), max(buckets) + 1):
+            count = buckets.get(bucket, 0)
+            bar = '#' * max(1 if count else 0, int(40 * count / peak))
+            print(f'  {1 << bucket:>9} .. {(1 << (bucket + 1)) - 1:<9} {count:>6} {bar}')
+
+
+def print_critical_path(spans):
+    print('\n=== Critical Path Breakdown (mean per iteration) ===')
+    roots = defaultdict(list)
+    for span in spans:
+        if span.parent is None:
+            roots[span.name].append(span)
+
+    for root_name in sorted(roots):
+        iterations = roots[root_name]
+        count = len(iterations)
+        total = sum(s.duration for s in iterations) / count
+        parts = defaultdict(float)
+        blocked = 0.0
+        for root in iterations:
+            child_off_cpu = 0.0
+            for child in root.children:
+                parts[child.name] += child.duration / count
+                child_off_cpu += child.off_cpu
+            blocked += (root.off_cpu - child_off_cpu) / count
+        self_time = total - sum(parts.values()) - blocked
+        parts['(preempted/blocked)'] = blocked
+        parts['(self)'] = max(self_time, 0.0)
+
+        print(f'\n{root_name} (n={count}, thread={iterations[0].thread}, mean={total:.1f} us)')
+        for stage, value in sorted(parts.items(), key=lambda kv: -kv[1]):
+            share = 100.0 * value / total if total else 0.0
+            print(f'  {stage:<22} {value:>12.1f} us  {share:5.1f} %')
+
+
+def compare_baseline(stats, baseline_path, tolerance):
+    with open(baseline_path) as handle:
+        baseline = json.load(handle)
+    regressions = []
+    print(f'\n=== Baseline Comparison (tolerance {tolerance:.0f} %) ===')
+    for name, base in sorted(baseline.items()):
+        if name not in stats:
+            print(f'  {name:<22} missing from this trace')
+            continue
+        old, new = base['p95_us'], stats[name]['p95_us']
+        change = 100.0 * (new - old) / old if old else 0.0
+        flag = 'REGRESSION' if change > tolerance else 'ok'
+        print(f'  {name:<22} p95 {old:>10.1f} -> {new:>10.1f} us ({change:+6.1f} %) {flag}')
+        if change > tolerance:
+            regressions.append(name)
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('trace', help="CTF trace directory, or '-' for babeltrace2 text on stdin")
+    parser.add_argument('--json', metavar='FILE', help='write per-stage stats as JSON')
+    parser.add_argument('--baseline', metavar='FILE', help='stats JSON from a previous run')
+    parser.add_argument('--tolerance', type=float, default=20.0,
+                        help='allowed p95 growth in percent (default 20)')
+    args = parser.parse_args()
+
+    spans, unmatched = collect_spans(read_events(args.trace))
+    if not spans:
+        sys.exit('No span markers found. Was the firmware built with overlay-tracing.conf?')
+
+    stats, by_name = stage_stats(spans)
+    print_histograms(by_name)
+    print_critical_path(spans)
+    if unmatched:
+        print(f'\nWarning: {unmatched} span markers without a partner (trace dropped events?)')
+
+    if args.json:
+        with open(args.json, 'w') as handle:
+            json.dump(stats, handle, indent=2, sort_keys=True)
+
+    if args.baseline and compare_baseline(stats, args.baseline, args.tolerance):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
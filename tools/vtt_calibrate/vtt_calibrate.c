@@ -0,0 +1,615 @@
+/**
+ * @file vtt_calibrate.c
+ * @brief Fits the VTT decline rates and rh_mat offsets against reference data.
+ * * Links the firmware's vtt_model.c unchanged. A dataset is a CSV climate
+ * trace (the weather_replay columns) with an extra mold_index column that is
+ * filled where the mold index was observed:
+ *
+ *     time_h,temperature_c,humidity_pct,mold_index
+ *     0,28.0,95.0,0
+ *     1,28.0,95.0,
+ *
+ * Each dataset belongs to one material class (argument "material:file.csv").
+ * The fit is a zooming grid search: every round evaluates G x G grid points of
+ * (decline_short, decline_long) times G values of rh_mat per material, keeps
+ * the best point and shrinks the box around it. The evaluations run on a
+ * thread pool (one worker per core, tasks taken from an atomic counter).
+ * The input terms of every row do not depend on the parameters, so they are
+ * computed once per dataset and each evaluation only runs vtt_step().
+ *
+ * The result is printed as #defines for the calibration block of vtt_model.h.
+ *
+ * --emit simulates a trace with given parameters and prints it as a dataset,
+ * to check that a fit recovers known constants.
+ */
+#include "vtt_model.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// * --- CONFIGURATION --- *
+#define MATERIAL_COUNT      3
+#define MAX_DATASETS        64
+#define LINE_MAX_LEN        512
+#define TASK_CHUNK          16      // Tasks taken per counter increment
+
+// Search box (decline rates 1/h, rh_mat %)
+#define DECLINE_SHORT_MIN   -0.01f
+#define DECLINE_SHORT_MAX   0.0f
+#define DECLINE_LONG_MIN    -0.005f
+#define DECLINE_LONG_MAX    0.0f
+#define RH_MAT_MIN          -5.0f
+#define RH_MAT_MAX          15.0f
+
+static const char *material_names[MATERIAL_COUNT] = {"sensitive", "medium", "resistant"};
+static const char *material_defines[MATERIAL_COUNT] = {
+    "VTT_RH_MAT_SENSITIVE", "VTT_RH_MAT_MEDIUM_RESISTANT", "VTT_RH_MAT_RESISTANT"};
+
+/**
+ * @brief One row of a dataset with its precomputed model input.
+ */
+typedef struct {
+    float time_h;               /**< Hours since the trace start */
+    float dt_h;                 /**< Hours since the previous row (0 for the first) */
+    float temp_c;               /**< Temperature as read */
+    float rh_pct;               /**< Relative Humidity as read */
+    vtt_temp_terms_t t;
+    vtt_rh_terms_t rh;
+    float observed;             /**< Observed mold index, NAN if none */
+} row_t;
+
+typedef struct {
+    const char *path;
+    vtt_material_t material;
+    row_t *rows;
+    size_t count;
+    size_t observations;
+} dataset_t;
+
+/**
+ * @brief Parameters of one evaluation.
+ */
+typedef struct {
+    float decline_short;
+    float decline_long;
+    float rh_mat;
+} params_t;
+
+/**
+ * @brief Search box of one round: grid points per axis and their values.
+ */
+typedef struct {
+    int points;
+    float *decline_short;
+    float *decline_long;
+    float *rh_mat[MATERIAL_COUNT];
+} grid_t;
+
+/**
+ * @brief Shared state of the thread pool for one round.
+ */
+typedef struct {
+    const grid_t *grid;
+    const dataset_t *datasets;
+    int dataset_count;
+    const int *materials;       /**< Materials with at least one dataset */
+    int material_count;
+    size_t task_count;
+    atomic_size_t next_task;
+    double *sse;                /**< [short][long][rh][material] sum of squared errors */
+} pool_t;
+
+// * --- DATASETS --- *
+
+static int parse_material(const char *name, vtt_material_t *mat) {
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        if (strcmp(name, material_names[m]) == 0) {
+            *mat = (vtt_material_t)m;
+            return 0;
+        }
+    }
+    return -EINVAL;
+}
+
+/**
+ * @brief Splits a CSV line in place (no quoting, as written by loggers and csv_to_wtr.py).
+ * @return Number of fields.
+ */
+static int split_csv(char *line, char **fields, int max) {
+    int n = 0;
+    char *p = line;
+
+    line[strcspn(line, "\r\n")] = '\0';
+    while (n < max) {
+        fields[n++] = p;
+        p = strchr(p, ',');
+        if (p == NULL) {
+            break;
+        }
+        *p++ = '\0';
+    }
+    return n;
+}
+
+static int column_index(char **fields, int n, const char *name) {
+    for (int i = 0; i < n; i++) {
+        if (strcmp(fields[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int load_dataset(dataset_t *ds, const char *path, vtt_material_t mat) {
+    char line[LINE_MAX_LEN];
+    char *fields[16];
+    size_t capacity = 1024;
+
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -errno;
+    }
+
+    memset(ds, 0, sizeof(*ds));
+    ds->path = path;
+    ds->material = mat;
+
+    if (fgets(line, sizeof(line), f) == NULL) {
+        fprintf(stderr, "%s: empty file\n", path);
+        fclose(f);
+        return -EINVAL;
+    }
+    int n = split_csv(line, fields, 16);
+    int col_h = column_index(fields, n, "time_h");
+    int col_s = column_index(fields, n, "time_s");
+    int col_t = column_index(fields, n, "temperature_c");
+    int col_rh = column_index(fields, n, "humidity_pct");
+    int col_m = column_index(fields, n, "mold_index");
+    if ((col_h < 0 && col_s < 0) || col_t < 0 || col_rh < 0) {
+        fprintf(stderr, "%s: needs time_h or time_s, temperature_c and humidity_pct columns\n", path);
+        fclose(f);
+        return -EINVAL;
+    }
+
+    ds->rows = malloc(capacity * sizeof(row_t));
+    float last_h = 0.0f;
+    while (ds->rows != NULL && fgets(line, sizeof(line), f) != NULL) {
+        n = split_csv(line, fields, 16);
+        if (n <= col_t || n <= col_rh || n <= (col_h >= 0 ? col_h : col_s)) {
+            continue;
+        }
+        if (ds->count == capacity) {
+            capacity *= 2;
+            row_t *grown = realloc(ds->rows, capacity * sizeof(row_t));
+            if (grown == NULL) {
+                break;
+            }
+            ds->rows = grown;
+        }
+
+        float time_h = (col_h >= 0) ? strtof(fields[col_h], NULL) : strtof(fields[col_s], NULL) / 3600.0f;
+        row_t *row = &ds->rows[ds->count];
+        row->time_h = time_h;
+        row->dt_h = (ds->count == 0) ? 0.0f : time_h - last_h;
+        row->temp_c = strtof(fields[col_t], NULL);
+        row->rh_pct = strtof(fields[col_rh], NULL);
+        vtt_temp_terms(row->temp_c, &row->t);
+        vtt_rh_terms(row->rh_pct, &row->rh);
+        row->observed = (col_m >= 0 && col_m < n && fields[col_m][0] != '\0') ? strtof(fields[col_m], NULL) : NAN;
+        ds->observations += isnan(row->observed) ? 0 : 1;
+        last_h = time_h;
+        ds->count++;
+    }
+    fclose(f);
+
+    if (ds->rows == NULL) {
+        fprintf(stderr, "%s: out of memory\n", path);
+        return -ENOMEM;
+    }
+    if (ds->count < 2) {
+        fprintf(stderr, "%s: needs at least two rows\n", path);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+// * --- MODEL EVALUATION --- *
+
+static void apply_params(vtt_state_t *state, vtt_material_t mat, const params_t *p) {
+    vtt_init(state, mat);
+    state->decline_rate_short = p->decline_short;
+    state->decline_rate_long = p->decline_long;
+    state->rh_mat = p->rh_mat;
+}
+
+/**
+ * @brief Runs one dataset and returns the sum of squared errors at its observations.
+ */
+static double dataset_sse(const dataset_t *ds, const params_t *p) {
+    vtt_state_t state;
+    double sse = 0.0;
+
+    apply_params(&state, ds->material, p);
+    for (size_t i = 0; i < ds->count; i++) {
+        const row_t *row = &ds->rows[i];
+        if (row->dt_h > 0.0f) {
+            vtt_step(&state, &row->t, &row->rh, row->dt_h);
+        }
+        if (!isnan(row->observed)) {
+            double err = state.mold_index - row->observed;
+            sse += err * err;
+        }
+    }
+    return sse;
+}
+
+/**
+ * @brief Worker: takes chunks of tasks until the round is done.
+ * Task index = ((short * G + long) * G + rh) * materials + material.
+ */
+static void *pool_worker(void *arg) {
+    pool_t *pool = arg;
+    const grid_t *g = pool->grid;
+    const size_t G = (size_t)g->points;
+
+    while (1) {
+        size_t first = atomic_fetch_add(&pool->next_task, TASK_CHUNK);
+        if (first >= pool->task_count) {
+            break;
+        }
+        size_t last = (first + TASK_CHUNK < pool->task_count) ? first + TASK_CHUNK : pool->task_count;
+
+        for (size_t task = first; task < last; task++) {
+            size_t m = task % pool->material_count;
+            size_t k = (task / pool->material_count) % G;
+            size_t j = (task / pool->material_count / G) % G;
+            size_t i = task / pool->material_count / G / G;
+            int mat = pool->materials[m];
+            params_t p = {
+                .decline_short = g->decline_short[i],
+                .decline_long = g->decline_long[j],
+                .rh_mat = g->rh_mat[mat][k],
+            };
+
+            double sse = 0.0;
+            for (int d = 0; d < pool->dataset_count; d++) {
+                if ((int)pool->datasets[d].material == mat) {
+                    sse += dataset_sse(&pool->datasets[d], &p);
+                }
+            }
+            pool->sse[task] = sse;
+        }
+    }
+    return NULL;
+}
+
+// * --- SEARCH --- *
+
+static void fill_axis(float *axis, int points, float center, float half, float min, float max) {
+    float lo = fmaxf(center - half, min);
+    float hi = fminf(center + half, max);
+    for (int i = 0; i < points; i++) {
+        axis[i] = lo + (hi - lo) * i / (points - 1);
+    }
+}
+
+/**
+ * @brief Zooming grid search. best[m] holds the start point and receives the result.
+ * @return RMSE over all observations.
+ */
+static double calibrate(const dataset_t *datasets, int dataset_count, int points, int rounds, int threads,
+                        params_t best[MATERIAL_COUNT]) {
+    int materials[MATERIAL_COUNT];
+    int material_count = 0;
+    size_t observations = 0;
+
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        for (int d = 0; d < dataset_count; d++) {
+            if ((int)datasets[d].material == m) {
+                materials[material_count++] = m;
+                break;
+            }
+        }
+    }
+    for (int d = 0; d < dataset_count; d++) {
+        observations += datasets[d].observations;
+    }
+
+    grid_t grid = {.points = points};
+    grid.decline_short = malloc(points * sizeof(float));
+    grid.decline_long = malloc(points * sizeof(float));
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        grid.rh_mat[m] = malloc(points * sizeof(float));
+    }
+    size_t G = (size_t)points;
+    size_t task_count = G * G * G * material_count;
+    double *sse = malloc(task_count * sizeof(double));
+    pthread_t *workers = malloc(threads * sizeof(pthread_t));
+
+    // Round 0 covers the whole box, every next one 2 grid steps around the best point
+    float half_short = DECLINE_SHORT_MAX - DECLINE_SHORT_MIN;
+    float half_long = DECLINE_LONG_MAX - DECLINE_LONG_MIN;
+    float half_rh[MATERIAL_COUNT];
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        half_rh[m] = RH_MAT_MAX - RH_MAT_MIN;
+    }
+    double total = 0.0;
+
+    for (int round = 0; round < rounds; round++) {
+        fill_axis(grid.decline_short, points, best[0].decline_short, half_short, DECLINE_SHORT_MIN, DECLINE_SHORT_MAX);
+        fill_axis(grid.decline_long, points, best[0].decline_long, half_long, DECLINE_LONG_MIN, DECLINE_LONG_MAX);
+        for (int m = 0; m < MATERIAL_COUNT; m++) {
+            fill_axis(grid.rh_mat[m], points, best[m].rh_mat, half_rh[m], RH_MAT_MIN, RH_MAT_MAX);
+        }
+
+        pool_t pool = {
+            .grid = &grid,
+            .datasets = datasets,
+            .dataset_count = dataset_count,
+            .materials = materials,
+            .material_count = material_count,
+            .task_count = task_count,
+            .sse = sse,
+        };
+        atomic_init(&pool.next_task, 0);
+        for (int t = 0; t < threads; t++) {
+            pthread_create(&workers[t], NULL, pool_worker, &pool);
+        }
+        for (int t = 0; t < threads; t++) {
+            pthread_join(workers[t], NULL);
+        }
+
+        // rh_mat is independent per material: best (short, long) over the sum of per-material minima
+        total = INFINITY;
+        for (size_t i = 0; i < G; i++) {
+            for (size_t j = 0; j < G; j++) {
+                double sum = 0.0;
+                size_t best_k[MATERIAL_COUNT] = {0};
+                for (int m = 0; m < material_count; m++) {
+                    double min = INFINITY;
+                    for (size_t k = 0; k < G; k++) {
+                        double v = sse[((i * G + j) * G + k) * material_count + m];
+                        if (v < min) {
+                            min = v;
+                            best_k[m] = k;
+                        }
+                    }
+                    sum += min;
+                }
+                if (sum < total) {
+                    total = sum;
+                    for (int m = 0; m < MATERIAL_COUNT; m++) {
+                        best[m].decline_short = grid.decline_short[i];
+                        best[m].decline_long = grid.decline_long[j];
+                    }
+                    for (int m = 0; m < material_count; m++) {
+                        best[materials[m]].rh_mat = grid.rh_mat[materials[m]][best_k[m]];
+                    }
+                }
+            }
+        }
+
+        fprintf(stderr, "round %d: RMSE %.4f  short %.6f  long %.6f\n", round + 1,
+                sqrt(total / (double)observations), (double)best[0].decline_short, (double)best[0].decline_long);
+        half_short = 2.0f * (grid.decline_short[points - 1] - grid.decline_short[0]) / (points - 1);
+        half_long = 2.0f * (grid.decline_long[points - 1] - grid.decline_long[0]) / (points - 1);
+        for (int m = 0; m < MATERIAL_COUNT; m++) {
+            half_rh[m] = 2.0f * (grid.rh_mat[m][points - 1] - grid.rh_mat[m][0]) / (points - 1);
+        }
+    }
+
+    free(workers);
+    free(sse);
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        free(grid.rh_mat[m]);
+    }
+    free(grid.decline_long);
+    free(grid.decline_short);
+    return sqrt(total / (double)observations);
+}
+
+// * --- OUTPUT --- *
+
+static void write_header(FILE *out, const params_t best[MATERIAL_COUNT], const bool fitted[MATERIAL_COUNT],
+                         int dataset_count, size_t observations, double rmse) {
+    fprintf(out, "/* Fitted by tools/vtt_calibrate: %d datasets, %zu observations, RMSE %.4f */\n",
+            dataset_count, observations, rmse);
+    fprintf(out, "#define VTT_DECLINE_RATE_SHORT          %.6ff\n", (double)best[0].decline_short);
+    fprintf(out, "#define VTT_DECLINE_RATE_LONG           %.6ff\n", (double)best[0].decline_long);
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        fprintf(out, "#define %-31s %.2ff%s\n", material_defines[m], (double)best[m].rh_mat,
+                fitted[m] ? "" : "  /* not fitted: no dataset */");
+    }
+}
+
+/**
+ * @brief --emit: runs a climate trace and prints it with the simulated mold index.
+ */
+static int emit_dataset(const char *path, vtt_material_t mat, const params_t *p, float every_h) {
+    dataset_t ds;
+    vtt_state_t state;
+    float next_obs = 0.0f;
+
+    if (load_dataset(&ds, path, mat) != 0) {
+        return 1;
+    }
+    apply_params(&state, mat, p);
+
+    printf("time_h,temperature_c,humidity_pct,mold_index\n");
+    for (size_t i = 0; i < ds.count; i++) {
+        const row_t *row = &ds.rows[i];
+        if (row->dt_h > 0.0f) {
+            vtt_step(&state, &row->t, &row->rh, row->dt_h);
+        }
+        printf("%g,%.2f,%.2f,", (double)row->time_h, (double)row->temp_c, (double)row->rh_pct);
+        if (row->time_h >= next_obs) {
+            printf("%.4f", (double)state.mold_index);
+            next_obs += every_h;
+        }
+        printf("\n");
+    }
+    free(ds.rows);
+    return 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [options] <material>:<dataset.csv>...\n"
+            "       %s --emit <material>:<trace.csv> [-p name=value]... [-e hours]\n"
+            "  material: sensitive, medium, resistant\n"
+            "  -j N        worker threads (default: online cores)\n"
+            "  -g N        grid points per axis (default 17)\n"
+            "  -r N        zoom rounds (default 4)\n"
+            "  -o file.h   also write the constants to a header\n"
+            "  -p n=v      --emit parameter: decline_short, decline_long, rh_mat\n"
+            "  -e H        --emit observation interval in hours (default 24)\n",
+            argv0, argv0);
+}
+
+static int parse_dataset_arg(char *arg, const char **path, vtt_material_t *mat) {
+    char *sep = strchr(arg, ':');
+    if (sep == NULL) {
+        return -EINVAL;
+    }
+    *sep = '\0';
+    *path = sep + 1;
+    return parse_material(arg, mat);
+}
+
+int main(int argc, char **argv) {
+    static const struct option long_opts[] = {
+        {"emit", required_argument, NULL, 'E'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int points = 17;
+    int rounds = 4;
+    const char *out_path = NULL;
+    char *emit = NULL;
+    float every_h = 24.0f;
+    params_t emit_params = {
+        .decline_short = VTT_DECLINE_RATE_SHORT,
+        .decline_long = VTT_DECLINE_RATE_LONG,
+        .rh_mat = NAN,
+    };
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "j:g:r:o:p:e:h", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 'j': threads = atoi(optarg); break;
+        case 'g': points = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        case 'o': out_path = optarg; break;
+        case 'e': every_h = strtof(optarg, NULL); break;
+        case 'E': emit = optarg; break;
+        case 'p': {
+            char *eq = strchr(optarg, '=');
+            float v = (eq != NULL) ? strtof(eq + 1, NULL) : NAN;
+            if (eq != NULL && strncmp(optarg, "decline_short=", 14) == 0) {
+                emit_params.decline_short = v;
+            } else if (eq != NULL && strncmp(optarg, "decline_long=", 13) == 0) {
+                emit_params.decline_long = v;
+            } else if (eq != NULL && strncmp(optarg, "rh_mat=", 7) == 0) {
+                emit_params.rh_mat = v;
+            } else {
+                fprintf(stderr, "Unknown parameter: %s\n", optarg);
+                return 2;
+            }
+            break;
+        }
+        default:
+            usage(argv[0]);
+            return (opt == 'h') ? 0 : 2;
+        }
+    }
+    if (threads < 1 || points < 3 || rounds < 1 || every_h <= 0.0f) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (emit != NULL) {
+        const char *path;
+        vtt_material_t mat;
+        if (parse_dataset_arg(emit, &path, &mat) != 0) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (isnan(emit_params.rh_mat)) {
+            vtt_state_t defaults;
+            vtt_init(&defaults, mat);
+            emit_params.rh_mat = defaults.rh_mat;
+        }
+        return emit_dataset(path, mat, &emit_params, every_h);
+    }
+
+    dataset_t datasets[MAX_DATASETS];
+    int dataset_count = 0;
+    size_t observations = 0;
+    bool fitted[MATERIAL_COUNT] = {false};
+
+    for (int a = optind; a < argc; a++) {
+        const char *path;
+        vtt_material_t mat;
+        if (dataset_count == MAX_DATASETS || parse_dataset_arg(argv[a], &path, &mat) != 0) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (load_dataset(&datasets[dataset_count], path, mat) != 0) {
+            return 1;
+        }
+        observations += datasets[dataset_count].observations;
+        fitted[mat] = true;
+        dataset_count++;
+    }
+    if (dataset_count == 0 || observations == 0) {
+        fprintf(stderr, "No observations (mold_index column) in the datasets\n");
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Start from the current constants
+    params_t best[MATERIAL_COUNT];
+    for (int m = 0; m < MATERIAL_COUNT; m++) {
+        vtt_state_t defaults;
+        vtt_init(&defaults, (vtt_material_t)m);
+        best[m] = (params_t){
+            .decline_short = defaults.decline_rate_short,
+            .decline_long = defaults.decline_rate_long,
+            .rh_mat = defaults.rh_mat,
+        };
+    }
+
+    fprintf(stderr, "%d datasets, %zu observations, %d threads, %d^3 grid, %d rounds\n",
+            dataset_count, observations, threads, points, rounds);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    double rmse = calibrate(datasets, dataset_count, points, rounds, threads, best);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    fprintf(stderr, "done in %.1f s\n", (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+
+    write_header(stdout, best, fitted, dataset_count, observations, rmse);
+    if (out_path != NULL) {
+        FILE *out = fopen(out_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "%s: %s\n", out_path, strerror(errno));
+            return 1;
+        }
+        write_header(out, best, fitted, dataset_count, observations, rmse);
+        fclose(out);
+    }
+
+    for (int d = 0; d < dataset_count; d++) {
+        free(datasets[d].rows);
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+@file csv_to_wtr.py
+@brief Converts a climate CSV trace to the compact .wtr format of weather_replay.c.
+
+Input CSV (header required, extra columns are ignored):
+  time_h,temperature_c,humidity_pct     time in hours since the trace start
+  time_s,temperature_c,humidity_pct     time in seconds since the trace start
+  timestamp,temperature_c,humidity_pct  ISO 8601 timestamps (e.g. a logger export)
+
+The samples are resampled with linear interpolation to a fixed --step and
+written as:
+  char     magic[4] = "WTR1"
+  uint32   step_s                 (little-endian)
+  uint32   count
+  count x { int16 temp_centi_c; uint16 rh_centi; }
+
+One year of hourly data is about 35 KB, small enough for flash.
+
+Usage:
+  csv_to_wtr.py trace.csv trace.wtr [--step 3600]
+"""
+import argparse
+import csv
+import struct
+import sys
+from datetime import datetime
+
+MAGIC = b'WTR1'
+
+
+def read_csv(path):
+    """Returns [(time_s, temp_c, rh_pct)] sorted by time."""
+    rows = []
+    with open(path, newline='') as handle:
+        reader = csv.DictReader(handle)
+        fields = [name.strip() for name in reader.fieldnames or []]
+        reader.fieldnames = fields
+        if 'temperature_c' not in fields or 'humidity_pct' not in fields:
+            sys.exit(f'{path}: needs temperature_c and humidity_pct columns')
+
+        start = None
+        for row in reader:
+            if 'time_h' in fields:
+                t = float(row['time_h']) * 3600.0
+            elif 'time_s' in fields:
+                t = float(row['time_s'])
+            elif 'timestamp' in fields:
+                stamp = datetime.fromisoformat(row['timestamp'].strip())
+                start = start or stamp
+                t = (stamp - start).total_seconds()
+            else:
+                sys.exit(f'{path}: needs a time_h, time_s or timestamp column')
+            rows.append((t, float(row['temperature_c']), float(row['humidity_pct'])))
+
+    if len(rows) < 2:
+        sys.exit(f'{path}: needs at least two samples')
+    rows.sort()
+    return rows
+
+
+def resample(rows, step):
+    """Linear interpolation of the rows on a fixed grid starting at the first sample."""
+    t0, t_end = rows[0][0], rows[-1][0]
+    out = []
+    index = 0
+    t = t0
+    while t <= t_end:
+        while rows[index + 1][0] < t:
+            index += 1
+        (ta, temp_a, rh_a), (tb, temp_b, rh_b) = rows[index], rows[index + 1]
+        frac = (t - ta) / (tb - ta) if tb > ta else 0.0
+        out.append((temp_a + (temp_b - temp_a) * frac, rh_a + (rh_b - rh_a) * frac))
+        t += step
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('csv', help='input CSV trace')
+    parser.add_argument('wtr', help='output .wtr file')
+    parser.add_argument('--step', type=int, default=3600, help='sample period in seconds (default 3600)')
+    args = parser.parse_args()
+
+    samples = resample(read_csv(args.csv), args.step)
+    with open(args.wtr, 'wb') as handle:
+        handle.write(MAGIC + struct.pack('<II', args.step, len(samples)))
+        for temp, rh in samples:
+            temp_cc = max(-32768, min(32767, round(temp * 100)))
+            rh_cc = max(0, min(10000, round(rh * 100)))
+            handle.write(struct.pack('<hH', temp_cc, rh_cc))
+
+
+if __name__ == '__main__':
+    main()